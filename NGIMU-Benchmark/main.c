@@ -0,0 +1,78 @@
+/**
+ * @file main.c
+ * @author Seb Madgwick
+ * @brief Desktop benchmark of the NgimuReceive decode path.  Prints the
+ * throughput and callback latency of each benchmark scenario.
+ *
+ * Build:
+ * Compile main.c, ../NGIMU-C-Cpp-Example/NgimuBenchmark.c,
+ * ../NGIMU-C-Cpp-Example/NgimuReceive.c,
+ * ../NGIMU-C-Cpp-Example/NgimuSynthesiser.c and the OSC99 source files, with
+ * ../NGIMU-C-Cpp-Example and the "Osc99" directory on the include path.
+ * Compile with optimisation (e.g. -O2) for representative results.
+ *
+ * Usage:
+ * ngimu-benchmark [repetitions] [corruption percentage]
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#define _POSIX_C_SOURCE 199309L // clock_gettime, must be defined before any system header
+
+#include "NgimuBenchmark.h"
+#include <stdio.h>
+#include <stdlib.h> // atoi
+#include <time.h>
+
+//------------------------------------------------------------------------------
+// Variable declarations
+
+static char streamBuffer[1024 * 1024];
+static uint32_t latencyBuffer[256 * 1024];
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static uint64_t GetTicks();
+
+//------------------------------------------------------------------------------
+// Functions
+
+int main(int argc, char* argv[]) {
+
+    // Configure benchmark
+    NgimuBenchmarkSettings settings;
+    settings.getTicks = GetTicks;
+    settings.ticksPerSecond = 1E9;
+    settings.streamBuffer = streamBuffer;
+    settings.streamBufferSize = sizeof (streamBuffer);
+    settings.latencyBuffer = latencyBuffer;
+    settings.latencyBufferSize = sizeof (latencyBuffer) / sizeof (uint32_t);
+    settings.repetitions = (argc > 1) ? (unsigned int) atoi(argv[1]) : 20;
+    settings.blockSize = 64;
+    settings.corruptionPercentage = (argc > 2) ? (unsigned int) atoi(argv[2]) : 1;
+
+    // Run each scenario
+    printf("%-14s %12s %10s %8s %12s %9s %9s %9s\n", "Scenario", "Messages", "Errors", "ns/byte", "Messages/s", "p50 ns", "p99 ns", "p999 ns");
+    NgimuBenchmarkScenario scenario;
+    for (scenario = 0; scenario < NgimuBenchmarkNumberOfScenarios; scenario++) {
+        NgimuBenchmarkResult result;
+        NgimuBenchmarkRun(&settings, scenario, &result);
+        printf("%-14s %12zu %10zu %8.2f %12.0f %9.0f %9.0f %9.0f\n", result.name, result.numberOfMessages, result.numberOfErrors, result.nanosecondsPerByte, result.messagesPerSecond, result.latencyP50, result.latencyP99, result.latencyP999);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Returns monotonic time in nanoseconds.
+ * @return Monotonic time in nanoseconds.
+ */
+static uint64_t GetTicks() {
+    struct timespec timespec;
+    clock_gettime(CLOCK_MONOTONIC, &timespec);
+    return ((uint64_t) timespec.tv_sec * 1000000000) + (uint64_t) timespec.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+// End of file
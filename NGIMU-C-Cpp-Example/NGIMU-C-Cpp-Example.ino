@@ -15,36 +15,124 @@
  *
  * Lower performance devices such as the Arduino MEGA do not have enough memory
  * to use this example 'as is'.  The value of MAX_TRANSPORT_SIZE must be reduced
- * to 150 in OscCommon.h if this example is used on such devices.
+ * to 150 in OscCommon.h if this example is used on such devices.  Alternatively,
+ * serial bytes may be processed with NgimuReceiveProcessSerialBytesInPlace and
+ * NGIMU_RECEIVER_SLIP_BUFFER_SIZE reduced instead.  Message types
+ * that are not used can be removed to further reduce memory use by setting the
+ * corresponding NGIMU_RECEIVE_ENABLE_... definition to 0 in NgimuReceive.h.
  */
 
 //------------------------------------------------------------------------------
 // Includes
 
+#include "NgimuBenchmark.h"
+#include "NgimuQueue.h"
 #include "NgimuReceive.h"
+#include "NgimuSerialDma.h"
+
+// Uncomment to receive via DMA instead of polling Serial1 in loop() (Teensy
+// 3.x only).  Messages are decoded in interrupt context and passed to loop()
+// through a queue.
+//#define USE_SERIAL_DMA
+
+// Uncomment to benchmark the decode path using the DWT cycle counter instead
+// of receiving from the NGIMU (Teensy 3.x only).  Results are printed to the
+// Teensy USB serial once on start up.
+//#define RUN_BENCHMARK
+
+#ifdef USE_SERIAL_DMA
+NgimuQueue ngimuQueue;
+#endif
+
+#ifdef RUN_BENCHMARK
+char benchmarkStreamBuffer[8192];
+uint32_t benchmarkLatencyBuffer[1024];
+#endif
 
 void setup() {
 
     // Initialise Teensy serial
     Serial.begin(115200); // Teensy USB (baud rate irrelevant)
+
+#ifdef RUN_BENCHMARK
+    runBenchmark();
+#endif
+#ifndef USE_SERIAL_DMA
     Serial1.begin(115200); // NGIMU serial (baud rate must match NGIMU settings)
+#endif
 
     // Initialise NGIMU receive module
     NgimuReceiveInitialise();
 
+#ifndef USE_SERIAL_DMA
     // Assign NGIMU receive callback functions
     NgimuReceiveSetReceiveErrorCallback(ngimuReceiveErrorCallback);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
     NgimuReceiveSetSensorsCallback(ngimuSensorsCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
     NgimuReceiveSetQuaternionCallback(ngimuQuaternionCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
     NgimuReceiveSetEulerCallback(ngimuEulerCallback);
+#endif
+#else
+    // Assign NGIMU receive callback functions to push to queue
+    NgimuQueueInitialise(&ngimuQueue);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuReceiveSetSensorsPointerCallback(NgimuQueueSensorsCallback, &ngimuQueue);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuReceiveSetQuaternionPointerCallback(NgimuQueueQuaternionCallback, &ngimuQueue);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuReceiveSetEulerPointerCallback(NgimuQueueEulerCallback, &ngimuQueue);
+#endif
+
+    // Start NGIMU serial DMA (baud rate must match NGIMU settings)
+    NgimuSerialDmaBegin(NULL, 115200);
+#endif
 }
 
 void loop() {
 
-    // Process each received byte
-    while (Serial1.available() > 0) {
-        NgimuReceiveProcessSerialByte(Serial1.read());
+#ifndef USE_SERIAL_DMA
+    // Process received bytes as a block
+    char buffer[64];
+    int numberOfBytes = Serial1.available();
+    while (numberOfBytes > 0) {
+        if (numberOfBytes > (int) sizeof (buffer)) {
+            numberOfBytes = sizeof (buffer);
+        }
+        Serial1.readBytes(buffer, numberOfBytes);
+        NgimuReceiveProcessSerialBytes(buffer, numberOfBytes);
+        numberOfBytes = Serial1.available();
+    }
+#else
+    // Process each queued message
+    NgimuQueueRecord ngimuQueueRecord;
+    while (NgimuQueuePop(&ngimuQueue, &ngimuQueueRecord) == true) {
+        switch (ngimuQueueRecord.type) {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+            case NgimuQueueRecordTypeSensors:
+                ngimuSensorsCallback(ngimuQueueRecord.data.sensors);
+                break;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+            case NgimuQueueRecordTypeQuaternion:
+                ngimuQuaternionCallback(ngimuQueueRecord.data.quaternion);
+                break;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+            case NgimuQueueRecordTypeEuler:
+                ngimuEulerCallback(ngimuQueueRecord.data.euler);
+                break;
+#endif
+            default:
+                break;
+        }
     }
+#endif
 }
 
 // This function is called each time there is a receive error
@@ -53,6 +141,8 @@ void ngimuReceiveErrorCallback(const char* const errorMessage) {
     Serial.print("\r\n");
 }
 
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+
 // This function is called each time a "/sensors" message is received
 void ngimuSensorsCallback(const NgimuSensors ngimuSensors) {
     Serial.print("/sensors, ");
@@ -77,6 +167,10 @@ void ngimuSensorsCallback(const NgimuSensors ngimuSensors) {
     Serial.print("\r\n");
 }
 
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+
 // This function is called each time a "/quaternion" message is received
 void ngimuQuaternionCallback(const NgimuQuaternion ngimuQuaternion) {
     Serial.print("/quaternion, ");
@@ -90,6 +184,10 @@ void ngimuQuaternionCallback(const NgimuQuaternion ngimuQuaternion) {
     Serial.print("\r\n");
 }
 
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+
 // This function is called each time a "/euler" message is received.
 void ngimuEulerCallback(const NgimuEuler ngimuEuler) {
     Serial.print("/euler, ");
@@ -100,3 +198,63 @@ void ngimuEulerCallback(const NgimuEuler ngimuEuler) {
     Serial.print(ngimuEuler.yaw);
     Serial.print("\r\n");
 }
+
+#endif
+
+#ifdef RUN_BENCHMARK
+
+// Returns the DWT cycle count
+uint64_t getCycleCount() {
+    static uint32_t previousCycleCount;
+    static uint64_t cycleCount;
+    const uint32_t currentCycleCount = ARM_DWT_CYCCNT;
+    cycleCount += currentCycleCount - previousCycleCount; // 32-bit counter wraps every 74 s at 72 MHz
+    previousCycleCount = currentCycleCount;
+    return cycleCount;
+}
+
+// Runs each benchmark scenario and prints the results
+void runBenchmark() {
+
+    // Enable DWT cycle counter
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+
+    // Wait for USB serial to be opened
+    while (!Serial) {
+    }
+
+    // Configure benchmark
+    NgimuBenchmarkSettings settings;
+    settings.getTicks = getCycleCount;
+    settings.ticksPerSecond = F_CPU;
+    settings.streamBuffer = benchmarkStreamBuffer;
+    settings.streamBufferSize = sizeof (benchmarkStreamBuffer);
+    settings.latencyBuffer = benchmarkLatencyBuffer;
+    settings.latencyBufferSize = sizeof (benchmarkLatencyBuffer) / sizeof (uint32_t);
+    settings.repetitions = 10;
+    settings.blockSize = 64;
+    settings.corruptionPercentage = 1;
+
+    // Run each scenario
+    for (int scenario = 0; scenario < NgimuBenchmarkNumberOfScenarios; scenario++) {
+        NgimuBenchmarkResult result;
+        NgimuBenchmarkRun(&settings, (NgimuBenchmarkScenario) scenario, &result);
+        Serial.print(result.name);
+        Serial.print(", messages/s: ");
+        Serial.print(result.messagesPerSecond, 0);
+        Serial.print(", ns/byte: ");
+        Serial.print(result.nanosecondsPerByte, 1);
+        Serial.print(", errors: ");
+        Serial.print(result.numberOfErrors);
+        Serial.print(", latency p50/p99/p999 ns: ");
+        Serial.print(result.latencyP50, 0);
+        Serial.print("/");
+        Serial.print(result.latencyP99, 0);
+        Serial.print("/");
+        Serial.print(result.latencyP999, 0);
+        Serial.print("\r\n");
+    }
+}
+
+#endif
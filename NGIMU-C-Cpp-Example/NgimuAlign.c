@@ -0,0 +1,300 @@
+/**
+ * @file NgimuAlign.c
+ * @author Seb Madgwick
+ * @brief Alignment of "/sensors", "/quaternion" and "/euler" messages by OSC
+ * time tag.  Messages are held in a small window until all required message
+ * types for a time tag have been received, or until a timeout, and are then
+ * provided as a single sample.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuAlign.h"
+#include <stddef.h>
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of OSC time tag units per second.
+ */
+#define TIME_TAG_UNITS_PER_SECOND (4294967296.0f)
+
+/**
+ * @brief Default timeout in seconds.
+ */
+#define DEFAULT_TIMEOUT (0.1f)
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static NgimuSample* GetSample(NgimuAlign * const ngimuAlign, const NgimuAlignStream stream, const OscTimeTag * const timestamp);
+static void Update(NgimuAlign * const ngimuAlign, NgimuSample * const ngimuSample, const NgimuAlignStream stream);
+static void EmitOlderThan(NgimuAlign * const ngimuAlign, const uint64_t timestamp);
+static int GetOldest(const NgimuAlign * const ngimuAlign);
+static void Emit(NgimuAlign * const ngimuAlign, const int index);
+static uint64_t GetDifference(const uint64_t a, const uint64_t b);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises alignment.  This function must be called before the
+ * alignment is used.  All enabled message types are required by default.
+ * @param ngimuAlign Address of alignment structure.
+ */
+void NgimuAlignInitialise(NgimuAlign * const ngimuAlign) {
+    memset(ngimuAlign, 0, sizeof (*ngimuAlign));
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    ngimuAlign->requiredStreams |= NgimuAlignStreamSensors;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    ngimuAlign->requiredStreams |= NgimuAlignStreamQuaternion;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    ngimuAlign->requiredStreams |= NgimuAlignStreamEuler;
+#endif
+    NgimuAlignSetTimeout(ngimuAlign, DEFAULT_TIMEOUT);
+}
+
+/**
+ * @brief Sets sample callback function.  The callback receives a pointer to a
+ * structure owned by the alignment that is only valid for the duration of the
+ * callback.
+ * @param ngimuAlign Address of alignment structure.
+ * @param newSampleCallback Sample callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuAlignSetSampleCallback(NgimuAlign * const ngimuAlign, void (*newSampleCallback)(const NgimuSample * const ngimuSample, void * const userContext), void * const userContext) {
+    ngimuAlign->sampleCallback = newSampleCallback;
+    ngimuAlign->userContext = userContext;
+}
+
+/**
+ * @brief Sets the streams required for a sample to be complete.
+ * @param ngimuAlign Address of alignment structure.
+ * @param requiredStreams Combination of NgimuAlignStream flags.
+ */
+void NgimuAlignSetRequiredStreams(NgimuAlign * const ngimuAlign, const uint8_t requiredStreams) {
+    ngimuAlign->requiredStreams = requiredStreams;
+}
+
+/**
+ * @brief Sets the maximum difference between the time tags of messages of the
+ * same sample.  The default value of 0 requires time tags to be identical.
+ * @param ngimuAlign Address of alignment structure.
+ * @param tolerance Tolerance in seconds.
+ */
+void NgimuAlignSetTolerance(NgimuAlign * const ngimuAlign, const float tolerance) {
+    ngimuAlign->tolerance = (uint64_t) (tolerance * TIME_TAG_UNITS_PER_SECOND);
+}
+
+/**
+ * @brief Sets the time after which an incomplete sample is provided.  The time
+ * is measured using the time tags of received messages.
+ * @param ngimuAlign Address of alignment structure.
+ * @param timeout Timeout in seconds.
+ */
+void NgimuAlignSetTimeout(NgimuAlign * const ngimuAlign, const float timeout) {
+    ngimuAlign->timeout = (uint64_t) (timeout * TIME_TAG_UNITS_PER_SECOND);
+}
+
+/**
+ * @brief Assigns the receiver callbacks so that all decoded messages are
+ * passed to the alignment.  The receiver user context is set to the alignment.
+ * @param ngimuAlign Address of alignment structure.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+void NgimuAlignSetReceiverCallbacks(NgimuAlign * const ngimuAlign, NgimuReceiver * const ngimuReceiver) {
+    NgimuReceiverSetUserContext(ngimuReceiver, ngimuAlign);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuReceiverSetSensorsCallback(ngimuReceiver, NgimuAlignSensorsCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuReceiverSetQuaternionCallback(ngimuReceiver, NgimuAlignQuaternionCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuReceiverSetEulerCallback(ngimuReceiver, NgimuAlignEulerCallback);
+#endif
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief "/sensors" callback that adds the message to the alignment.  May be
+ * assigned to any pointer callback with the alignment as the user context.
+ * @param ngimuSensors Address of "/sensors" structure.
+ * @param userContext Address of alignment structure.
+ */
+void NgimuAlignSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+    NgimuAlign * const ngimuAlign = (NgimuAlign *) userContext;
+    NgimuSample * const ngimuSample = GetSample(ngimuAlign, NgimuAlignStreamSensors, &ngimuSensors->timestamp);
+    ngimuSample->sensors = *ngimuSensors;
+    Update(ngimuAlign, ngimuSample, NgimuAlignStreamSensors);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief "/quaternion" callback that adds the message to the alignment.  May be
+ * assigned to any pointer callback with the alignment as the user context.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ * @param userContext Address of alignment structure.
+ */
+void NgimuAlignQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+    NgimuAlign * const ngimuAlign = (NgimuAlign *) userContext;
+    NgimuSample * const ngimuSample = GetSample(ngimuAlign, NgimuAlignStreamQuaternion, &ngimuQuaternion->timestamp);
+    ngimuSample->quaternion = *ngimuQuaternion;
+    Update(ngimuAlign, ngimuSample, NgimuAlignStreamQuaternion);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief "/euler" callback that adds the message to the alignment.  May be
+ * assigned to any pointer callback with the alignment as the user context.
+ * @param ngimuEuler Address of "/euler" structure.
+ * @param userContext Address of alignment structure.
+ */
+void NgimuAlignEulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+    NgimuAlign * const ngimuAlign = (NgimuAlign *) userContext;
+    NgimuSample * const ngimuSample = GetSample(ngimuAlign, NgimuAlignStreamEuler, &ngimuEuler->timestamp);
+    ngimuSample->euler = *ngimuEuler;
+    Update(ngimuAlign, ngimuSample, NgimuAlignStreamEuler);
+}
+#endif
+
+/**
+ * @brief Provides all pending samples in time tag order, e.g. at the end of a
+ * recording.
+ * @param ngimuAlign Address of alignment structure.
+ */
+void NgimuAlignFlush(NgimuAlign * const ngimuAlign) {
+    int index;
+    while ((index = GetOldest(ngimuAlign)) >= 0) {
+        Emit(ngimuAlign, index);
+    }
+}
+
+/**
+ * @brief Returns the pending sample that a message belongs to.  A new sample is
+ * started if there is no pending sample within the tolerance that does not
+ * already contain the stream.
+ * @param ngimuAlign Address of alignment structure.
+ * @param stream Stream of message.
+ * @param timestamp Time tag of message.
+ * @return Address of sample.
+ */
+static NgimuSample* GetSample(NgimuAlign * const ngimuAlign, const NgimuAlignStream stream, const OscTimeTag * const timestamp) {
+
+    // Find pending sample
+    int index;
+    for (index = 0; index < NGIMU_ALIGN_WINDOW_SIZE; index++) {
+        const NgimuSample * const ngimuSample = &ngimuAlign->samples[index];
+        if ((ngimuAlign->pending[index] == true) && ((ngimuSample->streams & stream) == 0) && (GetDifference(ngimuSample->timestamp.value, timestamp->value) <= ngimuAlign->tolerance)) {
+            return &ngimuAlign->samples[index];
+        }
+    }
+
+    // Find free sample, or free oldest sample if window is full
+    for (index = 0; index < NGIMU_ALIGN_WINDOW_SIZE; index++) {
+        if (ngimuAlign->pending[index] == false) {
+            break;
+        }
+    }
+    if (index >= NGIMU_ALIGN_WINDOW_SIZE) {
+        index = GetOldest(ngimuAlign);
+        Emit(ngimuAlign, index);
+    }
+
+    // Start new sample
+    NgimuSample * const ngimuSample = &ngimuAlign->samples[index];
+    ngimuAlign->pending[index] = true;
+    ngimuSample->timestamp = *timestamp;
+    ngimuSample->streams = 0;
+    return ngimuSample;
+}
+
+/**
+ * @brief Marks the stream as received, provides the sample if it is complete
+ * and provides any samples that have timed out.
+ * @param ngimuAlign Address of alignment structure.
+ * @param ngimuSample Address of sample.
+ * @param stream Stream of message.
+ */
+static void Update(NgimuAlign * const ngimuAlign, NgimuSample * const ngimuSample, const NgimuAlignStream stream) {
+
+    // Provide sample if complete
+    ngimuSample->streams |= stream;
+    const uint64_t timestamp = ngimuSample->timestamp.value;
+    if ((ngimuSample->streams & ngimuAlign->requiredStreams) == ngimuAlign->requiredStreams) {
+        Emit(ngimuAlign, (int) (ngimuSample - ngimuAlign->samples));
+    }
+
+    // Provide samples that have timed out
+    if (timestamp > ngimuAlign->latestTimestamp) {
+        ngimuAlign->latestTimestamp = timestamp;
+    }
+    if (ngimuAlign->latestTimestamp > ngimuAlign->timeout) {
+        EmitOlderThan(ngimuAlign, ngimuAlign->latestTimestamp - ngimuAlign->timeout);
+    }
+}
+
+/**
+ * @brief Provides all pending samples with a time tag older than the specified
+ * time tag in time tag order.
+ * @param ngimuAlign Address of alignment structure.
+ * @param timestamp Time tag.
+ */
+static void EmitOlderThan(NgimuAlign * const ngimuAlign, const uint64_t timestamp) {
+    int index;
+    while (((index = GetOldest(ngimuAlign)) >= 0) && (ngimuAlign->samples[index].timestamp.value < timestamp)) {
+        Emit(ngimuAlign, index);
+    }
+}
+
+/**
+ * @brief Returns the index of the pending sample with the oldest time tag.
+ * @param ngimuAlign Address of alignment structure.
+ * @return Index of the oldest pending sample, or -1 if there are no pending
+ * samples.
+ */
+static int GetOldest(const NgimuAlign * const ngimuAlign) {
+    int oldest = -1;
+    int index;
+    for (index = 0; index < NGIMU_ALIGN_WINDOW_SIZE; index++) {
+        if (ngimuAlign->pending[index] == false) {
+            continue;
+        }
+        if ((oldest < 0) || (ngimuAlign->samples[index].timestamp.value < ngimuAlign->samples[oldest].timestamp.value)) {
+            oldest = index;
+        }
+    }
+    return oldest;
+}
+
+/**
+ * @brief Provides pending sample through the sample callback and frees it.
+ * @param ngimuAlign Address of alignment structure.
+ * @param index Index of sample.
+ */
+static void Emit(NgimuAlign * const ngimuAlign, const int index) {
+    ngimuAlign->pending[index] = false;
+    if (ngimuAlign->sampleCallback != NULL) {
+        ngimuAlign->sampleCallback(&ngimuAlign->samples[index], ngimuAlign->userContext);
+    }
+}
+
+/**
+ * @brief Returns the absolute difference between two time tags.
+ * @param a First time tag.
+ * @param b Second time tag.
+ * @return Absolute difference.
+ */
+static uint64_t GetDifference(const uint64_t a, const uint64_t b) {
+    return (a > b) ? (a - b) : (b - a);
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,105 @@
+/**
+ * @file NgimuAlign.h
+ * @author Seb Madgwick
+ * @brief Alignment of "/sensors", "/quaternion" and "/euler" messages by OSC
+ * time tag.  Messages are held in a small window until all required message
+ * types for a time tag have been received, or until a timeout, and are then
+ * provided as a single sample.
+ */
+
+#ifndef NGIMU_ALIGN_H
+#define NGIMU_ALIGN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuReceive.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of samples that may be pending at once.  The oldest pending
+ * sample is provided incomplete if a new time tag is received while the window
+ * is full.
+ */
+#ifndef NGIMU_ALIGN_WINDOW_SIZE
+#define NGIMU_ALIGN_WINDOW_SIZE (4)
+#endif
+
+/**
+ * @brief Stream flags.
+ */
+typedef enum {
+    NgimuAlignStreamSensors = 1 << 0,
+    NgimuAlignStreamQuaternion = 1 << 1,
+    NgimuAlignStreamEuler = 1 << 2,
+} NgimuAlignStream;
+
+/**
+ * @brief Aligned sample.  Streams indicates which members are valid.  The
+ * timestamp is that of the first message received for the sample.
+ */
+typedef struct {
+    OscTimeTag timestamp;
+    uint8_t streams;
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuSensors sensors;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuQuaternion quaternion;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuEuler euler;
+#endif
+} NgimuSample;
+
+/**
+ * @brief Alignment structure.  Structure members are used internally and
+ * should not be used by the user application.
+ */
+typedef struct {
+    NgimuSample samples[NGIMU_ALIGN_WINDOW_SIZE];
+    bool pending[NGIMU_ALIGN_WINDOW_SIZE];
+    uint8_t requiredStreams;
+    uint64_t tolerance;
+    uint64_t timeout;
+    uint64_t latestTimestamp;
+    void (*sampleCallback)(const NgimuSample * const ngimuSample, void * const userContext);
+    void* userContext;
+} NgimuAlign;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+void NgimuAlignInitialise(NgimuAlign * const ngimuAlign);
+void NgimuAlignSetSampleCallback(NgimuAlign * const ngimuAlign, void (*newSampleCallback)(const NgimuSample * const ngimuSample, void * const userContext), void * const userContext);
+void NgimuAlignSetRequiredStreams(NgimuAlign * const ngimuAlign, const uint8_t requiredStreams);
+void NgimuAlignSetTolerance(NgimuAlign * const ngimuAlign, const float tolerance);
+void NgimuAlignSetTimeout(NgimuAlign * const ngimuAlign, const float timeout);
+void NgimuAlignSetReceiverCallbacks(NgimuAlign * const ngimuAlign, NgimuReceiver * const ngimuReceiver);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+void NgimuAlignSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+void NgimuAlignQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+void NgimuAlignEulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext);
+#endif
+void NgimuAlignFlush(NgimuAlign * const ngimuAlign);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,326 @@
+/**
+ * @file NgimuBenchmark.c
+ * @author Seb Madgwick
+ * @brief Benchmark of the NgimuReceive decode path.  Synthesises SLIP-framed
+ * and UDP streams of mixed "/sensors", "/quaternion" and "/euler" messages,
+ * bundles and corrupted frames, and measures throughput and callback latency.
+ * The module is platform independent; the platform provides a tick counter.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuBenchmark.h"
+#include "NgimuReceive.h"
+#include "NgimuSynthesiser.h"
+#include <stdbool.h>
+#include <stdlib.h> // qsort
+#include <string.h> // memcpy, memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Space reserved in the stream buffer for one encoded frame or
+ * datagram.  The largest synthesised packet is 156 bytes which may double in
+ * size when SLIP encoded.
+ */
+#define MAX_FRAME_SIZE (512)
+
+/**
+ * @brief Seed of the pseudo-random number generator so that every run
+ * synthesises the same stream.
+ */
+#define RANDOM_SEED (0x12345678)
+
+//------------------------------------------------------------------------------
+// Variable declarations
+
+static const char * const scenarioNames[NgimuBenchmarkNumberOfScenarios] = {
+    "Serial byte",
+    "Serial bytes",
+    "UDP packet",
+};
+static NgimuSynthesiser ngimuSynthesiser;
+static size_t numberOfMessages;
+static size_t numberOfErrors;
+static const NgimuBenchmarkSettings* latencySettings;
+static uint64_t callTicks;
+static size_t numberOfLatencySamples;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static size_t SynthesiseSerialStream(const NgimuBenchmarkSettings * const settings);
+static size_t SynthesiseUdpStream(const NgimuBenchmarkSettings * const settings);
+static void ProcessStream(const NgimuBenchmarkSettings * const settings, NgimuReceiver * const ngimuReceiver, const NgimuBenchmarkScenario scenario, const size_t streamSize, const bool measureLatency);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static void SensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+static void QuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+static void EulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext);
+#endif
+static void ReceiveErrorCallback(const NgimuReceiveError * const ngimuReceiveError, void * const userContext);
+static void MessageReceived();
+static int CompareLatency(const void * const a, const void * const b);
+static double GetPercentile(const NgimuBenchmarkSettings * const settings, const double percentile);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Runs benchmark scenario.
+ * @param settings Benchmark settings.
+ * @param scenario Benchmark scenario.
+ * @param result Address of result structure to be written.
+ */
+void NgimuBenchmarkRun(const NgimuBenchmarkSettings * const settings, const NgimuBenchmarkScenario scenario, NgimuBenchmarkResult * const result) {
+
+    // Synthesise stream
+    NgimuSynthesiserInitialise(&ngimuSynthesiser, RANDOM_SEED);
+    const size_t streamSize = (scenario == NgimuBenchmarkScenarioUdpPacket) ? SynthesiseUdpStream(settings) : SynthesiseSerialStream(settings);
+
+    // Initialise receiver
+    NgimuReceiver ngimuReceiver;
+    NgimuReceiverInitialise(&ngimuReceiver);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuReceiverSetSensorsCallback(&ngimuReceiver, SensorsCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuReceiverSetQuaternionCallback(&ngimuReceiver, QuaternionCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuReceiverSetEulerCallback(&ngimuReceiver, EulerCallback);
+#endif
+    NgimuReceiverSetReceiveErrorCallback(&ngimuReceiver, ReceiveErrorCallback);
+
+    // Throughput pass
+    numberOfMessages = 0;
+    numberOfErrors = 0;
+    const uint64_t startTicks = settings->getTicks();
+    unsigned int repetition;
+    for (repetition = 0; repetition < settings->repetitions; repetition++) {
+        ProcessStream(settings, &ngimuReceiver, scenario, streamSize, false);
+    }
+    const double seconds = (double) (settings->getTicks() - startTicks) / settings->ticksPerSecond;
+
+    // Write throughput result
+    memset(result, 0, sizeof (*result));
+    result->name = scenarioNames[scenario];
+    result->numberOfBytes = streamSize * settings->repetitions;
+    result->numberOfMessages = numberOfMessages;
+    result->numberOfErrors = numberOfErrors;
+    if (seconds > 0.0) {
+        result->messagesPerSecond = (double) numberOfMessages / seconds;
+    }
+    if (result->numberOfBytes > 0) {
+        result->nanosecondsPerByte = (seconds * 1E9) / (double) result->numberOfBytes;
+    }
+
+    // Latency pass
+    latencySettings = settings;
+    numberOfLatencySamples = 0;
+    ProcessStream(settings, &ngimuReceiver, scenario, streamSize, true);
+    latencySettings = NULL;
+    qsort(settings->latencyBuffer, numberOfLatencySamples, sizeof (uint32_t), CompareLatency);
+    result->latencyP50 = GetPercentile(settings, 0.5);
+    result->latencyP99 = GetPercentile(settings, 0.99);
+    result->latencyP999 = GetPercentile(settings, 0.999);
+}
+
+/**
+ * @brief Synthesises SLIP-framed stream.  Corrupted frames contain either a
+ * random byte error, an invalid escape sequence or are truncated.
+ * @param settings Benchmark settings.
+ * @return Stream size.
+ */
+static size_t SynthesiseSerialStream(const NgimuBenchmarkSettings * const settings) {
+    char packet[MAX_FRAME_SIZE / 2];
+    size_t streamSize = 0;
+    while ((streamSize + MAX_FRAME_SIZE) <= settings->streamBufferSize) {
+        size_t packetSize = NgimuSynthesiserWritePacket(&ngimuSynthesiser, packet);
+        char * const frame = &settings->streamBuffer[streamSize];
+        const bool corrupt = (NgimuSynthesiserRandom(&ngimuSynthesiser) % 100) < settings->corruptionPercentage;
+        const uint32_t corruption = NgimuSynthesiserRandom(&ngimuSynthesiser) % 3;
+        if (corrupt && (corruption == 0)) {
+            packet[NgimuSynthesiserRandom(&ngimuSynthesiser) % packetSize] ^= (char) (1 << (NgimuSynthesiserRandom(&ngimuSynthesiser) % 8));
+        }
+        if (corrupt && (corruption == 1)) {
+            packetSize -= 4 * (1 + (NgimuSynthesiserRandom(&ngimuSynthesiser) % (packetSize / 8)));
+        }
+        size_t frameSize = NgimuSynthesiserSlipEncode(frame, packet, packetSize);
+        if (corrupt && (corruption == 2)) {
+            frame[frameSize - 1] = SLIP_ESC;
+            frame[frameSize++] = 'x';
+            frame[frameSize++] = SLIP_END;
+        }
+        streamSize += frameSize;
+    }
+    return streamSize;
+}
+
+/**
+ * @brief Synthesises UDP stream.  Each datagram is preceded by its size in
+ * host byte order.  Corrupted datagrams contain either a random byte error or
+ * are truncated.
+ * @param settings Benchmark settings.
+ * @return Stream size.
+ */
+static size_t SynthesiseUdpStream(const NgimuBenchmarkSettings * const settings) {
+    size_t streamSize = 0;
+    while ((streamSize + MAX_FRAME_SIZE) <= settings->streamBufferSize) {
+        char * const packet = &settings->streamBuffer[streamSize + sizeof (uint32_t)];
+        uint32_t packetSize = (uint32_t) NgimuSynthesiserWritePacket(&ngimuSynthesiser, packet);
+        if ((NgimuSynthesiserRandom(&ngimuSynthesiser) % 100) < settings->corruptionPercentage) {
+            if ((NgimuSynthesiserRandom(&ngimuSynthesiser) % 2) == 0) {
+                packet[NgimuSynthesiserRandom(&ngimuSynthesiser) % packetSize] ^= (char) (1 << (NgimuSynthesiserRandom(&ngimuSynthesiser) % 8));
+            } else {
+                packetSize -= 4 * (1 + (NgimuSynthesiserRandom(&ngimuSynthesiser) % (packetSize / 8)));
+            }
+        }
+        memcpy(&settings->streamBuffer[streamSize], &packetSize, sizeof (packetSize));
+        streamSize += sizeof (packetSize) + packetSize;
+    }
+    return streamSize;
+}
+
+/**
+ * @brief Processes the synthesised stream once.
+ * @param settings Benchmark settings.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param scenario Benchmark scenario.
+ * @param streamSize Stream size.
+ * @param measureLatency True to record the tick count before each process
+ * function call.
+ */
+static void ProcessStream(const NgimuBenchmarkSettings * const settings, NgimuReceiver * const ngimuReceiver, const NgimuBenchmarkScenario scenario, const size_t streamSize, const bool measureLatency) {
+    const char * const stream = settings->streamBuffer;
+    size_t index = 0;
+    switch (scenario) {
+        case NgimuBenchmarkScenarioSerialByte:
+            for (index = 0; index < streamSize; index++) {
+                if (measureLatency) {
+                    callTicks = settings->getTicks();
+                }
+                NgimuReceiverProcessSerialByte(ngimuReceiver, stream[index]);
+            }
+            break;
+        case NgimuBenchmarkScenarioSerialBytes:
+            while (index < streamSize) {
+                const size_t blockSize = ((streamSize - index) < settings->blockSize) ? (streamSize - index) : settings->blockSize;
+                if (measureLatency) {
+                    callTicks = settings->getTicks();
+                }
+                NgimuReceiverProcessSerialBytes(ngimuReceiver, &stream[index], blockSize);
+                index += blockSize;
+            }
+            break;
+        case NgimuBenchmarkScenarioUdpPacket:
+            while (index < streamSize) {
+                uint32_t packetSize;
+                memcpy(&packetSize, &stream[index], sizeof (packetSize));
+                index += sizeof (packetSize);
+                if (measureLatency) {
+                    callTicks = settings->getTicks();
+                }
+                NgimuReceiverProcessUdpPacket(ngimuReceiver, &stream[index], packetSize);
+                index += packetSize;
+            }
+            break;
+        case NgimuBenchmarkNumberOfScenarios:
+            break;
+    }
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+
+/**
+ * @brief "/sensors" callback.
+ * @param ngimuSensors Address of "/sensors" structure.
+ * @param userContext Unused.
+ */
+static void SensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+    MessageReceived();
+}
+
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+
+/**
+ * @brief "/quaternion" callback.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ * @param userContext Unused.
+ */
+static void QuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+    MessageReceived();
+}
+
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+
+/**
+ * @brief "/euler" callback.
+ * @param ngimuEuler Address of "/euler" structure.
+ * @param userContext Unused.
+ */
+static void EulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+    MessageReceived();
+}
+
+#endif
+
+/**
+ * @brief Receive error callback.
+ * @param ngimuReceiveError Address of receive error structure.
+ * @param userContext Unused.
+ */
+static void ReceiveErrorCallback(const NgimuReceiveError * const ngimuReceiveError, void * const userContext) {
+    numberOfErrors++;
+}
+
+/**
+ * @brief Counts message and records latency during the latency pass.
+ */
+static void MessageReceived() {
+    numberOfMessages++;
+    if ((latencySettings != NULL) && (numberOfLatencySamples < latencySettings->latencyBufferSize)) {
+        latencySettings->latencyBuffer[numberOfLatencySamples++] = (uint32_t) (latencySettings->getTicks() - callTicks);
+    }
+}
+
+/**
+ * @brief qsort comparison function for latency samples.
+ * @param a First sample.
+ * @param b Second sample.
+ * @return Comparison result.
+ */
+static int CompareLatency(const void * const a, const void * const b) {
+    const uint32_t latencyA = *(const uint32_t *) a;
+    const uint32_t latencyB = *(const uint32_t *) b;
+    return (latencyA > latencyB) - (latencyA < latencyB);
+}
+
+/**
+ * @brief Returns percentile of the sorted latency samples in nanoseconds.
+ * @param settings Benchmark settings.
+ * @param percentile Percentile between 0 and 1.
+ * @return Percentile in nanoseconds.
+ */
+static double GetPercentile(const NgimuBenchmarkSettings * const settings, const double percentile) {
+    if (numberOfLatencySamples == 0) {
+        return 0.0;
+    }
+    size_t index = (size_t) (percentile * (double) numberOfLatencySamples);
+    if (index >= numberOfLatencySamples) {
+        index = numberOfLatencySamples - 1;
+    }
+    return ((double) settings->latencyBuffer[index] * 1E9) / settings->ticksPerSecond;
+}
+
+//------------------------------------------------------------------------------
+// End of file
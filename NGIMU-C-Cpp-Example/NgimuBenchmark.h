@@ -0,0 +1,81 @@
+/**
+ * @file NgimuBenchmark.h
+ * @author Seb Madgwick
+ * @brief Benchmark of the NgimuReceive decode path.  Synthesises SLIP-framed
+ * and UDP streams of mixed "/sensors", "/quaternion" and "/euler" messages,
+ * bundles and corrupted frames, and measures throughput and callback latency.
+ * The module is platform independent; the platform provides a tick counter.
+ */
+
+#ifndef NGIMU_BENCHMARK_H
+#define NGIMU_BENCHMARK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Benchmark scenario.
+ */
+typedef enum {
+    NgimuBenchmarkScenarioSerialByte,
+    NgimuBenchmarkScenarioSerialBytes,
+    NgimuBenchmarkScenarioUdpPacket,
+    NgimuBenchmarkNumberOfScenarios,
+} NgimuBenchmarkScenario;
+
+/**
+ * @brief Benchmark settings.  The stream buffer holds the synthesised stream
+ * and the latency buffer holds one sample per callback of the latency pass.
+ */
+typedef struct {
+    uint64_t(*getTicks)(void);
+    double ticksPerSecond;
+    char* streamBuffer;
+    size_t streamBufferSize;
+    uint32_t* latencyBuffer;
+    size_t latencyBufferSize;
+    unsigned int repetitions;
+    size_t blockSize;
+    unsigned int corruptionPercentage;
+} NgimuBenchmarkSettings;
+
+/**
+ * @brief Benchmark result.  Latencies are in nanoseconds and measured from the
+ * start of the process function call that completed the frame or datagram to
+ * the callback.
+ */
+typedef struct {
+    const char* name;
+    size_t numberOfBytes;
+    size_t numberOfMessages;
+    size_t numberOfErrors;
+    double messagesPerSecond;
+    double nanosecondsPerByte;
+    double latencyP50;
+    double latencyP99;
+    double latencyP999;
+} NgimuBenchmarkResult;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+void NgimuBenchmarkRun(const NgimuBenchmarkSettings * const settings, const NgimuBenchmarkScenario scenario, NgimuBenchmarkResult * const result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,221 @@
+/**
+ * @file NgimuCapture.c
+ * @author Seb Madgwick
+ * @brief Append-only binary capture of the raw input to a receiver, and a
+ * reader that replays a capture held in memory (e.g. a memory-mapped file).
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuCapture.h"
+#include <string.h> // memcmp, memcpy
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief File header magic.
+ */
+#define MAGIC "NGIMUCAP"
+
+/**
+ * @brief File format version.
+ */
+#define VERSION (1)
+
+/**
+ * @brief Entry transport bit.
+ */
+#define TRANSPORT_BIT (0x80000000)
+
+/**
+ * @brief Maximum entry size.
+ */
+#define MAX_ENTRY_SIZE (0x7FFFFFFF)
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static void WriteEntry(NgimuCaptureWriter * const ngimuCaptureWriter, const uint64_t timestamp, const NgimuReceiveTransport transport, const char * const data, const size_t size);
+static void WriteLittleEndian32(char * const destination, const uint32_t value);
+static uint32_t ReadLittleEndian32(const char * const source);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises writer and writes the file header.
+ * @param ngimuCaptureWriter Address of writer structure.
+ * @param write Write function that appends data to the capture.
+ * @param getTimestamp Function that returns the receive timestamp in
+ * nanoseconds.
+ * @param userContext User context passed to the write and timestamp functions.
+ */
+void NgimuCaptureWriterInitialise(NgimuCaptureWriter * const ngimuCaptureWriter, void (*write)(const char * const data, const size_t size, void * const userContext), uint64_t(*getTimestamp)(void * const userContext), void * const userContext) {
+    ngimuCaptureWriter->write = write;
+    ngimuCaptureWriter->getTimestamp = getTimestamp;
+    ngimuCaptureWriter->userContext = userContext;
+    ngimuCaptureWriter->serialBufferIndex = 0;
+
+    // Write file header
+    char header[NGIMU_CAPTURE_FILE_HEADER_SIZE];
+    memcpy(header, MAGIC, sizeof (MAGIC) - 1);
+    WriteLittleEndian32(&header[8], VERSION);
+    WriteLittleEndian32(&header[12], 0);
+    write(header, sizeof (header), userContext);
+}
+
+/**
+ * @brief Capture callback that writes the raw input to the capture.  May be
+ * assigned to the receiver capture callback with the writer as the capture
+ * context.  Serial bytes processed one at a time are combined into a single
+ * entry.
+ * @param transport Transport.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ * @param captureContext Address of writer structure.
+ */
+void NgimuCaptureWriterCaptureCallback(const NgimuReceiveTransport transport, const char * const source, const size_t sourceSize, void * const captureContext) {
+    NgimuCaptureWriter * const ngimuCaptureWriter = (NgimuCaptureWriter *) captureContext;
+    const uint64_t timestamp = ngimuCaptureWriter->getTimestamp(ngimuCaptureWriter->userContext);
+
+    // Write UDP packet or large serial block without copying
+    if ((transport != NgimuReceiveTransportSerial) || (sourceSize >= NGIMU_CAPTURE_SERIAL_BUFFER_SIZE)) {
+        NgimuCaptureWriterFlush(ngimuCaptureWriter);
+        WriteEntry(ngimuCaptureWriter, timestamp, transport, source, sourceSize);
+        return;
+    }
+
+    // Add serial bytes to buffer
+    if ((ngimuCaptureWriter->serialBufferIndex + sourceSize) > NGIMU_CAPTURE_SERIAL_BUFFER_SIZE) {
+        NgimuCaptureWriterFlush(ngimuCaptureWriter);
+    }
+    if (ngimuCaptureWriter->serialBufferIndex == 0) {
+        ngimuCaptureWriter->serialBufferTimestamp = timestamp;
+    }
+    memcpy(&ngimuCaptureWriter->serialBuffer[ngimuCaptureWriter->serialBufferIndex], source, sourceSize);
+    ngimuCaptureWriter->serialBufferIndex += sourceSize;
+    if (ngimuCaptureWriter->serialBufferIndex == NGIMU_CAPTURE_SERIAL_BUFFER_SIZE) {
+        NgimuCaptureWriterFlush(ngimuCaptureWriter);
+    }
+}
+
+/**
+ * @brief Writes any buffered serial bytes to the capture.  This function
+ * should be called before the capture is closed.
+ * @param ngimuCaptureWriter Address of writer structure.
+ */
+void NgimuCaptureWriterFlush(NgimuCaptureWriter * const ngimuCaptureWriter) {
+    if (ngimuCaptureWriter->serialBufferIndex == 0) {
+        return;
+    }
+    WriteEntry(ngimuCaptureWriter, ngimuCaptureWriter->serialBufferTimestamp, NgimuReceiveTransportSerial, ngimuCaptureWriter->serialBuffer, ngimuCaptureWriter->serialBufferIndex);
+    ngimuCaptureWriter->serialBufferIndex = 0;
+}
+
+/**
+ * @brief Initialises reader.  The capture is not copied and must remain valid
+ * while the reader is used.
+ * @param ngimuCaptureReader Address of reader structure.
+ * @param capture Address of capture.
+ * @param captureSize Capture size.
+ * @return True if the file header is valid.
+ */
+bool NgimuCaptureReaderInitialise(NgimuCaptureReader * const ngimuCaptureReader, const char * const capture, const size_t captureSize) {
+    ngimuCaptureReader->capture = capture;
+    ngimuCaptureReader->captureSize = captureSize;
+    ngimuCaptureReader->index = NGIMU_CAPTURE_FILE_HEADER_SIZE;
+    if (captureSize < NGIMU_CAPTURE_FILE_HEADER_SIZE) {
+        return false;
+    }
+    return (memcmp(capture, MAGIC, sizeof (MAGIC) - 1) == 0) && (ReadLittleEndian32(&capture[8]) == VERSION);
+}
+
+/**
+ * @brief Reads the next entry.  An incomplete final entry, e.g. of a capture
+ * interrupted by a power loss, is ignored.
+ * @param ngimuCaptureReader Address of reader structure.
+ * @param ngimuCaptureEntry Address of entry structure to be written.
+ * @return True if an entry was read, false if the end of the capture was
+ * reached.
+ */
+bool NgimuCaptureReaderNext(NgimuCaptureReader * const ngimuCaptureReader, NgimuCaptureEntry * const ngimuCaptureEntry) {
+    const size_t remaining = ngimuCaptureReader->captureSize - ngimuCaptureReader->index;
+    if (remaining < NGIMU_CAPTURE_ENTRY_HEADER_SIZE) {
+        return false;
+    }
+    const char * const header = &ngimuCaptureReader->capture[ngimuCaptureReader->index];
+    const uint32_t sizeAndTransport = ReadLittleEndian32(&header[8]);
+    const size_t size = sizeAndTransport & MAX_ENTRY_SIZE;
+    if (size > (remaining - NGIMU_CAPTURE_ENTRY_HEADER_SIZE)) {
+        return false;
+    }
+    ngimuCaptureEntry->timestamp = ((uint64_t) ReadLittleEndian32(&header[4]) << 32) | ReadLittleEndian32(header);
+    ngimuCaptureEntry->transport = ((sizeAndTransport & TRANSPORT_BIT) != 0) ? NgimuReceiveTransportUdp : NgimuReceiveTransportSerial;
+    ngimuCaptureEntry->data = &header[NGIMU_CAPTURE_ENTRY_HEADER_SIZE];
+    ngimuCaptureEntry->size = size;
+    ngimuCaptureReader->index += NGIMU_CAPTURE_ENTRY_HEADER_SIZE + size;
+    return true;
+}
+
+/**
+ * @brief Passes an entry to a receiver according to its transport.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param ngimuCaptureEntry Address of entry structure.
+ */
+void NgimuCaptureProcessEntry(NgimuReceiver * const ngimuReceiver, const NgimuCaptureEntry * const ngimuCaptureEntry) {
+    switch (ngimuCaptureEntry->transport) {
+        case NgimuReceiveTransportSerial:
+            NgimuReceiverProcessSerialBytes(ngimuReceiver, ngimuCaptureEntry->data, ngimuCaptureEntry->size);
+            break;
+        case NgimuReceiveTransportUdp:
+            NgimuReceiverProcessUdpPacket(ngimuReceiver, ngimuCaptureEntry->data, ngimuCaptureEntry->size);
+            break;
+    }
+}
+
+/**
+ * @brief Writes an entry header followed by the data.
+ * @param ngimuCaptureWriter Address of writer structure.
+ * @param timestamp Receive timestamp in nanoseconds.
+ * @param transport Transport.
+ * @param data Data.
+ * @param size Data size.
+ */
+static void WriteEntry(NgimuCaptureWriter * const ngimuCaptureWriter, const uint64_t timestamp, const NgimuReceiveTransport transport, const char * const data, const size_t size) {
+    if (size > MAX_ENTRY_SIZE) {
+        return;
+    }
+    char header[NGIMU_CAPTURE_ENTRY_HEADER_SIZE];
+    WriteLittleEndian32(&header[0], (uint32_t) timestamp);
+    WriteLittleEndian32(&header[4], (uint32_t) (timestamp >> 32));
+    WriteLittleEndian32(&header[8], (uint32_t) size | ((transport == NgimuReceiveTransportUdp) ? TRANSPORT_BIT : 0));
+    ngimuCaptureWriter->write(header, sizeof (header), ngimuCaptureWriter->userContext);
+    ngimuCaptureWriter->write(data, size, ngimuCaptureWriter->userContext);
+}
+
+/**
+ * @brief Writes a little-endian 32-bit value.
+ * @param destination Destination bytes.
+ * @param value Value.
+ */
+static void WriteLittleEndian32(char * const destination, const uint32_t value) {
+    destination[0] = (char) value;
+    destination[1] = (char) (value >> 8);
+    destination[2] = (char) (value >> 16);
+    destination[3] = (char) (value >> 24);
+}
+
+/**
+ * @brief Reads a little-endian 32-bit value.
+ * @param source Source bytes.
+ * @return Value in host byte order.
+ */
+static uint32_t ReadLittleEndian32(const char * const source) {
+    const unsigned char * const bytes = (const unsigned char *) source;
+    return ((uint32_t) bytes[3] << 24) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[1] << 8) | (uint32_t) bytes[0];
+}
+
+//------------------------------------------------------------------------------
+// End of file
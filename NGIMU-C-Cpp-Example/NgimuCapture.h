@@ -0,0 +1,101 @@
+/**
+ * @file NgimuCapture.h
+ * @author Seb Madgwick
+ * @brief Append-only binary capture of the raw input to a receiver, and a
+ * reader that replays a capture held in memory (e.g. a memory-mapped file).
+ *
+ * File format (all values little-endian):
+ * - File header: "NGIMUCAP" followed by a uint32 version and a uint32 reserved
+ *   value.
+ * - Entries: a uint64 receive timestamp in nanoseconds, a uint32 with the size
+ *   in bits 0 to 30 and the transport in bit 31, followed by the raw bytes.
+ */
+
+#ifndef NGIMU_CAPTURE_H
+#define NGIMU_CAPTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuReceive.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Size of the buffer used to combine serial bytes processed one at a
+ * time into a single entry.  Serial blocks of at least this size are written
+ * without being copied.
+ */
+#ifndef NGIMU_CAPTURE_SERIAL_BUFFER_SIZE
+#define NGIMU_CAPTURE_SERIAL_BUFFER_SIZE (64)
+#endif
+
+/**
+ * @brief File header size.
+ */
+#define NGIMU_CAPTURE_FILE_HEADER_SIZE (16)
+
+/**
+ * @brief Entry header size.
+ */
+#define NGIMU_CAPTURE_ENTRY_HEADER_SIZE (12)
+
+/**
+ * @brief Capture entry.  The data points into the capture.
+ */
+typedef struct {
+    uint64_t timestamp;
+    NgimuReceiveTransport transport;
+    const char* data;
+    size_t size;
+} NgimuCaptureEntry;
+
+/**
+ * @brief Writer structure.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    void (*write)(const char * const data, const size_t size, void * const userContext);
+    uint64_t(*getTimestamp)(void * const userContext);
+    void* userContext;
+    char serialBuffer[NGIMU_CAPTURE_SERIAL_BUFFER_SIZE];
+    size_t serialBufferIndex;
+    uint64_t serialBufferTimestamp;
+} NgimuCaptureWriter;
+
+/**
+ * @brief Reader structure.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    const char* capture;
+    size_t captureSize;
+    size_t index;
+} NgimuCaptureReader;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+void NgimuCaptureWriterInitialise(NgimuCaptureWriter * const ngimuCaptureWriter, void (*write)(const char * const data, const size_t size, void * const userContext), uint64_t(*getTimestamp)(void * const userContext), void * const userContext);
+void NgimuCaptureWriterCaptureCallback(const NgimuReceiveTransport transport, const char * const source, const size_t sourceSize, void * const captureContext);
+void NgimuCaptureWriterFlush(NgimuCaptureWriter * const ngimuCaptureWriter);
+bool NgimuCaptureReaderInitialise(NgimuCaptureReader * const ngimuCaptureReader, const char * const capture, const size_t captureSize);
+bool NgimuCaptureReaderNext(NgimuCaptureReader * const ngimuCaptureReader, NgimuCaptureEntry * const ngimuCaptureEntry);
+void NgimuCaptureProcessEntry(NgimuReceiver * const ngimuReceiver, const NgimuCaptureEntry * const ngimuCaptureEntry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
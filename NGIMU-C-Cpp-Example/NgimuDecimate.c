@@ -0,0 +1,345 @@
+/**
+ * @file NgimuDecimate.c
+ * @author Seb Madgwick
+ * @brief Decimation of "/sensors" and "/quaternion" messages to a lower output
+ * rate for consumers that do not require every message, e.g. a user interface
+ * or network forwarder.  Messages are averaged over windows of the output
+ * period measured using the OSC time tags so that the output rate does not
+ * depend on the message rate of the NGIMU.  "/sensors" messages are averaged
+ * using a boxcar average.  "/quaternion" messages are averaged as the
+ * normalised sum of quaternions in the same hemisphere.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuDecimate.h"
+#include <math.h> // sqrtf
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of OSC time tag units per second.
+ */
+#define TIME_TAG_UNITS_PER_SECOND (4294967296.0f)
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS || NGIMU_RECEIVE_ENABLE_QUATERNION
+static void SetRate(NgimuDecimateWindow * const window, const float rate);
+static bool HasWindowEnded(const NgimuDecimateWindow * const window, const uint64_t timestamp);
+static void AddToWindow(NgimuDecimateWindow * const window, const uint64_t timestamp);
+static uint64_t GetWindowTimestamp(const NgimuDecimateWindow * const window);
+#endif
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static void EmitSensors(NgimuDecimate * const ngimuDecimate);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+static void EmitQuaternion(NgimuDecimate * const ngimuDecimate);
+#endif
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises decimation.  This function must be called before the
+ * decimation is used.  Messages are not decimated until an output rate is set.
+ * @param ngimuDecimate Address of decimation structure.
+ */
+void NgimuDecimateInitialise(NgimuDecimate * const ngimuDecimate) {
+    memset(ngimuDecimate, 0, sizeof (*ngimuDecimate));
+}
+
+/**
+ * @brief Assigns the receiver callbacks so that "/sensors" and "/quaternion"
+ * messages are passed to the decimation.  The receiver user context is set to
+ * the decimation.
+ * @param ngimuDecimate Address of decimation structure.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+void NgimuDecimateSetReceiverCallbacks(NgimuDecimate * const ngimuDecimate, NgimuReceiver * const ngimuReceiver) {
+    NgimuReceiverSetUserContext(ngimuReceiver, ngimuDecimate);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuReceiverSetSensorsCallback(ngimuReceiver, NgimuDecimateSensorsCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuReceiverSetQuaternionCallback(ngimuReceiver, NgimuDecimateQuaternionCallback);
+#endif
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Sets the "/sensors" output rate.  A rate of 0 passes every message to
+ * the callback without averaging.  Pending messages are discarded.
+ * @param ngimuDecimate Address of decimation structure.
+ * @param rate Output rate in Hz.
+ */
+void NgimuDecimateSetSensorsRate(NgimuDecimate * const ngimuDecimate, const float rate) {
+    SetRate(&ngimuDecimate->sensorsWindow, rate);
+    memset(&ngimuDecimate->sensorsSum, 0, sizeof (ngimuDecimate->sensorsSum));
+}
+
+/**
+ * @brief Sets the decimated "/sensors" callback function.  The callback
+ * receives a pointer to a structure owned by the decimation that is only valid
+ * for the duration of the callback.  The timestamp is the midpoint of the
+ * first and last time tags of the averaged messages.
+ * @param ngimuDecimate Address of decimation structure.
+ * @param newSensorsCallback "/sensors" callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuDecimateSetSensorsCallback(NgimuDecimate * const ngimuDecimate, void (*newSensorsCallback)(const NgimuSensors * const ngimuSensors, void * const userContext), void * const userContext) {
+    ngimuDecimate->sensorsCallback = newSensorsCallback;
+    ngimuDecimate->sensorsUserContext = userContext;
+}
+
+/**
+ * @brief "/sensors" callback that adds the message to the decimation.  The
+ * average of the previous window is provided when the message is the first of
+ * a new window.  Messages that are not within a bundle are passed to the
+ * callback without averaging because they do not have a time tag.  May be
+ * assigned to any pointer callback with the decimation as the user context.
+ * @param ngimuSensors Address of "/sensors" structure.
+ * @param userContext Address of decimation structure.
+ */
+void NgimuDecimateSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+    NgimuDecimate * const ngimuDecimate = (NgimuDecimate *) userContext;
+    NgimuDecimateWindow * const window = &ngimuDecimate->sensorsWindow;
+
+    // Pass through if not decimated or not within a bundle
+    if ((window->period == 0) || (ngimuSensors->timestamp.value <= 1)) {
+        if (ngimuDecimate->sensorsCallback != NULL) {
+            ngimuDecimate->sensorsCallback(ngimuSensors, ngimuDecimate->sensorsUserContext);
+        }
+        return;
+    }
+
+    // Provide average of previous window
+    if (HasWindowEnded(window, ngimuSensors->timestamp.value)) {
+        EmitSensors(ngimuDecimate);
+    }
+
+    // Accumulate
+    AddToWindow(window, ngimuSensors->timestamp.value);
+    NgimuSensors * const sum = &ngimuDecimate->sensorsSum;
+    sum->gyroscopeX += ngimuSensors->gyroscopeX;
+    sum->gyroscopeY += ngimuSensors->gyroscopeY;
+    sum->gyroscopeZ += ngimuSensors->gyroscopeZ;
+    sum->accelerometerX += ngimuSensors->accelerometerX;
+    sum->accelerometerY += ngimuSensors->accelerometerY;
+    sum->accelerometerZ += ngimuSensors->accelerometerZ;
+    sum->magnetometerX += ngimuSensors->magnetometerX;
+    sum->magnetometerY += ngimuSensors->magnetometerY;
+    sum->magnetometerZ += ngimuSensors->magnetometerZ;
+    sum->barometer += ngimuSensors->barometer;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Sets the "/quaternion" output rate.  A rate of 0 passes every message
+ * to the callback without averaging.  Pending messages are discarded.
+ * @param ngimuDecimate Address of decimation structure.
+ * @param rate Output rate in Hz.
+ */
+void NgimuDecimateSetQuaternionRate(NgimuDecimate * const ngimuDecimate, const float rate) {
+    SetRate(&ngimuDecimate->quaternionWindow, rate);
+    memset(&ngimuDecimate->quaternionSum, 0, sizeof (ngimuDecimate->quaternionSum));
+}
+
+/**
+ * @brief Sets the decimated "/quaternion" callback function.  The callback
+ * receives a pointer to a structure owned by the decimation that is only valid
+ * for the duration of the callback.  The timestamp is the midpoint of the
+ * first and last time tags of the averaged messages.
+ * @param ngimuDecimate Address of decimation structure.
+ * @param newQuaternionCallback "/quaternion" callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuDecimateSetQuaternionCallback(NgimuDecimate * const ngimuDecimate, void (*newQuaternionCallback)(const NgimuQuaternion * const ngimuQuaternion, void * const userContext), void * const userContext) {
+    ngimuDecimate->quaternionCallback = newQuaternionCallback;
+    ngimuDecimate->quaternionUserContext = userContext;
+}
+
+/**
+ * @brief "/quaternion" callback that adds the message to the decimation.  Each
+ * quaternion is negated if required to be in the same hemisphere as the sum of
+ * the window because q and -q represent the same orientation.
+ * The average of the previous window is provided when the message is the first
+ * of a new window.  Messages that are not within a bundle are passed to the
+ * callback without averaging because they do not have a time tag.  May be
+ * assigned to any pointer callback with the decimation as the user context.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ * @param userContext Address of decimation structure.
+ */
+void NgimuDecimateQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+    NgimuDecimate * const ngimuDecimate = (NgimuDecimate *) userContext;
+    NgimuDecimateWindow * const window = &ngimuDecimate->quaternionWindow;
+
+    // Pass through if not decimated or not within a bundle
+    if ((window->period == 0) || (ngimuQuaternion->timestamp.value <= 1)) {
+        if (ngimuDecimate->quaternionCallback != NULL) {
+            ngimuDecimate->quaternionCallback(ngimuQuaternion, ngimuDecimate->quaternionUserContext);
+        }
+        return;
+    }
+
+    // Provide average of previous window
+    if (HasWindowEnded(window, ngimuQuaternion->timestamp.value)) {
+        EmitQuaternion(ngimuDecimate);
+    }
+
+    // Accumulate in same hemisphere as sum
+    AddToWindow(window, ngimuQuaternion->timestamp.value);
+    NgimuQuaternion * const sum = &ngimuDecimate->quaternionSum;
+    const float dotProduct = (sum->w * ngimuQuaternion->w) + (sum->x * ngimuQuaternion->x) + (sum->y * ngimuQuaternion->y) + (sum->z * ngimuQuaternion->z);
+    const float sign = (dotProduct < 0.0f) ? -1.0f : 1.0f;
+    sum->w += sign * ngimuQuaternion->w;
+    sum->x += sign * ngimuQuaternion->x;
+    sum->y += sign * ngimuQuaternion->y;
+    sum->z += sign * ngimuQuaternion->z;
+}
+#endif
+
+/**
+ * @brief Provides the average of all pending messages, e.g. at the end of a
+ * recording.
+ * @param ngimuDecimate Address of decimation structure.
+ */
+void NgimuDecimateFlush(NgimuDecimate * const ngimuDecimate) {
+#if !NGIMU_RECEIVE_ENABLE_SENSORS && !NGIMU_RECEIVE_ENABLE_QUATERNION
+    (void) ngimuDecimate;
+#endif
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    if (ngimuDecimate->sensorsWindow.numberOfMessages > 0) {
+        EmitSensors(ngimuDecimate);
+    }
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    if (ngimuDecimate->quaternionWindow.numberOfMessages > 0) {
+        EmitQuaternion(ngimuDecimate);
+    }
+#endif
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS || NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Sets the window period from the output rate.  The sum must be cleared
+ * by the caller.
+ * @param window Address of window structure.
+ * @param rate Output rate in Hz.
+ */
+static void SetRate(NgimuDecimateWindow * const window, const float rate) {
+    memset(window, 0, sizeof (*window));
+    if (rate > 0.0f) {
+        window->period = (uint64_t) (TIME_TAG_UNITS_PER_SECOND / rate);
+    }
+}
+
+/**
+ * @brief Returns true if the window contains messages and the time tag is
+ * beyond the end of the window.  A time tag earlier than the window, e.g. after
+ * the NGIMU is reset, also ends the window.
+ * @param window Address of window structure.
+ * @param timestamp Time tag of message.
+ * @return True if the window has ended.
+ */
+static bool HasWindowEnded(const NgimuDecimateWindow * const window, const uint64_t timestamp) {
+    if (window->numberOfMessages == 0) {
+        return false;
+    }
+    return (timestamp >= window->windowEnd) || (timestamp < window->firstTimestamp);
+}
+
+/**
+ * @brief Adds a message time tag to the window.  Consecutive windows are
+ * contiguous so that the average output rate is exact.  A new window is
+ * started at the time tag after a gap of more than one period.
+ * @param window Address of window structure.
+ * @param timestamp Time tag of message.
+ */
+static void AddToWindow(NgimuDecimateWindow * const window, const uint64_t timestamp) {
+    if (window->numberOfMessages == 0) {
+        window->firstTimestamp = timestamp;
+        if ((timestamp >= window->windowEnd) && ((timestamp - window->windowEnd) < window->period)) {
+            window->windowEnd += window->period;
+        } else if ((timestamp >= window->windowEnd) || ((window->windowEnd - timestamp) > window->period)) {
+            window->windowEnd = timestamp + window->period;
+        }
+    }
+    window->lastTimestamp = timestamp;
+    window->numberOfMessages++;
+}
+
+/**
+ * @brief Returns the midpoint of the first and last time tags of the window.
+ * @param window Address of window structure.
+ * @return Time tag.
+ */
+static uint64_t GetWindowTimestamp(const NgimuDecimateWindow * const window) {
+    return window->firstTimestamp + ((window->lastTimestamp - window->firstTimestamp) / 2);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Provides the average of the "/sensors" window through the callback
+ * and clears the window.
+ * @param ngimuDecimate Address of decimation structure.
+ */
+static void EmitSensors(NgimuDecimate * const ngimuDecimate) {
+    NgimuDecimateWindow * const window = &ngimuDecimate->sensorsWindow;
+    const NgimuSensors * const sum = &ngimuDecimate->sensorsSum;
+    NgimuSensors * const ngimuSensors = &ngimuDecimate->ngimuSensors;
+    const float scale = 1.0f / (float) window->numberOfMessages;
+    ngimuSensors->timestamp.value = GetWindowTimestamp(window);
+    ngimuSensors->gyroscopeX = scale * sum->gyroscopeX;
+    ngimuSensors->gyroscopeY = scale * sum->gyroscopeY;
+    ngimuSensors->gyroscopeZ = scale * sum->gyroscopeZ;
+    ngimuSensors->accelerometerX = scale * sum->accelerometerX;
+    ngimuSensors->accelerometerY = scale * sum->accelerometerY;
+    ngimuSensors->accelerometerZ = scale * sum->accelerometerZ;
+    ngimuSensors->magnetometerX = scale * sum->magnetometerX;
+    ngimuSensors->magnetometerY = scale * sum->magnetometerY;
+    ngimuSensors->magnetometerZ = scale * sum->magnetometerZ;
+    ngimuSensors->barometer = scale * sum->barometer;
+    window->numberOfMessages = 0;
+    memset(&ngimuDecimate->sensorsSum, 0, sizeof (ngimuDecimate->sensorsSum));
+    if (ngimuDecimate->sensorsCallback != NULL) {
+        ngimuDecimate->sensorsCallback(ngimuSensors, ngimuDecimate->sensorsUserContext);
+    }
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Provides the normalised sum of the "/quaternion" window through the
+ * callback and clears the window.
+ * @param ngimuDecimate Address of decimation structure.
+ */
+static void EmitQuaternion(NgimuDecimate * const ngimuDecimate) {
+    NgimuDecimateWindow * const window = &ngimuDecimate->quaternionWindow;
+    const NgimuQuaternion * const sum = &ngimuDecimate->quaternionSum;
+    NgimuQuaternion * const ngimuQuaternion = &ngimuDecimate->ngimuQuaternion;
+    const float norm = sqrtf((sum->w * sum->w) + (sum->x * sum->x) + (sum->y * sum->y) + (sum->z * sum->z));
+    const float scale = (norm > 0.0f) ? (1.0f / norm) : 0.0f;
+    ngimuQuaternion->timestamp.value = GetWindowTimestamp(window);
+    ngimuQuaternion->w = scale * sum->w;
+    ngimuQuaternion->x = scale * sum->x;
+    ngimuQuaternion->y = scale * sum->y;
+    ngimuQuaternion->z = scale * sum->z;
+    window->numberOfMessages = 0;
+    memset(&ngimuDecimate->quaternionSum, 0, sizeof (ngimuDecimate->quaternionSum));
+    if (ngimuDecimate->quaternionCallback != NULL) {
+        ngimuDecimate->quaternionCallback(ngimuQuaternion, ngimuDecimate->quaternionUserContext);
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,89 @@
+/**
+ * @file NgimuDecimate.h
+ * @author Seb Madgwick
+ * @brief Decimation of "/sensors" and "/quaternion" messages to a lower output
+ * rate for consumers that do not require every message, e.g. a user interface
+ * or network forwarder.  Messages are averaged over windows of the output
+ * period measured using the OSC time tags so that the output rate does not
+ * depend on the message rate of the NGIMU.  "/sensors" messages are averaged
+ * using a boxcar average.  "/quaternion" messages are averaged as the
+ * normalised sum of quaternions in the same hemisphere.
+ */
+
+#ifndef NGIMU_DECIMATE_H
+#define NGIMU_DECIMATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuReceive.h"
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Averaging window.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    uint64_t period;
+    uint64_t windowEnd;
+    uint64_t firstTimestamp;
+    uint64_t lastTimestamp;
+    uint32_t numberOfMessages;
+} NgimuDecimateWindow;
+
+/**
+ * @brief Decimation structure.  Structure members are used internally and
+ * should not be used by the user application.
+ */
+typedef struct {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuDecimateWindow sensorsWindow;
+    NgimuSensors sensorsSum;
+    NgimuSensors ngimuSensors;
+    void (*sensorsCallback)(const NgimuSensors * const ngimuSensors, void * const userContext);
+    void* sensorsUserContext;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuDecimateWindow quaternionWindow;
+    NgimuQuaternion quaternionSum;
+    NgimuQuaternion ngimuQuaternion;
+    void (*quaternionCallback)(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+    void* quaternionUserContext;
+#endif
+#if !NGIMU_RECEIVE_ENABLE_SENSORS && !NGIMU_RECEIVE_ENABLE_QUATERNION
+    char unused; // a structure must have at least one member
+#endif
+} NgimuDecimate;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+void NgimuDecimateInitialise(NgimuDecimate * const ngimuDecimate);
+void NgimuDecimateSetReceiverCallbacks(NgimuDecimate * const ngimuDecimate, NgimuReceiver * const ngimuReceiver);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+void NgimuDecimateSetSensorsRate(NgimuDecimate * const ngimuDecimate, const float rate);
+void NgimuDecimateSetSensorsCallback(NgimuDecimate * const ngimuDecimate, void (*newSensorsCallback)(const NgimuSensors * const ngimuSensors, void * const userContext), void * const userContext);
+void NgimuDecimateSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+void NgimuDecimateSetQuaternionRate(NgimuDecimate * const ngimuDecimate, const float rate);
+void NgimuDecimateSetQuaternionCallback(NgimuDecimate * const ngimuDecimate, void (*newQuaternionCallback)(const NgimuQuaternion * const ngimuQuaternion, void * const userContext), void * const userContext);
+void NgimuDecimateQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+#endif
+void NgimuDecimateFlush(NgimuDecimate * const ngimuDecimate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
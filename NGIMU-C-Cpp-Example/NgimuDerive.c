@@ -0,0 +1,260 @@
+/**
+ * @file NgimuDerive.c
+ * @author Seb Madgwick
+ * @brief Conversion of "/quaternion" messages to Euler angles and rotation
+ * matrices so that the NGIMU need only send "/quaternion" messages.  The
+ * approximations use polynomials and selects rather than branches so that the
+ * column functions may be vectorised by the compiler, e.g. GCC with -O3 and
+ * -fno-math-errno.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuDerive.h"
+#include <float.h> // FLT_MIN
+#include <math.h> // asinf, atan2f, copysignf, fabsf, sqrtf
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Conversion from radians to degrees.
+ */
+#define DEGREES_PER_RADIAN (57.2957795f)
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+static void QuaternionColumnsToEuler(const float * restrict const w, const float * restrict const x, const float * restrict const y, const float * restrict const z, float * restrict const roll, float * restrict const pitch, float * restrict const yaw, const size_t count, const NgimuDerivedAccuracy derivedAccuracy);
+static inline float Roll(const float w, const float x, const float y, const float z, const NgimuDerivedAccuracy derivedAccuracy);
+static inline float Pitch(const float w, const float x, const float y, const float z, const NgimuDerivedAccuracy derivedAccuracy);
+static inline float Yaw(const float w, const float x, const float y, const float z, const NgimuDerivedAccuracy derivedAccuracy);
+static inline float Atan2(const float y, const float x, const NgimuDerivedAccuracy derivedAccuracy);
+static inline float Asin(const float value, const NgimuDerivedAccuracy derivedAccuracy);
+#endif
+
+//------------------------------------------------------------------------------
+// Functions
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief Derives Euler angles from a "/quaternion" message.  The angles are in
+ * degrees and use the same ZYX convention as "/euler" messages.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ * @param ngimuEuler Address of "/euler" structure to be written.
+ * @param derivedAccuracy Accuracy.
+ */
+void NgimuDeriveEuler(const NgimuQuaternion * const ngimuQuaternion, NgimuEuler * const ngimuEuler, const NgimuDerivedAccuracy derivedAccuracy) {
+    ngimuEuler->timestamp = ngimuQuaternion->timestamp;
+    const float w = ngimuQuaternion->w;
+    const float x = ngimuQuaternion->x;
+    const float y = ngimuQuaternion->y;
+    const float z = ngimuQuaternion->z;
+    ngimuEuler->roll = Roll(w, x, y, z, derivedAccuracy);
+    ngimuEuler->pitch = Pitch(w, x, y, z, derivedAccuracy);
+    ngimuEuler->yaw = Yaw(w, x, y, z, derivedAccuracy);
+}
+
+/**
+ * @brief Derives Euler angles from all messages in the "/quaternion" columns
+ * and appends them to the "/euler" columns.  Messages that do not fit in the
+ * "/euler" columns are discarded and counted.  The "/quaternion" columns are
+ * not modified.
+ * @param quaternionColumns Address of "/quaternion" columns structure.
+ * @param eulerColumns Address of "/euler" columns structure.
+ * @param derivedAccuracy Accuracy.
+ */
+void NgimuDeriveEulerColumns(const NgimuQuaternionColumns * const quaternionColumns, NgimuEulerColumns * const eulerColumns, const NgimuDerivedAccuracy derivedAccuracy) {
+
+    // Limit count to available capacity
+    const size_t available = eulerColumns->capacity - eulerColumns->count;
+    const size_t count = (quaternionColumns->count < available) ? quaternionColumns->count : available;
+    eulerColumns->numberOfDiscarded += quaternionColumns->count - count;
+
+    // Convert
+    const size_t offset = eulerColumns->count;
+    QuaternionColumnsToEuler(quaternionColumns->w, quaternionColumns->x, quaternionColumns->y, quaternionColumns->z, &eulerColumns->roll[offset], &eulerColumns->pitch[offset], &eulerColumns->yaw[offset], count, derivedAccuracy);
+    size_t index;
+    for (index = 0; index < count; index++) {
+        eulerColumns->timestamp[offset + index] = quaternionColumns->timestamp[index];
+    }
+    eulerColumns->count += count;
+}
+#endif
+
+/**
+ * @brief Derives a rotation matrix from a "/quaternion" message.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ * @param ngimuRotationMatrix Address of rotation matrix structure to be
+ * written.
+ */
+void NgimuDeriveRotationMatrix(const NgimuQuaternion * const ngimuQuaternion, NgimuRotationMatrix * const ngimuRotationMatrix) {
+    const float w = ngimuQuaternion->w;
+    const float x = ngimuQuaternion->x;
+    const float y = ngimuQuaternion->y;
+    const float z = ngimuQuaternion->z;
+    const float ww = w * w;
+    const float wx = w * x;
+    const float wy = w * y;
+    const float wz = w * z;
+    const float xy = x * y;
+    const float xz = x * z;
+    const float yz = y * z;
+    ngimuRotationMatrix->timestamp = ngimuQuaternion->timestamp;
+    ngimuRotationMatrix->xx = 2.0f * (ww - 0.5f + x * x);
+    ngimuRotationMatrix->xy = 2.0f * (xy - wz);
+    ngimuRotationMatrix->xz = 2.0f * (xz + wy);
+    ngimuRotationMatrix->yx = 2.0f * (xy + wz);
+    ngimuRotationMatrix->yy = 2.0f * (ww - 0.5f + y * y);
+    ngimuRotationMatrix->yz = 2.0f * (yz - wx);
+    ngimuRotationMatrix->zx = 2.0f * (xz - wy);
+    ngimuRotationMatrix->zy = 2.0f * (yz + wx);
+    ngimuRotationMatrix->zz = 2.0f * (ww - 0.5f + z * z);
+}
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief Converts quaternion columns to Euler angle columns.  The accuracy is
+ * selected outside of the loops so that each loop is free of branches.  The
+ * columns are restrict qualified so that the compiler need not check for
+ * aliasing.
+ * @param w Quaternion w column.
+ * @param x Quaternion x column.
+ * @param y Quaternion y column.
+ * @param z Quaternion z column.
+ * @param roll Roll column to be written.
+ * @param pitch Pitch column to be written.
+ * @param yaw Yaw column to be written.
+ * @param count Number of elements.
+ * @param derivedAccuracy Accuracy.
+ */
+static void QuaternionColumnsToEuler(const float * restrict const w, const float * restrict const x, const float * restrict const y, const float * restrict const z, float * restrict const roll, float * restrict const pitch, float * restrict const yaw, const size_t count, const NgimuDerivedAccuracy derivedAccuracy) {
+    size_t index;
+    switch (derivedAccuracy) {
+        case NgimuDerivedAccuracyExact:
+            for (index = 0; index < count; index++) {
+                roll[index] = Roll(w[index], x[index], y[index], z[index], NgimuDerivedAccuracyExact);
+                pitch[index] = Pitch(w[index], x[index], y[index], z[index], NgimuDerivedAccuracyExact);
+                yaw[index] = Yaw(w[index], x[index], y[index], z[index], NgimuDerivedAccuracyExact);
+            }
+            break;
+        case NgimuDerivedAccuracyHigh:
+            for (index = 0; index < count; index++) {
+                roll[index] = Roll(w[index], x[index], y[index], z[index], NgimuDerivedAccuracyHigh);
+                pitch[index] = Pitch(w[index], x[index], y[index], z[index], NgimuDerivedAccuracyHigh);
+                yaw[index] = Yaw(w[index], x[index], y[index], z[index], NgimuDerivedAccuracyHigh);
+            }
+            break;
+        case NgimuDerivedAccuracyLow:
+            for (index = 0; index < count; index++) {
+                roll[index] = Roll(w[index], x[index], y[index], z[index], NgimuDerivedAccuracyLow);
+                pitch[index] = Pitch(w[index], x[index], y[index], z[index], NgimuDerivedAccuracyLow);
+                yaw[index] = Yaw(w[index], x[index], y[index], z[index], NgimuDerivedAccuracyLow);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Converts a quaternion to the ZYX Euler roll angle in degrees.
+ * @param w Quaternion w element.
+ * @param x Quaternion x element.
+ * @param y Quaternion y element.
+ * @param z Quaternion z element.
+ * @param derivedAccuracy Accuracy.
+ * @return Roll angle in degrees.
+ */
+static inline float Roll(const float w, const float x, const float y, const float z, const NgimuDerivedAccuracy derivedAccuracy) {
+    return Atan2(w * x + y * z, 0.5f - y * y - x * x, derivedAccuracy);
+}
+
+/**
+ * @brief Converts a quaternion to the ZYX Euler pitch angle in degrees.
+ * @param w Quaternion w element.
+ * @param x Quaternion x element.
+ * @param y Quaternion y element.
+ * @param z Quaternion z element.
+ * @param derivedAccuracy Accuracy.
+ * @return Pitch angle in degrees.
+ */
+static inline float Pitch(const float w, const float x, const float y, const float z, const NgimuDerivedAccuracy derivedAccuracy) {
+    return Asin(-2.0f * (x * z - w * y), derivedAccuracy);
+}
+
+/**
+ * @brief Converts a quaternion to the ZYX Euler yaw angle in degrees.
+ * @param w Quaternion w element.
+ * @param x Quaternion x element.
+ * @param y Quaternion y element.
+ * @param z Quaternion z element.
+ * @param derivedAccuracy Accuracy.
+ * @return Yaw angle in degrees.
+ */
+static inline float Yaw(const float w, const float x, const float y, const float z, const NgimuDerivedAccuracy derivedAccuracy) {
+    return Atan2(w * z + x * y, 0.5f - y * y - z * z, derivedAccuracy);
+}
+
+/**
+ * @brief Four-quadrant arctangent in degrees.  The approximations evaluate a
+ * polynomial of the ratio of the smaller to the larger magnitude and then
+ * select the octant.  The ratio and octant are calculated without operations
+ * inside conditional expressions so that the compiler does not introduce
+ * branches.
+ * @param y Y value.
+ * @param x X value.
+ * @param derivedAccuracy Accuracy.
+ * @return Angle in degrees.
+ */
+static inline float Atan2(const float y, const float x, const NgimuDerivedAccuracy derivedAccuracy) {
+    if (derivedAccuracy == NgimuDerivedAccuracyExact) {
+        return DEGREES_PER_RADIAN * atan2f(y, x);
+    }
+
+    // Arctangent of ratio in first octant
+    const float absoluteX = fabsf(x);
+    const float absoluteY = fabsf(y);
+    const float sum = absoluteX + absoluteY;
+    const float difference = fabsf(absoluteX - absoluteY);
+    const float ratio = (sum - difference) / (sum + difference + FLT_MIN); // minimum / maximum, FLT_MIN avoids 0 / 0
+    const float ratioSquared = ratio * ratio;
+    float angle;
+    if (derivedAccuracy == NgimuDerivedAccuracyHigh) {
+        angle = ratio * (0.9998660f + ratioSquared * (-0.3302995f + ratioSquared * (0.1801410f + ratioSquared * (-0.0851330f + ratioSquared * 0.0208351f))));
+    } else {
+        angle = ratio * (0.7853982f + (1.0f - ratio) * (0.2447f + 0.0663f * ratio));
+    }
+    angle *= DEGREES_PER_RADIAN;
+
+    // Select octant using only selects of constants and negations, which cannot trap
+    const bool swapped = absoluteY > absoluteX;
+    angle = (swapped ? 90.0f : 0.0f) + (swapped ? -angle : angle);
+    const bool negativeX = x < 0.0f;
+    angle = (negativeX ? 180.0f : 0.0f) + (negativeX ? -angle : angle);
+    return copysignf(angle, y);
+}
+
+/**
+ * @brief Arcsine in degrees.  The value is clamped to between -1 and 1 to
+ * tolerate quaternions that are not exactly normalised.  The approximations
+ * use the identity asin(v) = atan2(v, sqrt(1 - v * v)).
+ * @param value Value.
+ * @param derivedAccuracy Accuracy.
+ * @return Angle in degrees.
+ */
+static inline float Asin(const float value, const NgimuDerivedAccuracy derivedAccuracy) {
+    const float clamped = 0.5f * (fabsf(value + 1.0f) - fabsf(value - 1.0f));
+    if (derivedAccuracy == NgimuDerivedAccuracyExact) {
+        return DEGREES_PER_RADIAN * asinf(clamped);
+    }
+    return Atan2(clamped, sqrtf(1.0f - clamped * clamped), derivedAccuracy);
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,41 @@
+/**
+ * @file NgimuDerive.h
+ * @author Seb Madgwick
+ * @brief Conversion of "/quaternion" messages to Euler angles and rotation
+ * matrices so that the NGIMU need only send "/quaternion" messages.  The
+ * approximations use polynomials and selects rather than branches so that the
+ * column functions may be vectorised by the compiler, e.g. GCC with -O3 and
+ * -fno-math-errno.
+ */
+
+#ifndef NGIMU_DERIVE_H
+#define NGIMU_DERIVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuReceive.h"
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+#if NGIMU_RECEIVE_ENABLE_EULER
+void NgimuDeriveEuler(const NgimuQuaternion * const ngimuQuaternion, NgimuEuler * const ngimuEuler, const NgimuDerivedAccuracy derivedAccuracy);
+void NgimuDeriveEulerColumns(const NgimuQuaternionColumns * const quaternionColumns, NgimuEulerColumns * const eulerColumns, const NgimuDerivedAccuracy derivedAccuracy);
+#endif
+void NgimuDeriveRotationMatrix(const NgimuQuaternion * const ngimuQuaternion, NgimuRotationMatrix * const ngimuRotationMatrix);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,554 @@
+/**
+ * @file NgimuFuzz.c
+ * @author Seb Madgwick
+ * @brief Fuzz and worst-case timing harness of the NgimuReceive decode path.
+ * Generates valid, mutated and hostile input, e.g. malformed SLIP, truncated
+ * OSC, bad bundle element sizes, deeply nested bundles and packets of many
+ * messages, and records the worst-case duration and number of callbacks of
+ * each call of NgimuReceiverProcessSerialByte and
+ * NgimuReceiverProcessUdpPacket.  The worst-case input of each generated input
+ * is then repeated and the minimum duration of its longest call is recorded so
+ * that the worst-case duration excludes interrupts and preemption.  The
+ * module is platform independent; the
+ * platform provides a tick counter so that the bound may be measured on the
+ * target.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuFuzz.h"
+#include "NgimuSynthesiser.h"
+#include <string.h> // memcpy, memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Size of the generated packet buffer.  Oversized packets are up to
+ * twice the maximum packet size.
+ */
+#define PACKET_BUFFER_SIZE (2 * NGIMU_RECEIVE_MAX_PACKET_SIZE)
+
+/**
+ * @brief Size of the SLIP frame buffer.  Every byte of a packet may be escaped
+ * and the frame may contain an additional invalid escape sequence.
+ */
+#define FRAME_BUFFER_SIZE ((2 * PACKET_BUFFER_SIZE) + 3)
+
+/**
+ * @brief Size of a bundle element containing a "/sensors" message.
+ */
+#define SENSORS_ELEMENT_SIZE (4 + 12 + 12 + (10 * 4))
+
+//------------------------------------------------------------------------------
+// Variable declarations
+
+static const char * const scenarioNames[NgimuFuzzNumberOfScenarios] = {
+    "Serial byte",
+    "UDP packet",
+};
+static const char * const inputNames[NgimuFuzzNumberOfInputs] = {
+    "Valid",
+    "Mutated",
+    "Truncated",
+    "Bad element size",
+    "Deep bundle",
+    "Many messages",
+    "Oversized",
+    "Random bytes",
+};
+static NgimuSynthesiser ngimuSynthesiser;
+static size_t numberOfCallbacks;
+static size_t numberOfMessages;
+static size_t numberOfErrors;
+static NgimuReceiver ngimuReceiver;
+static char packet[PACKET_BUFFER_SIZE];
+static char frame[FRAME_BUFFER_SIZE];
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static void InitialiseReceiver();
+static size_t ProcessGeneratedInput(const NgimuFuzzSettings * const settings, const NgimuFuzzScenario scenario, const NgimuFuzzInput input, NgimuFuzzResult * const result, NgimuFuzzInputResult * const callsResult);
+static size_t WriteNestedBundle(char * const destination, const size_t depth);
+static size_t WriteManyMessages(char * const destination, const size_t maxSize);
+static void Mutate(char * const destination, const size_t size);
+static size_t WriteInput(char * const destination, const NgimuFuzzInput input);
+static size_t WriteFrame(char * const destination, const char * const source, const size_t sourceSize, const NgimuFuzzInput input);
+static void RecordCall(const NgimuFuzzSettings * const settings, NgimuFuzzResult * const result, const NgimuFuzzInput input, const uint64_t startTicks, NgimuFuzzInputResult * const callsResult);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static void SensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+static void QuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+static void EulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext);
+#endif
+static void ReceiveErrorCallback(const NgimuReceiveError * const ngimuReceiveError, void * const userContext);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Runs fuzz scenario.  Each iteration generates one input and processes
+ * it as one UDP packet or as a SLIP frame, one byte at a time.  Each process
+ * function call is timed.  The worst-case input of each generated input, the
+ * input with the most callbacks of one call and then the most bytes, is then
+ * regenerated and processed NGIMU_FUZZ_REPETITIONS times by a newly
+ * initialised receiver, and the minimum duration of its longest call is
+ * recorded.  A single call may be interrupted or preempted so the maximum
+ * duration is only indicative; the repeated duration is compared with the
+ * budget.
+ * @param settings Fuzz settings.
+ * @param scenario Fuzz scenario.
+ * @param result Address of result structure to be written.
+ */
+void NgimuFuzzRun(const NgimuFuzzSettings * const settings, const NgimuFuzzScenario scenario, NgimuFuzzResult * const result) {
+    memset(result, 0, sizeof (*result));
+    result->name = scenarioNames[scenario];
+    NgimuSynthesiserInitialise(&ngimuSynthesiser, settings->seed);
+    numberOfMessages = 0;
+    numberOfErrors = 0;
+    InitialiseReceiver();
+
+    // Process each input
+    uint32_t worstRandomStates[NgimuFuzzNumberOfInputs];
+    size_t worstCallbacks[NgimuFuzzNumberOfInputs];
+    size_t worstSizes[NgimuFuzzNumberOfInputs];
+    memset(worstRandomStates, 0, sizeof (worstRandomStates));
+    memset(worstCallbacks, 0, sizeof (worstCallbacks));
+    memset(worstSizes, 0, sizeof (worstSizes));
+    unsigned int iteration;
+    for (iteration = 0; iteration < settings->iterations; iteration++) {
+        const NgimuFuzzInput input = (NgimuFuzzInput) (NgimuSynthesiserRandom(&ngimuSynthesiser) % NgimuFuzzNumberOfInputs);
+        const uint32_t randomState = ngimuSynthesiser.randomState;
+        NgimuFuzzInputResult callsResult;
+        const size_t size = ProcessGeneratedInput(settings, scenario, input, result, &callsResult);
+        if ((callsResult.maxCallbacksPerCall > worstCallbacks[input]) || ((callsResult.maxCallbacksPerCall == worstCallbacks[input]) && (size >= worstSizes[input]))) {
+            worstRandomStates[input] = randomState;
+            worstCallbacks[input] = callsResult.maxCallbacksPerCall;
+            worstSizes[input] = size;
+        }
+        result->numberOfBytes += size;
+    }
+    result->numberOfMessages = numberOfMessages;
+    result->numberOfErrors = numberOfErrors;
+
+    // Repeat worst-case input of each generated input
+    NgimuFuzzInput input;
+    for (input = 0; input < NgimuFuzzNumberOfInputs; input++) {
+        NgimuFuzzInputResult * const inputResult = &result->inputs[input];
+        if (inputResult->numberOfCalls == 0) {
+            continue;
+        }
+        unsigned int repetition;
+        for (repetition = 0; repetition < NGIMU_FUZZ_REPETITIONS; repetition++) {
+            ngimuSynthesiser.randomState = worstRandomStates[input];
+            InitialiseReceiver();
+            NgimuFuzzInputResult callsResult;
+            ProcessGeneratedInput(settings, scenario, input, NULL, &callsResult);
+            if ((repetition == 0) || (callsResult.maxNanosecondsPerCall < inputResult->repeatedNanosecondsPerCall)) {
+                inputResult->repeatedNanosecondsPerCall = callsResult.maxNanosecondsPerCall;
+            }
+        }
+        if (inputResult->repeatedNanosecondsPerCall > result->repeatedNanosecondsPerCall) {
+            result->repeatedNanosecondsPerCall = inputResult->repeatedNanosecondsPerCall;
+        }
+    }
+
+    // Write result
+    result->withinBound = (result->maxCallbacksPerCall <= NGIMU_FUZZ_MAX_CALLBACKS_PER_CALL) && ((settings->budgetNanoseconds <= 0.0) || (result->repeatedNanosecondsPerCall <= settings->budgetNanoseconds));
+}
+
+/**
+ * @brief Processes arbitrary input, e.g. from a coverage-guided fuzzer such as
+ * libFuzzer.  The input is processed as one UDP packet, as a serial stream one
+ * byte at a time and as a serial block decoded in place, each by a newly
+ * initialised receiver.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ * @return Maximum number of callbacks of one NgimuReceiverProcessUdpPacket or
+ * NgimuReceiverProcessSerialByte call.
+ */
+size_t NgimuFuzzProcessInput(const char * const source, const size_t sourceSize) {
+    size_t maxCallbacksPerCall;
+
+    // Process as UDP packet
+    InitialiseReceiver();
+    numberOfCallbacks = 0;
+    NgimuReceiverProcessUdpPacket(&ngimuReceiver, source, sourceSize);
+    maxCallbacksPerCall = numberOfCallbacks;
+
+    // Process as serial stream
+    InitialiseReceiver();
+    size_t index;
+    for (index = 0; index < sourceSize; index++) {
+        numberOfCallbacks = 0;
+        NgimuReceiverProcessSerialByte(&ngimuReceiver, source[index]);
+        if (numberOfCallbacks > maxCallbacksPerCall) {
+            maxCallbacksPerCall = numberOfCallbacks;
+        }
+    }
+
+    // Process as serial block in place
+    InitialiseReceiver();
+    const size_t frameSize = (sourceSize < sizeof (frame)) ? sourceSize : sizeof (frame);
+    memcpy(frame, source, frameSize);
+    NgimuReceiverProcessSerialBytesInPlace(&ngimuReceiver, frame, frameSize);
+    return maxCallbacksPerCall;
+}
+
+/**
+ * @brief Returns the name of a generated input.
+ * @param input Generated input.
+ * @return Name of the generated input.
+ */
+const char* NgimuFuzzGetInputName(const NgimuFuzzInput input) {
+    return (input < NgimuFuzzNumberOfInputs) ? inputNames[input] : "";
+}
+
+/**
+ * @brief Initialises the receiver and assigns all message callbacks so that
+ * every message is decoded.
+ */
+static void InitialiseReceiver() {
+    NgimuReceiverInitialise(&ngimuReceiver);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuReceiverSetSensorsCallback(&ngimuReceiver, SensorsCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuReceiverSetQuaternionCallback(&ngimuReceiver, QuaternionCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuReceiverSetEulerCallback(&ngimuReceiver, EulerCallback);
+#endif
+    NgimuReceiverSetReceiveErrorCallback(&ngimuReceiver, ReceiveErrorCallback);
+}
+
+/**
+ * @brief Generates input and processes it as one UDP packet or as a SLIP
+ * frame, one byte at a time.  Each process function call is timed.
+ * @param settings Fuzz settings.
+ * @param scenario Fuzz scenario.
+ * @param input Generated input.
+ * @param result Address of result structure, or NULL if the calls are not to
+ * be recorded in the result.
+ * @param callsResult Address of structure to be written with the worst case
+ * of the calls of this input only.
+ * @return Number of bytes processed.
+ */
+static size_t ProcessGeneratedInput(const NgimuFuzzSettings * const settings, const NgimuFuzzScenario scenario, const NgimuFuzzInput input, NgimuFuzzResult * const result, NgimuFuzzInputResult * const callsResult) {
+    memset(callsResult, 0, sizeof (*callsResult));
+    const size_t packetSize = WriteInput(packet, input);
+    if (scenario == NgimuFuzzScenarioUdpPacket) {
+        numberOfCallbacks = 0;
+        const uint64_t startTicks = settings->getTicks();
+        NgimuReceiverProcessUdpPacket(&ngimuReceiver, packet, packetSize);
+        RecordCall(settings, result, input, startTicks, callsResult);
+        return packetSize;
+    }
+    const size_t frameSize = WriteFrame(frame, packet, packetSize, input);
+    size_t index;
+    for (index = 0; index < frameSize; index++) {
+        numberOfCallbacks = 0;
+        const uint64_t startTicks = settings->getTicks();
+        NgimuReceiverProcessSerialByte(&ngimuReceiver, frame[index]);
+        RecordCall(settings, result, input, startTicks, callsResult);
+    }
+    return frameSize;
+}
+
+/**
+ * @brief Writes OSC bundles nested to the depth around one message.
+ * @param destination Destination.
+ * @param depth Number of nested bundles.
+ * @return Number of bytes written.
+ */
+static size_t WriteNestedBundle(char * const destination, const size_t depth) {
+    size_t size = 0;
+    size_t level;
+    for (level = 0; level < depth; level++) {
+        size += NgimuSynthesiserWriteBundleHeader(&ngimuSynthesiser, &destination[size]);
+        size += 4; // element size written below
+    }
+    size += NgimuSynthesiserWriteMessage(&ngimuSynthesiser, &destination[size], "/quaternion", 4);
+
+    // Write element sizes
+    for (level = 1; level <= depth; level++) {
+        const size_t elementSizeIndex = (level * (NGIMU_SYNTHESISER_BUNDLE_HEADER_SIZE + 4)) - 4;
+        NgimuSynthesiserWriteBigEndian32(&destination[elementSizeIndex], (uint32_t) (size - (elementSizeIndex + 4)));
+    }
+    return size;
+}
+
+/**
+ * @brief Writes an OSC bundle of as many messages as fit in the size.  The
+ * messages are either "/sensors" messages, messages with an unrecognised
+ * address or "/sensors" messages without arguments so that each message
+ * results in a message callback or a receive error callback.  The number of
+ * messages is limited to NGIMU_RECEIVE_MAX_MESSAGES_PER_PACKET for half of
+ * bundles so that the worst-case accepted packet is generated.
+ * @param destination Destination.
+ * @param maxSize Maximum number of bytes to be written.
+ * @return Number of bytes written.
+ */
+static size_t WriteManyMessages(char * const destination, const size_t maxSize) {
+    const uint32_t type = NgimuSynthesiserRandom(&ngimuSynthesiser) % 3;
+    const size_t maxNumberOfMessages = ((NgimuSynthesiserRandom(&ngimuSynthesiser) % 2) == 0) ? NGIMU_RECEIVE_MAX_MESSAGES_PER_PACKET : (size_t) -1;
+    size_t size = NgimuSynthesiserWriteBundleHeader(&ngimuSynthesiser, destination);
+    size_t count;
+    for (count = 0; (count < maxNumberOfMessages) && ((size + SENSORS_ELEMENT_SIZE) <= maxSize); count++) {
+        switch (type) {
+            case 0:
+                size += NgimuSynthesiserWriteElement(&ngimuSynthesiser, &destination[size], "/sensors", 10);
+                break;
+            case 1:
+                size += NgimuSynthesiserWriteElement(&ngimuSynthesiser, &destination[size], "/x", 0);
+                break;
+            default:
+                size += NgimuSynthesiserWriteElement(&ngimuSynthesiser, &destination[size], "/sensors", 0);
+                break;
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Modifies a random byte or aligned 32-bit word of a packet.
+ * @param destination Packet.
+ * @param size Packet size.
+ */
+static void Mutate(char * const destination, const size_t size) {
+    static const char bytes[] = {0, (char) 0xFF, '/', '#', ',', 'f', SLIP_END, SLIP_ESC};
+    if (size == 0) {
+        return;
+    }
+    const size_t index = NgimuSynthesiserRandom(&ngimuSynthesiser) % size;
+    switch (NgimuSynthesiserRandom(&ngimuSynthesiser) % 4) {
+        case 0:
+            destination[index] ^= (char) (1 << (NgimuSynthesiserRandom(&ngimuSynthesiser) % 8));
+            break;
+        case 1:
+            destination[index] = (char) NgimuSynthesiserRandom(&ngimuSynthesiser);
+            break;
+        case 2:
+            destination[index] = bytes[NgimuSynthesiserRandom(&ngimuSynthesiser) % sizeof (bytes)];
+            break;
+        default:
+            if (size >= 4) {
+                const uint32_t words[] = {0, 0xFFFFFFFF, 0x7FFFFFFF, 0x80000000, (uint32_t) size, (uint32_t) size - 4, (uint32_t) size + 4, NgimuSynthesiserRandom(&ngimuSynthesiser)};
+                NgimuSynthesiserWriteBigEndian32(&destination[(index & ~(size_t) 3) % (size & ~(size_t) 3)], words[NgimuSynthesiserRandom(&ngimuSynthesiser) % (sizeof (words) / sizeof (words[0]))]);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Writes generated input.
+ * @param destination Destination of PACKET_BUFFER_SIZE bytes.
+ * @param input Generated input.
+ * @return Number of bytes written.
+ */
+static size_t WriteInput(char * const destination, const NgimuFuzzInput input) {
+    size_t size = 0;
+    switch (input) {
+        case NgimuFuzzInputValid:
+            size = NgimuSynthesiserWritePacket(&ngimuSynthesiser, destination);
+            break;
+        case NgimuFuzzInputMutated:
+        {
+            size = NgimuSynthesiserWritePacket(&ngimuSynthesiser, destination);
+            const uint32_t numberOfMutations = 1 + (NgimuSynthesiserRandom(&ngimuSynthesiser) % 8);
+            uint32_t mutation;
+            for (mutation = 0; mutation < numberOfMutations; mutation++) {
+                Mutate(destination, size);
+            }
+            break;
+        }
+        case NgimuFuzzInputTruncated:
+            size = NgimuSynthesiserWritePacket(&ngimuSynthesiser, destination);
+            size = NgimuSynthesiserRandom(&ngimuSynthesiser) % size;
+            break;
+        case NgimuFuzzInputBadElementSize:
+        {
+            size = NgimuSynthesiserWriteBundleHeader(&ngimuSynthesiser, destination);
+            size += NgimuSynthesiserWriteElement(&ngimuSynthesiser, &destination[size], "/sensors", 10);
+            size += NgimuSynthesiserWriteElement(&ngimuSynthesiser, &destination[size], "/quaternion", 4);
+            const uint32_t elementSizes[] = {0, 1, 3, 0xFFFFFFFF, 0x7FFFFFFC, (uint32_t) size - NGIMU_SYNTHESISER_BUNDLE_HEADER_SIZE, (uint32_t) size - NGIMU_SYNTHESISER_BUNDLE_HEADER_SIZE - 4, (uint32_t) size};
+            NgimuSynthesiserWriteBigEndian32(&destination[NGIMU_SYNTHESISER_BUNDLE_HEADER_SIZE], elementSizes[NgimuSynthesiserRandom(&ngimuSynthesiser) % (sizeof (elementSizes) / sizeof (elementSizes[0]))]);
+            break;
+        }
+        case NgimuFuzzInputDeepBundle:
+        {
+            const size_t maxDepth = (NGIMU_RECEIVE_MAX_PACKET_SIZE - 64) / (NGIMU_SYNTHESISER_BUNDLE_HEADER_SIZE + 4);
+            const size_t depth = ((NgimuSynthesiserRandom(&ngimuSynthesiser) % 2) == 0) ? maxDepth : (1 + (NgimuSynthesiserRandom(&ngimuSynthesiser) % (2 * NGIMU_RECEIVE_MAX_BUNDLE_DEPTH)));
+            size = WriteNestedBundle(destination, depth);
+            break;
+        }
+        case NgimuFuzzInputManyMessages:
+            size = WriteManyMessages(destination, NGIMU_RECEIVE_MAX_PACKET_SIZE);
+            break;
+        case NgimuFuzzInputOversized:
+        {
+            const size_t minSize = NGIMU_RECEIVE_MAX_PACKET_SIZE + (NgimuSynthesiserRandom(&ngimuSynthesiser) % (NGIMU_RECEIVE_MAX_PACKET_SIZE / 2));
+            size = NgimuSynthesiserWriteBundleHeader(&ngimuSynthesiser, destination);
+            while (size <= minSize) {
+                size += NgimuSynthesiserWriteElement(&ngimuSynthesiser, &destination[size], "/sensors", 10);
+            }
+            break;
+        }
+        case NgimuFuzzInputRandomBytes:
+            size = NgimuSynthesiserRandom(&ngimuSynthesiser) % (NGIMU_RECEIVE_MAX_PACKET_SIZE + 1);
+            size_t index;
+            for (index = 0; index < size; index++) {
+                destination[index] = (char) NgimuSynthesiserRandom(&ngimuSynthesiser);
+            }
+            if ((size > 0) && ((NgimuSynthesiserRandom(&ngimuSynthesiser) % 2) == 0)) {
+                destination[0] = ((NgimuSynthesiserRandom(&ngimuSynthesiser) % 2) == 0) ? '/' : '#';
+            }
+            break;
+        case NgimuFuzzNumberOfInputs:
+            break;
+    }
+    return size;
+}
+
+/**
+ * @brief Writes SLIP frame of a packet.  The frame of an input other than a
+ * valid input may be corrupted by an invalid escape sequence, a missing END
+ * so that the packet runs into the next frame, or by not being SLIP encoded.
+ * @param destination Destination of FRAME_BUFFER_SIZE bytes.
+ * @param source Packet.
+ * @param sourceSize Packet size.
+ * @param input Generated input.
+ * @return Number of bytes written.
+ */
+static size_t WriteFrame(char * const destination, const char * const source, const size_t sourceSize, const NgimuFuzzInput input) {
+    const uint32_t corruption = (input == NgimuFuzzInputValid) ? 0 : (NgimuSynthesiserRandom(&ngimuSynthesiser) % 6);
+
+    // Write packet without SLIP encoding
+    if (corruption == 1) {
+        memcpy(destination, source, sourceSize);
+        destination[sourceSize] = SLIP_END;
+        return sourceSize + 1;
+    }
+
+    // SLIP encode packet
+    const size_t escapeIndex = (corruption == 2) ? (NgimuSynthesiserRandom(&ngimuSynthesiser) % (sourceSize + 1)) : (size_t) -1;
+    size_t size = 0;
+    size_t index;
+    for (index = 0; index < sourceSize; index++) {
+        if (index == escapeIndex) {
+            destination[size++] = SLIP_ESC;
+            destination[size++] = 'x';
+        }
+        if (source[index] == SLIP_END) {
+            destination[size++] = SLIP_ESC;
+            destination[size++] = SLIP_ESC_END;
+        } else if (source[index] == SLIP_ESC) {
+            destination[size++] = SLIP_ESC;
+            destination[size++] = SLIP_ESC_ESC;
+        } else {
+            destination[size++] = source[index];
+        }
+    }
+    if (corruption != 3) {
+        destination[size++] = SLIP_END;
+    }
+    return size;
+}
+
+/**
+ * @brief Records the duration and number of callbacks of a process function
+ * call.
+ * @param settings Fuzz settings.
+ * @param result Address of result structure, or NULL if the call is only to be
+ * recorded in the calls result.
+ * @param input Generated input.
+ * @param startTicks Tick count before the call.
+ * @param callsResult Address of the worst case of the calls of the input.
+ */
+static void RecordCall(const NgimuFuzzSettings * const settings, NgimuFuzzResult * const result, const NgimuFuzzInput input, const uint64_t startTicks, NgimuFuzzInputResult * const callsResult) {
+    const double nanoseconds = ((double) (settings->getTicks() - startTicks) * 1E9) / settings->ticksPerSecond;
+    callsResult->numberOfCalls++;
+    if (numberOfCallbacks > callsResult->maxCallbacksPerCall) {
+        callsResult->maxCallbacksPerCall = numberOfCallbacks;
+    }
+    if (nanoseconds > callsResult->maxNanosecondsPerCall) {
+        callsResult->maxNanosecondsPerCall = nanoseconds;
+    }
+    if (result == NULL) {
+        return;
+    }
+    NgimuFuzzInputResult * const inputResult = &result->inputs[input];
+    inputResult->numberOfCalls++;
+    if (numberOfCallbacks > inputResult->maxCallbacksPerCall) {
+        inputResult->maxCallbacksPerCall = numberOfCallbacks;
+    }
+    if (nanoseconds > inputResult->maxNanosecondsPerCall) {
+        inputResult->maxNanosecondsPerCall = nanoseconds;
+    }
+    if (numberOfCallbacks > result->maxCallbacksPerCall) {
+        result->maxCallbacksPerCall = numberOfCallbacks;
+    }
+    if (nanoseconds > result->maxNanosecondsPerCall) {
+        result->maxNanosecondsPerCall = nanoseconds;
+    }
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+
+/**
+ * @brief "/sensors" callback.
+ * @param ngimuSensors Address of "/sensors" structure.
+ * @param userContext Unused.
+ */
+static void SensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+    numberOfCallbacks++;
+    numberOfMessages++;
+}
+
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+
+/**
+ * @brief "/quaternion" callback.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ * @param userContext Unused.
+ */
+static void QuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+    numberOfCallbacks++;
+    numberOfMessages++;
+}
+
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+
+/**
+ * @brief "/euler" callback.
+ * @param ngimuEuler Address of "/euler" structure.
+ * @param userContext Unused.
+ */
+static void EulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+    numberOfCallbacks++;
+    numberOfMessages++;
+}
+
+#endif
+
+/**
+ * @brief Receive error callback.
+ * @param ngimuReceiveError Address of receive error structure.
+ * @param userContext Unused.
+ */
+static void ReceiveErrorCallback(const NgimuReceiveError * const ngimuReceiveError, void * const userContext) {
+    numberOfCallbacks++;
+    numberOfErrors++;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,131 @@
+/**
+ * @file NgimuFuzz.h
+ * @author Seb Madgwick
+ * @brief Fuzz and worst-case timing harness of the NgimuReceive decode path.
+ * Generates valid, mutated and hostile input, e.g. malformed SLIP, truncated
+ * OSC, bad bundle element sizes, deeply nested bundles and packets of many
+ * messages, and records the worst-case duration and number of callbacks of
+ * each call of NgimuReceiverProcessSerialByte and
+ * NgimuReceiverProcessUdpPacket.  The module is platform independent; the
+ * platform provides a tick counter so that the bound may be measured on the
+ * target.
+ */
+
+#ifndef NGIMU_FUZZ_H
+#define NGIMU_FUZZ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuReceive.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of callbacks of one process function call.  Each call
+ * completes at most one packet, and each message of the packet results in
+ * either a message callback or a receive error callback.  The packet may
+ * result in one further receive error callback.
+ */
+#define NGIMU_FUZZ_MAX_CALLBACKS_PER_CALL (NGIMU_RECEIVE_MAX_MESSAGES_PER_PACKET + 1)
+
+/**
+ * @brief Number of times that the worst-case input of each generated input is
+ * repeated to measure the worst-case duration without interrupts and
+ * preemption.
+ */
+#ifndef NGIMU_FUZZ_REPETITIONS
+#define NGIMU_FUZZ_REPETITIONS (1000)
+#endif
+
+/**
+ * @brief Fuzz scenario.
+ */
+typedef enum {
+    NgimuFuzzScenarioSerialByte,
+    NgimuFuzzScenarioUdpPacket,
+    NgimuFuzzNumberOfScenarios,
+} NgimuFuzzScenario;
+
+/**
+ * @brief Generated input.
+ */
+typedef enum {
+    NgimuFuzzInputValid,
+    NgimuFuzzInputMutated,
+    NgimuFuzzInputTruncated,
+    NgimuFuzzInputBadElementSize,
+    NgimuFuzzInputDeepBundle,
+    NgimuFuzzInputManyMessages,
+    NgimuFuzzInputOversized,
+    NgimuFuzzInputRandomBytes,
+    NgimuFuzzNumberOfInputs,
+} NgimuFuzzInput;
+
+/**
+ * @brief Fuzz settings.  The budget is the time permitted for the repeated
+ * duration of one process function call, or 0 if the duration is only
+ * measured.
+ */
+typedef struct {
+    uint64_t(*getTicks)(void);
+    double ticksPerSecond;
+    unsigned int iterations;
+    uint32_t seed;
+    double budgetNanoseconds;
+} NgimuFuzzSettings;
+
+/**
+ * @brief Worst case of the process function calls of one generated input.  The
+ * maximum duration includes interrupts and preemption.  The repeated duration
+ * is the minimum of NGIMU_FUZZ_REPETITIONS repetitions of the longest call of
+ * the input with the most callbacks of one call and then the most bytes, so
+ * excludes interrupts and preemption.
+ */
+typedef struct {
+    size_t numberOfCalls;
+    size_t maxCallbacksPerCall;
+    double maxNanosecondsPerCall;
+    double repeatedNanosecondsPerCall;
+} NgimuFuzzInputResult;
+
+/**
+ * @brief Fuzz result.  The result is within the bound if no call exceeded
+ * NGIMU_FUZZ_MAX_CALLBACKS_PER_CALL callbacks and, if a budget is set, no
+ * repeated duration exceeded the budget.
+ */
+typedef struct {
+    const char* name;
+    size_t numberOfBytes;
+    size_t numberOfMessages;
+    size_t numberOfErrors;
+    NgimuFuzzInputResult inputs[NgimuFuzzNumberOfInputs];
+    size_t maxCallbacksPerCall;
+    double maxNanosecondsPerCall;
+    double repeatedNanosecondsPerCall;
+    bool withinBound;
+} NgimuFuzzResult;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+void NgimuFuzzRun(const NgimuFuzzSettings * const settings, const NgimuFuzzScenario scenario, NgimuFuzzResult * const result);
+size_t NgimuFuzzProcessInput(const char * const source, const size_t sourceSize);
+const char* NgimuFuzzGetInputName(const NgimuFuzzInput input);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
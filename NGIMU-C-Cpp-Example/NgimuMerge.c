@@ -0,0 +1,392 @@
+/**
+ * @file NgimuMerge.c
+ * @author Seb Madgwick
+ * @brief Receives UDP packets from multiple NGIMUs, identifies each device by a
+ * key derived from the packet source (e.g. IP address and port), estimates the
+ * clock offset of each device, and merges the aligned samples of all devices
+ * into time-aligned frames.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuMerge.h"
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Clock offset filter shift.  The clock offset follows a decrease in
+ * transport delay immediately and an increase (e.g. clock drift) with a time
+ * constant of 2^CLOCK_OFFSET_FILTER_SHIFT samples.
+ */
+#define CLOCK_OFFSET_FILTER_SHIFT (10)
+
+/**
+ * @brief Mask applied to an index to obtain the sample position.
+ */
+#define INDEX_MASK (NGIMU_MERGE_BUFFER_SIZE - 1)
+
+typedef char BufferSizeIsPowerOfTwo[((NGIMU_MERGE_BUFFER_SIZE & INDEX_MASK) == 0) ? 1 : -1];
+typedef char MaxDevicesFitsMask[(NGIMU_MERGE_MAX_DEVICES <= 32) ? 1 : -1];
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static NgimuMergeDevice* GetDevice(NgimuMerge * const ngimuMerge, const uint64_t key);
+static void UpdateClockOffset(NgimuMergeDevice * const ngimuMergeDevice, const OscTimeTag * const timestamp);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static void SensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+static void QuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+static void EulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext);
+#endif
+static void SampleCallback(const NgimuSample * const ngimuSample, void * const userContext);
+static void Merge(NgimuMerge * const ngimuMerge);
+static uint32_t GetCount(const NgimuMergeDevice * const ngimuMergeDevice);
+static const NgimuSample* GetHead(const NgimuMergeDevice * const ngimuMergeDevice);
+static uint64_t GetDistance(const uint64_t a, const uint64_t b);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises merge.  This function must be called before the merge is
+ * used.
+ * @param ngimuMerge Address of merge structure.
+ */
+void NgimuMergeInitialise(NgimuMerge * const ngimuMerge) {
+    memset(ngimuMerge, 0, sizeof (*ngimuMerge));
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    ngimuMerge->requiredStreams |= NgimuAlignStreamSensors;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    ngimuMerge->requiredStreams |= NgimuAlignStreamQuaternion;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    ngimuMerge->requiredStreams |= NgimuAlignStreamEuler;
+#endif
+}
+
+/**
+ * @brief Sets frame callback function.  The callback receives a pointer to a
+ * structure owned by the merge that is only valid for the duration of the
+ * callback.
+ * @param ngimuMerge Address of merge structure.
+ * @param newFrameCallback Frame callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuMergeSetFrameCallback(NgimuMerge * const ngimuMerge, void (*newFrameCallback)(const NgimuMergeFrame * const ngimuMergeFrame, void * const userContext), void * const userContext) {
+    ngimuMerge->frameCallback = newFrameCallback;
+    ngimuMerge->userContext = userContext;
+}
+
+/**
+ * @brief Adds a device.  Devices are also added automatically when a packet is
+ * received from an unknown key.  Adding all devices on start up ensures that
+ * the device numbers are fixed and that frames are not provided until every
+ * device has sent a sample.
+ * @param ngimuMerge Address of merge structure.
+ * @param key Device key, e.g. IPv4 address and port.
+ * @return Device number, or -1 if the maximum number of devices has been
+ * reached.
+ */
+int NgimuMergeAddDevice(NgimuMerge * const ngimuMerge, const uint64_t key) {
+    NgimuMergeDevice * const ngimuMergeDevice = GetDevice(ngimuMerge, key);
+    if (ngimuMergeDevice == NULL) {
+        return -1;
+    }
+    return (int) (ngimuMergeDevice - ngimuMerge->devices);
+}
+
+/**
+ * @brief Sets the streams required for the sample of each device to be
+ * complete.  All enabled message types are required by default.  A device
+ * sample is delayed by up to the alignment timeout if a required message type
+ * is not sent by the device.
+ * @param ngimuMerge Address of merge structure.
+ * @param requiredStreams Combination of NgimuAlignStream flags.
+ */
+void NgimuMergeSetRequiredStreams(NgimuMerge * const ngimuMerge, const uint8_t requiredStreams) {
+    ngimuMerge->requiredStreams = requiredStreams;
+    size_t index;
+    for (index = 0; index < ngimuMerge->numberOfDevices; index++) {
+        NgimuAlignSetRequiredStreams(&ngimuMerge->devices[index].ngimuAlign, requiredStreams);
+    }
+}
+
+/**
+ * @brief Process UDP packet received from an NGIMU via Wi-Fi.
+ * @param ngimuMerge Address of merge structure.
+ * @param key Key of device that sent the packet, e.g. IPv4 address and port.
+ * @param receiveTime Time at which packet was received in the time base of the
+ * host.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ */
+void NgimuMergeProcessUdpPacket(NgimuMerge * const ngimuMerge, const uint64_t key, const OscTimeTag * const receiveTime, const char * const source, const size_t sourceSize) {
+    NgimuMergeDevice * const ngimuMergeDevice = GetDevice(ngimuMerge, key);
+    if (ngimuMergeDevice == NULL) {
+        return;
+    }
+    ngimuMergeDevice->receiveTime = receiveTime->value;
+    NgimuReceiverProcessUdpPacket(&ngimuMergeDevice->ngimuReceiver, source, sourceSize);
+}
+
+/**
+ * @brief Gets the clock offset of a device.  The clock offset is added to the
+ * device time tag to obtain the time in the time base of the host.
+ * @param ngimuMerge Address of merge structure.
+ * @param device Device number.
+ * @param clockOffset Address of clock offset to be written in OSC time tag
+ * units (2^-32 seconds).
+ * @return True if the clock offset is valid.
+ */
+bool NgimuMergeGetClockOffset(const NgimuMerge * const ngimuMerge, const int device, int64_t * const clockOffset) {
+    if ((device < 0) || ((size_t) device >= ngimuMerge->numberOfDevices)) {
+        return false;
+    }
+    const NgimuMergeDevice * const ngimuMergeDevice = &ngimuMerge->devices[device];
+    *clockOffset = (int64_t) ngimuMergeDevice->clockOffset;
+    return ngimuMergeDevice->clockOffsetValid;
+}
+
+/**
+ * @brief Returns the device of a key.  A device is added if the key is not
+ * known.
+ * @param ngimuMerge Address of merge structure.
+ * @param key Device key.
+ * @return Address of device, or NULL if the maximum number of devices has been
+ * reached.
+ */
+static NgimuMergeDevice* GetDevice(NgimuMerge * const ngimuMerge, const uint64_t key) {
+
+    // Check previous device first as packets often arrive in runs
+    if ((ngimuMerge->previousDevice < ngimuMerge->numberOfDevices) && (ngimuMerge->devices[ngimuMerge->previousDevice].key == key)) {
+        return &ngimuMerge->devices[ngimuMerge->previousDevice];
+    }
+
+    // Find device
+    size_t index;
+    for (index = 0; index < ngimuMerge->numberOfDevices; index++) {
+        if (ngimuMerge->devices[index].key == key) {
+            ngimuMerge->previousDevice = index;
+            return &ngimuMerge->devices[index];
+        }
+    }
+
+    // Add device
+    if (ngimuMerge->numberOfDevices >= NGIMU_MERGE_MAX_DEVICES) {
+        return NULL;
+    }
+    NgimuMergeDevice * const ngimuMergeDevice = &ngimuMerge->devices[ngimuMerge->numberOfDevices];
+    memset(ngimuMergeDevice, 0, sizeof (*ngimuMergeDevice));
+    ngimuMergeDevice->ngimuMerge = ngimuMerge;
+    ngimuMergeDevice->key = key;
+    NgimuReceiverInitialise(&ngimuMergeDevice->ngimuReceiver);
+    NgimuReceiverSetUserContext(&ngimuMergeDevice->ngimuReceiver, ngimuMergeDevice);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuReceiverSetSensorsCallback(&ngimuMergeDevice->ngimuReceiver, SensorsCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuReceiverSetQuaternionCallback(&ngimuMergeDevice->ngimuReceiver, QuaternionCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuReceiverSetEulerCallback(&ngimuMergeDevice->ngimuReceiver, EulerCallback);
+#endif
+    NgimuAlignInitialise(&ngimuMergeDevice->ngimuAlign);
+    NgimuAlignSetSampleCallback(&ngimuMergeDevice->ngimuAlign, SampleCallback, ngimuMergeDevice);
+    NgimuAlignSetRequiredStreams(&ngimuMergeDevice->ngimuAlign, ngimuMerge->requiredStreams);
+    ngimuMerge->previousDevice = ngimuMerge->numberOfDevices;
+    ngimuMerge->numberOfDevices++;
+    return ngimuMergeDevice;
+}
+
+/**
+ * @brief Updates the clock offset of a device using the time tag of a message
+ * and the receive time of the packet that contained it.  The clock offset
+ * tracks the minimum transport delay so that it is not biased by packets
+ * delayed by the network or operating system.
+ * @param ngimuMergeDevice Address of device structure.
+ * @param timestamp Time tag of message.
+ */
+static void UpdateClockOffset(NgimuMergeDevice * const ngimuMergeDevice, const OscTimeTag * const timestamp) {
+    const uint64_t clockOffset = ngimuMergeDevice->receiveTime - timestamp->value;
+    if (ngimuMergeDevice->clockOffsetValid == false) {
+        ngimuMergeDevice->clockOffset = clockOffset;
+        ngimuMergeDevice->clockOffsetValid = true;
+        return;
+    }
+    const int64_t error = (int64_t) (clockOffset - ngimuMergeDevice->clockOffset);
+    if (error < 0) {
+        ngimuMergeDevice->clockOffset = clockOffset;
+    } else {
+        ngimuMergeDevice->clockOffset += (uint64_t) (error >> CLOCK_OFFSET_FILTER_SHIFT);
+    }
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Device receiver "/sensors" callback.
+ * @param ngimuSensors Address of "/sensors" structure.
+ * @param userContext Address of device structure.
+ */
+static void SensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+    NgimuMergeDevice * const ngimuMergeDevice = (NgimuMergeDevice *) userContext;
+    UpdateClockOffset(ngimuMergeDevice, &ngimuSensors->timestamp);
+    NgimuAlignSensorsCallback(ngimuSensors, &ngimuMergeDevice->ngimuAlign);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Device receiver "/quaternion" callback.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ * @param userContext Address of device structure.
+ */
+static void QuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+    NgimuMergeDevice * const ngimuMergeDevice = (NgimuMergeDevice *) userContext;
+    UpdateClockOffset(ngimuMergeDevice, &ngimuQuaternion->timestamp);
+    NgimuAlignQuaternionCallback(ngimuQuaternion, &ngimuMergeDevice->ngimuAlign);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief Device receiver "/euler" callback.
+ * @param ngimuEuler Address of "/euler" structure.
+ * @param userContext Address of device structure.
+ */
+static void EulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+    NgimuMergeDevice * const ngimuMergeDevice = (NgimuMergeDevice *) userContext;
+    UpdateClockOffset(ngimuMergeDevice, &ngimuEuler->timestamp);
+    NgimuAlignEulerCallback(ngimuEuler, &ngimuMergeDevice->ngimuAlign);
+}
+#endif
+
+/**
+ * @brief Device alignment sample callback.  Buffers the sample with its
+ * timestamp converted to the time base of the host and merges the buffered
+ * samples of all devices.
+ * @param ngimuSample Address of sample structure.
+ * @param userContext Address of device structure.
+ */
+static void SampleCallback(const NgimuSample * const ngimuSample, void * const userContext) {
+    NgimuMergeDevice * const ngimuMergeDevice = (NgimuMergeDevice *) userContext;
+
+    // Discard oldest sample if buffer is full.  This only occurs if no frame
+    // could be provided, i.e. no device has buffered samples.
+    if (GetCount(ngimuMergeDevice) >= NGIMU_MERGE_BUFFER_SIZE) {
+        ngimuMergeDevice->readIndex++;
+    }
+
+    // Add sample to buffer
+    NgimuSample * const bufferedSample = &ngimuMergeDevice->samples[ngimuMergeDevice->writeIndex & INDEX_MASK];
+    *bufferedSample = *ngimuSample;
+    bufferedSample->timestamp.value += ngimuMergeDevice->clockOffset;
+    ngimuMergeDevice->writeIndex++;
+
+    // Merge
+    Merge(ngimuMergeDevice->ngimuMerge);
+}
+
+/**
+ * @brief Provides frames while every device has a buffered sample, or while
+ * the buffer of any device is full.  The frame timestamp is the latest of the
+ * oldest buffered samples of each device.  The sample of each device closest
+ * to the frame timestamp is used and older samples are discarded.
+ * @param ngimuMerge Address of merge structure.
+ */
+static void Merge(NgimuMerge * const ngimuMerge) {
+    while (true) {
+
+        // Check if frame can be provided
+        bool empty = false;
+        bool full = false;
+        bool first = true;
+        uint64_t timestamp = 0;
+        size_t index;
+        for (index = 0; index < ngimuMerge->numberOfDevices; index++) {
+            const NgimuMergeDevice * const ngimuMergeDevice = &ngimuMerge->devices[index];
+            const uint32_t count = GetCount(ngimuMergeDevice);
+            if (count == 0) {
+                empty = true;
+                continue;
+            }
+            if (count >= NGIMU_MERGE_BUFFER_SIZE) {
+                full = true;
+            }
+            const uint64_t headTimestamp = GetHead(ngimuMergeDevice)->timestamp.value;
+            if (first || ((int64_t) (headTimestamp - timestamp) > 0)) {
+                timestamp = headTimestamp;
+                first = false;
+            }
+        }
+        if (first || (empty && !full)) {
+            return;
+        }
+
+        // Take sample of each device closest to frame timestamp
+        NgimuMergeFrame * const ngimuMergeFrame = &ngimuMerge->ngimuMergeFrame;
+        ngimuMergeFrame->timestamp.value = timestamp;
+        ngimuMergeFrame->devices = 0;
+        for (index = 0; index < ngimuMerge->numberOfDevices; index++) {
+            NgimuMergeDevice * const ngimuMergeDevice = &ngimuMerge->devices[index];
+            if (GetCount(ngimuMergeDevice) == 0) {
+                continue;
+            }
+            while (GetCount(ngimuMergeDevice) > 1) {
+                const uint64_t headDistance = GetDistance(GetHead(ngimuMergeDevice)->timestamp.value, timestamp);
+                const uint64_t nextDistance = GetDistance(ngimuMergeDevice->samples[(ngimuMergeDevice->readIndex + 1) & INDEX_MASK].timestamp.value, timestamp);
+                if (nextDistance > headDistance) {
+                    break;
+                }
+                ngimuMergeDevice->readIndex++;
+            }
+            ngimuMergeFrame->samples[index] = *GetHead(ngimuMergeDevice);
+            ngimuMergeFrame->devices |= (uint32_t) 1 << index;
+            ngimuMergeDevice->readIndex++;
+        }
+
+        // Callback
+        if (ngimuMerge->frameCallback != NULL) {
+            ngimuMerge->frameCallback(ngimuMergeFrame, ngimuMerge->userContext);
+        }
+    }
+}
+
+/**
+ * @brief Returns the number of samples buffered for a device.
+ * @param ngimuMergeDevice Address of device structure.
+ * @return Number of samples buffered.
+ */
+static uint32_t GetCount(const NgimuMergeDevice * const ngimuMergeDevice) {
+    return ngimuMergeDevice->writeIndex - ngimuMergeDevice->readIndex;
+}
+
+/**
+ * @brief Returns the oldest sample buffered for a device.
+ * @param ngimuMergeDevice Address of device structure.
+ * @return Address of oldest sample.
+ */
+static const NgimuSample* GetHead(const NgimuMergeDevice * const ngimuMergeDevice) {
+    return &ngimuMergeDevice->samples[ngimuMergeDevice->readIndex & INDEX_MASK];
+}
+
+/**
+ * @brief Returns the absolute difference between two time tags.
+ * @param a First time tag.
+ * @param b Second time tag.
+ * @return Absolute difference.
+ */
+static uint64_t GetDistance(const uint64_t a, const uint64_t b) {
+    const int64_t difference = (int64_t) (a - b);
+    return (difference < 0) ? (uint64_t) -difference : (uint64_t) difference;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,109 @@
+/**
+ * @file NgimuMerge.h
+ * @author Seb Madgwick
+ * @brief Receives UDP packets from multiple NGIMUs, identifies each device by a
+ * key derived from the packet source (e.g. IP address and port), estimates the
+ * clock offset of each device, and merges the aligned samples of all devices
+ * into time-aligned frames.
+ */
+
+#ifndef NGIMU_MERGE_H
+#define NGIMU_MERGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuAlign.h"
+#include "NgimuReceive.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of devices.  Must be no greater than 32.
+ */
+#ifndef NGIMU_MERGE_MAX_DEVICES
+#define NGIMU_MERGE_MAX_DEVICES (16)
+#endif
+
+/**
+ * @brief Number of samples buffered for each device.  Must be a power of two.
+ * A frame without the samples of silent devices is provided when the buffer of
+ * any device is full.
+ */
+#ifndef NGIMU_MERGE_BUFFER_SIZE
+#define NGIMU_MERGE_BUFFER_SIZE (8)
+#endif
+
+/**
+ * @brief Merged frame.  Timestamps are in the time base of the host, i.e. that
+ * of the receive times passed to NgimuMergeProcessUdpPacket.  Devices
+ * indicates which samples are valid, bit n corresponding to device n.
+ */
+typedef struct {
+    OscTimeTag timestamp;
+    uint32_t devices;
+    NgimuSample samples[NGIMU_MERGE_MAX_DEVICES];
+} NgimuMergeFrame;
+
+/**
+ * @brief Forward declaration of merge structure.
+ */
+typedef struct NgimuMerge NgimuMerge;
+
+/**
+ * @brief Device structure.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    NgimuMerge* ngimuMerge;
+    uint64_t key;
+    NgimuReceiver ngimuReceiver;
+    NgimuAlign ngimuAlign;
+    uint64_t receiveTime;
+    uint64_t clockOffset;
+    bool clockOffsetValid;
+    NgimuSample samples[NGIMU_MERGE_BUFFER_SIZE];
+    uint32_t writeIndex;
+    uint32_t readIndex;
+} NgimuMergeDevice;
+
+/**
+ * @brief Merge structure.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+struct NgimuMerge {
+    NgimuMergeDevice devices[NGIMU_MERGE_MAX_DEVICES];
+    size_t numberOfDevices;
+    size_t previousDevice;
+    uint8_t requiredStreams;
+    NgimuMergeFrame ngimuMergeFrame;
+    void (*frameCallback)(const NgimuMergeFrame * const ngimuMergeFrame, void * const userContext);
+    void* userContext;
+};
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+void NgimuMergeInitialise(NgimuMerge * const ngimuMerge);
+void NgimuMergeSetFrameCallback(NgimuMerge * const ngimuMerge, void (*newFrameCallback)(const NgimuMergeFrame * const ngimuMergeFrame, void * const userContext), void * const userContext);
+int NgimuMergeAddDevice(NgimuMerge * const ngimuMerge, const uint64_t key);
+void NgimuMergeSetRequiredStreams(NgimuMerge * const ngimuMerge, const uint8_t requiredStreams);
+void NgimuMergeProcessUdpPacket(NgimuMerge * const ngimuMerge, const uint64_t key, const OscTimeTag * const receiveTime, const char * const source, const size_t sourceSize);
+bool NgimuMergeGetClockOffset(const NgimuMerge * const ngimuMerge, const int device, int64_t * const clockOffset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,278 @@
+/**
+ * @file NgimuMonitor.c
+ * @author Seb Madgwick
+ * @brief Online monitoring of the OSC time tags of each message type.  The
+ * period of each message type is estimated from the time tags so that gaps,
+ * duplicate time tags, out of order time tags and time tag resets are reported
+ * as they are received.  The jitter of the time tag interval is estimated
+ * using a running mean of the absolute deviation from the period.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuMonitor.h"
+#include <string.h> // memcmp, memcpy, memset, strlen
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of OSC time tag units per second.
+ */
+#define TIME_TAG_UNITS_PER_SECOND (4294967296.0f)
+
+/**
+ * @brief Reciprocal of the gain of the running period and jitter estimates,
+ * as used for the interarrival jitter of RFC 3550.
+ */
+#define ESTIMATE_DIVISOR (16)
+
+/**
+ * @brief Number of consecutive gaps of the same length after which the period
+ * is assumed to have changed, e.g. after the NGIMU message rate is reduced.
+ */
+#define RATE_CHANGE_GAPS (3)
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static NgimuMonitorStream* GetStream(NgimuMonitor * const ngimuMonitor, const char * const oscAddressPattern, const size_t oscAddressPatternLength);
+static void Update(NgimuMonitor * const ngimuMonitor, NgimuMonitorStream * const stream, const uint64_t timeTag);
+static void ReportAnomaly(NgimuMonitor * const ngimuMonitor, const NgimuMonitorStream * const stream, const NgimuMonitorAnomalyType type, const uint64_t timeTag, const uint64_t previousTimeTag, const uint32_t numberOfMissing);
+static uint64_t UpdateEstimate(const uint64_t estimate, const uint64_t value);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises monitor.  This function must be called before the monitor
+ * is used.
+ * @param ngimuMonitor Address of monitor structure.
+ */
+void NgimuMonitorInitialise(NgimuMonitor * const ngimuMonitor) {
+    memset(ngimuMonitor, 0, sizeof (*ngimuMonitor));
+}
+
+/**
+ * @brief Sets anomaly callback function.  The callback receives a pointer to a
+ * structure that is only valid for the duration of the callback.
+ * @param ngimuMonitor Address of monitor structure.
+ * @param newAnomalyCallback Anomaly callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuMonitorSetAnomalyCallback(NgimuMonitor * const ngimuMonitor, void (*newAnomalyCallback)(const NgimuMonitorAnomaly * const ngimuMonitorAnomaly, void * const userContext), void * const userContext) {
+    ngimuMonitor->anomalyCallback = newAnomalyCallback;
+    ngimuMonitor->userContext = userContext;
+}
+
+/**
+ * @brief Assigns the receiver time tag callback so that the time tag of each
+ * message is passed to the monitor.  The other receiver callbacks and the user
+ * context are not modified.
+ * @param ngimuMonitor Address of monitor structure.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+void NgimuMonitorSetReceiverCallbacks(NgimuMonitor * const ngimuMonitor, NgimuReceiver * const ngimuReceiver) {
+    NgimuReceiverSetTimeTagCallback(ngimuReceiver, NgimuMonitorTimeTagCallback, ngimuMonitor);
+}
+
+/**
+ * @brief Time tag callback that adds the time tag to the monitor.  May be
+ * assigned to any time tag callback with the monitor as the context.  Messages
+ * that are not within a bundle are ignored because they do not have a time
+ * tag.
+ * @param oscAddressPattern OSC address pattern.
+ * @param oscAddressPatternLength OSC address pattern length.
+ * @param oscTimeTag OSC time tag.
+ * @param timeTagContext Address of monitor structure.
+ */
+void NgimuMonitorTimeTagCallback(const char * const oscAddressPattern, const size_t oscAddressPatternLength, const OscTimeTag * const oscTimeTag, void * const timeTagContext) {
+    NgimuMonitor * const ngimuMonitor = (NgimuMonitor *) timeTagContext;
+    if (oscTimeTag->value <= 1) {
+        return; // "immediately"
+    }
+    NgimuMonitorStream * const stream = GetStream(ngimuMonitor, oscAddressPattern, oscAddressPatternLength);
+    if (stream != NULL) {
+        Update(ngimuMonitor, stream, oscTimeTag->value);
+    }
+}
+
+/**
+ * @brief Gets the statistics of a message type.
+ * @param ngimuMonitor Address of monitor structure.
+ * @param oscAddressPattern OSC address of message type, e.g. "/sensors".
+ * @param ngimuMonitorStatistics Address of statistics structure.
+ * @return True if the message type has been received.
+ */
+bool NgimuMonitorGetStatistics(const NgimuMonitor * const ngimuMonitor, const char * const oscAddressPattern, NgimuMonitorStatistics * const ngimuMonitorStatistics) {
+    const size_t oscAddressPatternLength = strlen(oscAddressPattern);
+    size_t index;
+    for (index = 0; index < ngimuMonitor->numberOfStreams; index++) {
+        const NgimuMonitorStream * const stream = &ngimuMonitor->streams[index];
+        if ((stream->oscAddressPatternLength != oscAddressPatternLength) || (memcmp(stream->oscAddressPattern, oscAddressPattern, oscAddressPatternLength) != 0)) {
+            continue;
+        }
+        *ngimuMonitorStatistics = stream->statistics;
+        ngimuMonitorStatistics->period = (float) stream->period / TIME_TAG_UNITS_PER_SECOND;
+        ngimuMonitorStatistics->jitter = (float) stream->jitter / TIME_TAG_UNITS_PER_SECOND;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the stream of a message type, adding a stream if the message
+ * type is new.
+ * @param ngimuMonitor Address of monitor structure.
+ * @param oscAddressPattern OSC address pattern.
+ * @param oscAddressPatternLength OSC address pattern length.
+ * @return Address of stream, or NULL if the message type cannot be monitored.
+ */
+static NgimuMonitorStream* GetStream(NgimuMonitor * const ngimuMonitor, const char * const oscAddressPattern, const size_t oscAddressPatternLength) {
+
+    // Messages of the same type are often consecutive
+    NgimuMonitorStream * stream = &ngimuMonitor->streams[ngimuMonitor->latestStreamIndex];
+    if ((ngimuMonitor->numberOfStreams > 0) && (stream->oscAddressPatternLength == oscAddressPatternLength) && (memcmp(stream->oscAddressPattern, oscAddressPattern, oscAddressPatternLength) == 0)) {
+        return stream;
+    }
+
+    // Find existing stream
+    size_t index;
+    for (index = 0; index < ngimuMonitor->numberOfStreams; index++) {
+        stream = &ngimuMonitor->streams[index];
+        if ((stream->oscAddressPatternLength == oscAddressPatternLength) && (memcmp(stream->oscAddressPattern, oscAddressPattern, oscAddressPatternLength) == 0)) {
+            ngimuMonitor->latestStreamIndex = index;
+            return stream;
+        }
+    }
+
+    // Add stream
+    if ((ngimuMonitor->numberOfStreams >= NGIMU_MONITOR_MAX_STREAMS) || (oscAddressPatternLength == 0) || (oscAddressPatternLength > NGIMU_MONITOR_MAX_ADDRESS_LENGTH)) {
+        return NULL;
+    }
+    stream = &ngimuMonitor->streams[ngimuMonitor->numberOfStreams];
+    memcpy(stream->oscAddressPattern, oscAddressPattern, oscAddressPatternLength);
+    stream->oscAddressPattern[oscAddressPatternLength] = '\0';
+    stream->oscAddressPatternLength = oscAddressPatternLength;
+    ngimuMonitor->latestStreamIndex = ngimuMonitor->numberOfStreams++;
+    return stream;
+}
+
+/**
+ * @brief Updates the stream with the time tag of a message and reports any
+ * anomaly.  The period and jitter estimates are only updated by intervals
+ * without an anomaly.
+ * @param ngimuMonitor Address of monitor structure.
+ * @param stream Address of stream.
+ * @param timeTag Time tag of message.
+ */
+static void Update(NgimuMonitor * const ngimuMonitor, NgimuMonitorStream * const stream, const uint64_t timeTag) {
+    stream->statistics.numberOfMessages++;
+
+    // First time tag
+    if (stream->latestTimeTag == 0) {
+        stream->latestTimeTag = timeTag;
+        return;
+    }
+
+    // Duplicate time tag
+    if (timeTag == stream->latestTimeTag) {
+        stream->statistics.numberOfDuplicates++;
+        ReportAnomaly(ngimuMonitor, stream, NgimuMonitorAnomalyTypeDuplicate, timeTag, stream->latestTimeTag, 0);
+        return;
+    }
+
+    // Earlier time tag
+    if (timeTag < stream->latestTimeTag) {
+        if ((stream->latestTimeTag - timeTag) <= (stream->period * NGIMU_MONITOR_REORDER_WINDOW)) {
+            stream->statistics.numberOfOutOfOrder++;
+            ReportAnomaly(ngimuMonitor, stream, NgimuMonitorAnomalyTypeOutOfOrder, timeTag, stream->latestTimeTag, 0);
+            return;
+        }
+        stream->statistics.numberOfResets++;
+        ReportAnomaly(ngimuMonitor, stream, NgimuMonitorAnomalyTypeReset, timeTag, stream->latestTimeTag, 0);
+        stream->latestTimeTag = timeTag;
+        return;
+    }
+    const uint64_t interval = timeTag - stream->latestTimeTag;
+    const uint64_t previousTimeTag = stream->latestTimeTag;
+    stream->latestTimeTag = timeTag;
+
+    // First interval
+    if (stream->period == 0) {
+        stream->period = interval;
+        return;
+    }
+
+    // Period reduced, e.g. after the NGIMU message rate is increased
+    if (interval < (stream->period / 2)) {
+        stream->period = interval;
+        stream->numberOfConsecutiveGaps = 0;
+        return;
+    }
+
+    // Gap
+    if (interval > (stream->period + (stream->period / 2))) {
+        const uint32_t gapLength = (uint32_t) ((interval + (stream->period / 2)) / stream->period) - 1;
+        if ((stream->numberOfConsecutiveGaps > 0) && (gapLength == stream->gapLength)) {
+            stream->numberOfConsecutiveGaps++;
+        } else {
+            stream->numberOfConsecutiveGaps = 1;
+            stream->gapLength = gapLength;
+        }
+        if (stream->numberOfConsecutiveGaps >= RATE_CHANGE_GAPS) {
+            stream->period = interval;
+            stream->numberOfConsecutiveGaps = 0;
+            return;
+        }
+        stream->statistics.numberOfGaps++;
+        stream->statistics.numberOfMissing += gapLength;
+        ReportAnomaly(ngimuMonitor, stream, NgimuMonitorAnomalyTypeGap, timeTag, previousTimeTag, gapLength);
+        return;
+    }
+
+    // Update period and jitter estimates
+    stream->numberOfConsecutiveGaps = 0;
+    const uint64_t deviation = (interval > stream->period) ? (interval - stream->period) : (stream->period - interval);
+    stream->period = UpdateEstimate(stream->period, interval);
+    stream->jitter = UpdateEstimate(stream->jitter, deviation);
+}
+
+/**
+ * @brief Reports an anomaly through the anomaly callback.
+ * @param ngimuMonitor Address of monitor structure.
+ * @param stream Address of stream.
+ * @param type Anomaly type.
+ * @param timeTag Time tag of message.
+ * @param previousTimeTag Latest time tag received before the message.
+ * @param numberOfMissing Number of missing messages.
+ */
+static void ReportAnomaly(NgimuMonitor * const ngimuMonitor, const NgimuMonitorStream * const stream, const NgimuMonitorAnomalyType type, const uint64_t timeTag, const uint64_t previousTimeTag, const uint32_t numberOfMissing) {
+    if (ngimuMonitor->anomalyCallback == NULL) {
+        return;
+    }
+    NgimuMonitorAnomaly ngimuMonitorAnomaly;
+    ngimuMonitorAnomaly.type = type;
+    ngimuMonitorAnomaly.oscAddressPattern = stream->oscAddressPattern;
+    ngimuMonitorAnomaly.timeTag.value = timeTag;
+    ngimuMonitorAnomaly.previousTimeTag.value = previousTimeTag;
+    ngimuMonitorAnomaly.numberOfMissing = numberOfMissing;
+    ngimuMonitor->anomalyCallback(&ngimuMonitorAnomaly, ngimuMonitor->userContext);
+}
+
+/**
+ * @brief Returns the running estimate updated with a new value.
+ * @param estimate Estimate.
+ * @param value Value.
+ * @return Updated estimate.
+ */
+static uint64_t UpdateEstimate(const uint64_t estimate, const uint64_t value) {
+    if (value >= estimate) {
+        return estimate + ((value - estimate) / ESTIMATE_DIVISOR);
+    }
+    return estimate - ((estimate - value) / ESTIMATE_DIVISOR);
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,135 @@
+/**
+ * @file NgimuMonitor.h
+ * @author Seb Madgwick
+ * @brief Online monitoring of the OSC time tags of each message type.  The
+ * period of each message type is estimated from the time tags so that gaps,
+ * duplicate time tags, out of order time tags and time tag resets are reported
+ * as they are received.  The jitter of the time tag interval is estimated
+ * using a running mean of the absolute deviation from the period.
+ */
+
+#ifndef NGIMU_MONITOR_H
+#define NGIMU_MONITOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuReceive.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of message types monitored.  Messages of further
+ * message types are ignored.
+ */
+#ifndef NGIMU_MONITOR_MAX_STREAMS
+#define NGIMU_MONITOR_MAX_STREAMS (8)
+#endif
+
+/**
+ * @brief Maximum OSC address length of a monitored message type.
+ */
+#ifndef NGIMU_MONITOR_MAX_ADDRESS_LENGTH
+#define NGIMU_MONITOR_MAX_ADDRESS_LENGTH (23)
+#endif
+
+/**
+ * @brief Number of periods that a time tag may be earlier than the latest time
+ * tag to be reported as out of order.  An earlier time tag is reported as a
+ * time tag reset, e.g. after the NGIMU is reset.
+ */
+#ifndef NGIMU_MONITOR_REORDER_WINDOW
+#define NGIMU_MONITOR_REORDER_WINDOW (16)
+#endif
+
+/**
+ * @brief Anomaly types.
+ */
+typedef enum {
+    NgimuMonitorAnomalyTypeGap,
+    NgimuMonitorAnomalyTypeDuplicate,
+    NgimuMonitorAnomalyTypeOutOfOrder,
+    NgimuMonitorAnomalyTypeReset,
+} NgimuMonitorAnomalyType;
+
+/**
+ * @brief Anomaly.  The previous time tag is the latest time tag received
+ * before the anomaly.  The number of missing messages is only valid for
+ * NgimuMonitorAnomalyTypeGap.  The OSC address pattern is only valid for the
+ * duration of the callback.
+ */
+typedef struct {
+    NgimuMonitorAnomalyType type;
+    const char* oscAddressPattern;
+    OscTimeTag timeTag;
+    OscTimeTag previousTimeTag;
+    uint32_t numberOfMissing;
+} NgimuMonitorAnomaly;
+
+/**
+ * @brief Statistics of a message type.  The period and jitter are 0 until
+ * enough messages have been received.
+ */
+typedef struct {
+    uint32_t numberOfMessages;
+    uint32_t numberOfMissing;
+    uint32_t numberOfGaps;
+    uint32_t numberOfDuplicates;
+    uint32_t numberOfOutOfOrder;
+    uint32_t numberOfResets;
+    float period;
+    float jitter;
+} NgimuMonitorStatistics;
+
+/**
+ * @brief Message type state.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    char oscAddressPattern[NGIMU_MONITOR_MAX_ADDRESS_LENGTH + 1];
+    size_t oscAddressPatternLength;
+    uint64_t latestTimeTag;
+    uint64_t period;
+    uint64_t jitter;
+    uint32_t gapLength;
+    uint32_t numberOfConsecutiveGaps;
+    NgimuMonitorStatistics statistics;
+} NgimuMonitorStream;
+
+/**
+ * @brief Monitor structure.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    NgimuMonitorStream streams[NGIMU_MONITOR_MAX_STREAMS];
+    size_t numberOfStreams;
+    size_t latestStreamIndex;
+    void (*anomalyCallback)(const NgimuMonitorAnomaly * const ngimuMonitorAnomaly, void * const userContext);
+    void* userContext;
+} NgimuMonitor;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+void NgimuMonitorInitialise(NgimuMonitor * const ngimuMonitor);
+void NgimuMonitorSetAnomalyCallback(NgimuMonitor * const ngimuMonitor, void (*newAnomalyCallback)(const NgimuMonitorAnomaly * const ngimuMonitorAnomaly, void * const userContext), void * const userContext);
+void NgimuMonitorSetReceiverCallbacks(NgimuMonitor * const ngimuMonitor, NgimuReceiver * const ngimuReceiver);
+void NgimuMonitorTimeTagCallback(const char * const oscAddressPattern, const size_t oscAddressPatternLength, const OscTimeTag * const oscTimeTag, void * const timeTagContext);
+bool NgimuMonitorGetStatistics(const NgimuMonitor * const ngimuMonitor, const char * const oscAddressPattern, NgimuMonitorStatistics * const ngimuMonitorStatistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
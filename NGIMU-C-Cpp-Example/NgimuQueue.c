@@ -0,0 +1,192 @@
+/**
+ * @file NgimuQueue.c
+ * @author Seb Madgwick
+ * @brief Lock-free single-producer single-consumer queue of decoded NGIMU
+ * messages.  Allows messages to be decoded in one context (e.g. an interrupt or
+ * socket thread) and consumed in another (e.g. the main loop) without a slow
+ * consumer stalling the decoder.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuQueue.h"
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Loads and stores of the queue indexes.  The acquire/release ordering
+ * ensures that a record is completely written before it is visible to the
+ * consumer and completely read before its slot is visible to the producer.
+ * The fallback is only valid on single core platforms.
+ */
+#if defined(__GNUC__)
+#define LOAD_ACQUIRE(index) __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+#else
+#define LOAD_ACQUIRE(index) (index)
+#define STORE_RELEASE(index, value) ((index) = (value))
+#endif
+
+/**
+ * @brief Mask applied to an index to obtain the record position.
+ */
+#define INDEX_MASK (NGIMU_QUEUE_CAPACITY - 1)
+
+typedef char CapacityIsPowerOfTwo[((NGIMU_QUEUE_CAPACITY & INDEX_MASK) == 0) ? 1 : -1];
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static NgimuQueueRecord* Reserve(NgimuQueue * const ngimuQueue);
+static void Commit(NgimuQueue * const ngimuQueue);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises queue.  This function must be called before the queue is
+ * used.
+ * @param ngimuQueue Address of queue structure.
+ */
+void NgimuQueueInitialise(NgimuQueue * const ngimuQueue) {
+    memset(ngimuQueue, 0, sizeof (*ngimuQueue));
+}
+
+/**
+ * @brief Assigns the receiver callbacks so that all decoded messages are
+ * pushed to the queue.  The receiver user context is set to the queue.
+ * @param ngimuQueue Address of queue structure.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+void NgimuQueueSetReceiverCallbacks(NgimuQueue * const ngimuQueue, NgimuReceiver * const ngimuReceiver) {
+    NgimuReceiverSetUserContext(ngimuReceiver, ngimuQueue);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuReceiverSetSensorsCallback(ngimuReceiver, NgimuQueueSensorsCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuReceiverSetQuaternionCallback(ngimuReceiver, NgimuQueueQuaternionCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuReceiverSetEulerCallback(ngimuReceiver, NgimuQueueEulerCallback);
+#endif
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief "/sensors" callback that pushes the message to the queue.  May be
+ * assigned to any pointer callback with the queue as the user context.
+ * @param ngimuSensors Address of "/sensors" structure.
+ * @param userContext Address of queue structure.
+ */
+void NgimuQueueSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+    NgimuQueue * const ngimuQueue = (NgimuQueue *) userContext;
+    NgimuQueueRecord * const ngimuQueueRecord = Reserve(ngimuQueue);
+    if (ngimuQueueRecord == NULL) {
+        return;
+    }
+    ngimuQueueRecord->type = NgimuQueueRecordTypeSensors;
+    ngimuQueueRecord->data.sensors = *ngimuSensors;
+    Commit(ngimuQueue);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief "/quaternion" callback that pushes the message to the queue.  May be
+ * assigned to any pointer callback with the queue as the user context.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ * @param userContext Address of queue structure.
+ */
+void NgimuQueueQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+    NgimuQueue * const ngimuQueue = (NgimuQueue *) userContext;
+    NgimuQueueRecord * const ngimuQueueRecord = Reserve(ngimuQueue);
+    if (ngimuQueueRecord == NULL) {
+        return;
+    }
+    ngimuQueueRecord->type = NgimuQueueRecordTypeQuaternion;
+    ngimuQueueRecord->data.quaternion = *ngimuQuaternion;
+    Commit(ngimuQueue);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief "/euler" callback that pushes the message to the queue.  May be
+ * assigned to any pointer callback with the queue as the user context.
+ * @param ngimuEuler Address of "/euler" structure.
+ * @param userContext Address of queue structure.
+ */
+void NgimuQueueEulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+    NgimuQueue * const ngimuQueue = (NgimuQueue *) userContext;
+    NgimuQueueRecord * const ngimuQueueRecord = Reserve(ngimuQueue);
+    if (ngimuQueueRecord == NULL) {
+        return;
+    }
+    ngimuQueueRecord->type = NgimuQueueRecordTypeEuler;
+    ngimuQueueRecord->data.euler = *ngimuEuler;
+    Commit(ngimuQueue);
+}
+#endif
+
+/**
+ * @brief Pops the oldest record from the queue.  This function must only be
+ * called from the consumer context.
+ * @param ngimuQueue Address of queue structure.
+ * @param ngimuQueueRecord Address of record structure to be written.
+ * @return True if a record was popped, false if the queue was empty.
+ */
+bool NgimuQueuePop(NgimuQueue * const ngimuQueue, NgimuQueueRecord * const ngimuQueueRecord) {
+    const NgimuQueueIndex readIndex = ngimuQueue->readIndex;
+    if (readIndex == LOAD_ACQUIRE(ngimuQueue->writeIndex)) {
+        return false;
+    }
+    *ngimuQueueRecord = ngimuQueue->records[readIndex & INDEX_MASK];
+    STORE_RELEASE(ngimuQueue->readIndex, (NgimuQueueIndex) (readIndex + 1));
+    return true;
+}
+
+/**
+ * @brief Returns the number of records in the queue.
+ * @param ngimuQueue Address of queue structure.
+ * @return Number of records in the queue.
+ */
+size_t NgimuQueueGetCount(NgimuQueue * const ngimuQueue) {
+    return (NgimuQueueIndex) (LOAD_ACQUIRE(ngimuQueue->writeIndex) - LOAD_ACQUIRE(ngimuQueue->readIndex));
+}
+
+/**
+ * @brief Returns the number of records discarded because the queue was full.
+ * @param ngimuQueue Address of queue structure.
+ * @return Number of records discarded because the queue was full.
+ */
+uint32_t NgimuQueueGetOverflowCount(NgimuQueue * const ngimuQueue) {
+    return ngimuQueue->overflowCount;
+}
+
+/**
+ * @brief Returns the next free record, or NULL if the queue is full.
+ * @param ngimuQueue Address of queue structure.
+ * @return Address of the next free record, or NULL if the queue is full.
+ */
+static NgimuQueueRecord* Reserve(NgimuQueue * const ngimuQueue) {
+    const NgimuQueueIndex writeIndex = ngimuQueue->writeIndex;
+    if ((NgimuQueueIndex) (writeIndex - LOAD_ACQUIRE(ngimuQueue->readIndex)) >= NGIMU_QUEUE_CAPACITY) {
+        ngimuQueue->overflowCount++;
+        return NULL;
+    }
+    return &ngimuQueue->records[writeIndex & INDEX_MASK];
+}
+
+/**
+ * @brief Makes the record returned by Reserve() visible to the consumer.
+ * @param ngimuQueue Address of queue structure.
+ */
+static void Commit(NgimuQueue * const ngimuQueue) {
+    STORE_RELEASE(ngimuQueue->writeIndex, (NgimuQueueIndex) (ngimuQueue->writeIndex + 1));
+}
+
+//------------------------------------------------------------------------------
+// End of file
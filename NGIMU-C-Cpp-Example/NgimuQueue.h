@@ -0,0 +1,108 @@
+/**
+ * @file NgimuQueue.h
+ * @author Seb Madgwick
+ * @brief Lock-free single-producer single-consumer queue of decoded NGIMU
+ * messages.  Allows messages to be decoded in one context (e.g. an interrupt or
+ * socket thread) and consumed in another (e.g. the main loop) without a slow
+ * consumer stalling the decoder.
+ */
+
+#ifndef NGIMU_QUEUE_H
+#define NGIMU_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuReceive.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Queue capacity.  Must be a power of two and no greater than 128 on
+ * 8-bit platforms.
+ */
+#ifndef NGIMU_QUEUE_CAPACITY
+#define NGIMU_QUEUE_CAPACITY (32)
+#endif
+
+/**
+ * @brief Queue index type.  Must be accessible atomically on the platform.
+ */
+#if defined(__AVR__)
+typedef uint8_t NgimuQueueIndex;
+#else
+typedef uint32_t NgimuQueueIndex;
+#endif
+
+/**
+ * @brief Record type.
+ */
+typedef enum {
+    NgimuQueueRecordTypeSensors,
+    NgimuQueueRecordTypeQuaternion,
+    NgimuQueueRecordTypeEuler,
+} NgimuQueueRecordType;
+
+/**
+ * @brief Record.  The member of data that is valid is indicated by type.
+ */
+typedef struct {
+    NgimuQueueRecordType type;
+
+    union {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+        NgimuSensors sensors;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+        NgimuQuaternion quaternion;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+        NgimuEuler euler;
+#endif
+    } data;
+} NgimuQueueRecord;
+
+/**
+ * @brief Queue structure.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    NgimuQueueRecord records[NGIMU_QUEUE_CAPACITY];
+    volatile NgimuQueueIndex writeIndex;
+    volatile NgimuQueueIndex readIndex;
+    volatile uint32_t overflowCount;
+} NgimuQueue;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+void NgimuQueueInitialise(NgimuQueue * const ngimuQueue);
+void NgimuQueueSetReceiverCallbacks(NgimuQueue * const ngimuQueue, NgimuReceiver * const ngimuReceiver);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+void NgimuQueueSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+void NgimuQueueQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+void NgimuQueueEulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext);
+#endif
+bool NgimuQueuePop(NgimuQueue * const ngimuQueue, NgimuQueueRecord * const ngimuQueueRecord);
+size_t NgimuQueueGetCount(NgimuQueue * const ngimuQueue);
+uint32_t NgimuQueueGetOverflowCount(NgimuQueue * const ngimuQueue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
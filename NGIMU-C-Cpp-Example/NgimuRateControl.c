@@ -0,0 +1,215 @@
+/**
+ * @file NgimuRateControl.c
+ * @author Seb Madgwick
+ * @brief Adaptive control of NGIMU message rates based on the backlog of the
+ * application, e.g. the fill level of an NgimuQueue.  The rates of low
+ * priority message types are reduced first when the backlog is high and are
+ * restored last once the backlog has cleared.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuRateControl.h"
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Size of the buffer that a rate write is encoded to.
+ */
+#define WRITE_BUFFER_SIZE (64)
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static float GetStreamRate(const NgimuRateControlStream * const stream);
+static void SendRate(NgimuRateControl * const ngimuRateControl, const NgimuRateControlStream * const stream, const uint32_t time);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises rate control.  This function must be called before the
+ * rate control is used.  The default thresholds reduce rates when the backlog
+ * exceeds 0.75 and restore rates when the backlog is below 0.25.
+ * @param ngimuRateControl Address of rate control structure.
+ * @param transport Transport used to send rate writes to the NGIMU.
+ * @param holdTime Minimum time between rate changes so that each change may
+ * take effect before the backlog is evaluated again, in the units of the
+ * times provided to NgimuRateControlUpdate.
+ * @param write Write function that sends data to the NGIMU.
+ * @param userContext User context passed to the write function.
+ */
+void NgimuRateControlInitialise(NgimuRateControl * const ngimuRateControl, const NgimuReceiveTransport transport, const uint32_t holdTime, void (*write)(const char * const data, const size_t size, void * const userContext), void * const userContext) {
+    memset(ngimuRateControl, 0, sizeof (*ngimuRateControl));
+    ngimuRateControl->transport = transport;
+    ngimuRateControl->holdTime = holdTime;
+    ngimuRateControl->write = write;
+    ngimuRateControl->userContext = userContext;
+    ngimuRateControl->reduceThreshold = 0.75f;
+    ngimuRateControl->restoreThreshold = 0.25f;
+}
+
+/**
+ * @brief Adds a controlled message type.  Message types must be added in
+ * order of increasing priority, e.g. "/euler" before "/sensors".  The NGIMU
+ * must already be configured to send the message type at the nominal rate.
+ * The address is not copied and must remain valid for the lifetime of the rate
+ * control.
+ * @param ngimuRateControl Address of rate control structure.
+ * @param address Rate setting address, e.g. NGIMU_SEND_RATE_EULER.
+ * @param nominalRate Nominal rate in Hz.
+ * @param minimumRate Minimum rate in Hz.  A rate of 0 disables the message
+ * type.
+ * @return True if successful, false if the maximum number of message types
+ * have been added.
+ */
+bool NgimuRateControlAddStream(NgimuRateControl * const ngimuRateControl, const char * const address, const float nominalRate, const float minimumRate) {
+    if (ngimuRateControl->numberOfStreams >= NGIMU_RATE_CONTROL_MAX_STREAMS) {
+        return false;
+    }
+    NgimuRateControlStream * const stream = &ngimuRateControl->streams[ngimuRateControl->numberOfStreams++];
+    stream->address = address;
+    stream->nominalRate = nominalRate;
+    stream->minimumRate = minimumRate;
+    stream->level = 0;
+
+    // Number of halvings until the minimum rate is reached
+    stream->maximumLevel = 0;
+    float rate = nominalRate;
+    while ((rate > minimumRate) && (stream->maximumLevel < NGIMU_RATE_CONTROL_MAX_LEVEL)) {
+        rate *= 0.5f;
+        stream->maximumLevel++;
+    }
+    return true;
+}
+
+/**
+ * @brief Sets backlog thresholds.  The backlog is expressed as a fraction,
+ * e.g. the number of records in a queue divided by the queue capacity.
+ * @param ngimuRateControl Address of rate control structure.
+ * @param reduceThreshold Backlog above which rates are reduced.
+ * @param restoreThreshold Backlog below which rates are restored.
+ */
+void NgimuRateControlSetThresholds(NgimuRateControl * const ngimuRateControl, const float reduceThreshold, const float restoreThreshold) {
+    ngimuRateControl->reduceThreshold = reduceThreshold;
+    ngimuRateControl->restoreThreshold = restoreThreshold;
+}
+
+/**
+ * @brief Sets the request tracker that each rate write is added to so that
+ * the response of the NGIMU may be confirmed.
+ * @param ngimuRateControl Address of rate control structure.
+ * @param ngimuSendTracker Address of tracker structure, or NULL.
+ */
+void NgimuRateControlSetTracker(NgimuRateControl * const ngimuRateControl, NgimuSendTracker * const ngimuSendTracker) {
+    ngimuRateControl->ngimuSendTracker = ngimuSendTracker;
+}
+
+/**
+ * @brief Updates rate control.  This function should be called periodically,
+ * e.g. from the main loop.  At most one rate is changed per hold time.  The
+ * rate of the lowest priority message type that is not at its minimum is
+ * halved if the backlog is above the reduce threshold.  The rate of the
+ * highest priority message type that has been reduced is doubled if the
+ * backlog is below the restore threshold.
+ * @param ngimuRateControl Address of rate control structure.
+ * @param backlog Backlog expressed as a fraction, e.g.
+ * (float) NgimuQueueGetCount(&ngimuQueue) / NGIMU_QUEUE_CAPACITY.
+ * @param time Current time.
+ */
+void NgimuRateControlUpdate(NgimuRateControl * const ngimuRateControl, const float backlog, const uint32_t time) {
+
+    // Allow previous change to take effect
+    if (ngimuRateControl->changed && ((uint32_t) (time - ngimuRateControl->changeTime) < ngimuRateControl->holdTime)) {
+        return;
+    }
+
+    // Reduce lowest priority message type
+    size_t index;
+    if (backlog > ngimuRateControl->reduceThreshold) {
+        for (index = 0; index < ngimuRateControl->numberOfStreams; index++) {
+            NgimuRateControlStream * const stream = &ngimuRateControl->streams[index];
+            if (stream->level < stream->maximumLevel) {
+                stream->level++;
+                SendRate(ngimuRateControl, stream, time);
+                return;
+            }
+        }
+        return;
+    }
+
+    // Restore highest priority message type
+    if (backlog < ngimuRateControl->restoreThreshold) {
+        for (index = ngimuRateControl->numberOfStreams; index > 0; index--) {
+            NgimuRateControlStream * const stream = &ngimuRateControl->streams[index - 1];
+            if (stream->level > 0) {
+                stream->level--;
+                SendRate(ngimuRateControl, stream, time);
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Returns the current rate of a controlled message type.
+ * @param ngimuRateControl Address of rate control structure.
+ * @param streamIndex Index of the message type in the order added.
+ * @return Current rate in Hz.
+ */
+float NgimuRateControlGetRate(const NgimuRateControl * const ngimuRateControl, const size_t streamIndex) {
+    return GetStreamRate(&ngimuRateControl->streams[streamIndex]);
+}
+
+/**
+ * @brief Returns true if the rate of any controlled message type is reduced.
+ * @param ngimuRateControl Address of rate control structure.
+ * @return True if the rate of any controlled message type is reduced.
+ */
+bool NgimuRateControlIsReduced(const NgimuRateControl * const ngimuRateControl) {
+    size_t index;
+    for (index = 0; index < ngimuRateControl->numberOfStreams; index++) {
+        if (ngimuRateControl->streams[index].level > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the rate of a controlled message type for the current level.
+ * @param stream Address of stream structure.
+ * @return Rate in Hz.
+ */
+static float GetStreamRate(const NgimuRateControlStream * const stream) {
+    if (stream->level >= stream->maximumLevel) {
+        return (stream->level == 0) ? stream->nominalRate : stream->minimumRate;
+    }
+    return stream->nominalRate / (float) (1u << stream->level);
+}
+
+/**
+ * @brief Sends the current rate of a controlled message type to the NGIMU.
+ * @param ngimuRateControl Address of rate control structure.
+ * @param stream Address of stream structure.
+ * @param time Current time.
+ */
+static void SendRate(NgimuRateControl * const ngimuRateControl, const NgimuRateControlStream * const stream, const uint32_t time) {
+    ngimuRateControl->changed = true;
+    ngimuRateControl->changeTime = time;
+    char buffer[WRITE_BUFFER_SIZE];
+    size_t size;
+    if (NgimuSendEncodeWriteFloat32(ngimuRateControl->transport, stream->address, GetStreamRate(stream), buffer, sizeof (buffer), &size) != OscErrorNone) {
+        return;
+    }
+    ngimuRateControl->write(buffer, size, ngimuRateControl->userContext);
+    if (ngimuRateControl->ngimuSendTracker != NULL) {
+        NgimuSendTrackerAdd(ngimuRateControl->ngimuSendTracker, stream->address, time);
+    }
+}
+
+//------------------------------------------------------------------------------
+// End of file
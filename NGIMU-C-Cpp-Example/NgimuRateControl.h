@@ -0,0 +1,90 @@
+/**
+ * @file NgimuRateControl.h
+ * @author Seb Madgwick
+ * @brief Adaptive control of NGIMU message rates based on the backlog of the
+ * application, e.g. the fill level of an NgimuQueue.  The rates of low
+ * priority message types are reduced first when the backlog is high and are
+ * restored last once the backlog has cleared.
+ */
+
+#ifndef NGIMU_RATE_CONTROL_H
+#define NGIMU_RATE_CONTROL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuReceive.h"
+#include "NgimuSend.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of controlled message types.
+ */
+#ifndef NGIMU_RATE_CONTROL_MAX_STREAMS
+#define NGIMU_RATE_CONTROL_MAX_STREAMS (4)
+#endif
+
+/**
+ * @brief Maximum number of times that the rate of a message type may be
+ * halved before it is set to the minimum rate.
+ */
+#define NGIMU_RATE_CONTROL_MAX_LEVEL (8)
+
+/**
+ * @brief Controlled message type.  Structure members are used internally and
+ * should not be used by the user application.
+ */
+typedef struct {
+    const char* address;
+    float nominalRate;
+    float minimumRate;
+    unsigned int maximumLevel;
+    unsigned int level;
+} NgimuRateControlStream;
+
+/**
+ * @brief Rate control structure.  Structure members are used internally and
+ * should not be used by the user application.
+ */
+typedef struct {
+    NgimuRateControlStream streams[NGIMU_RATE_CONTROL_MAX_STREAMS];
+    size_t numberOfStreams;
+    NgimuReceiveTransport transport;
+    void (*write)(const char * const data, const size_t size, void * const userContext);
+    void* userContext;
+    NgimuSendTracker* ngimuSendTracker;
+    float reduceThreshold;
+    float restoreThreshold;
+    uint32_t holdTime;
+    uint32_t changeTime;
+    bool changed;
+} NgimuRateControl;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+void NgimuRateControlInitialise(NgimuRateControl * const ngimuRateControl, const NgimuReceiveTransport transport, const uint32_t holdTime, void (*write)(const char * const data, const size_t size, void * const userContext), void * const userContext);
+bool NgimuRateControlAddStream(NgimuRateControl * const ngimuRateControl, const char * const address, const float nominalRate, const float minimumRate);
+void NgimuRateControlSetThresholds(NgimuRateControl * const ngimuRateControl, const float reduceThreshold, const float restoreThreshold);
+void NgimuRateControlSetTracker(NgimuRateControl * const ngimuRateControl, NgimuSendTracker * const ngimuSendTracker);
+void NgimuRateControlUpdate(NgimuRateControl * const ngimuRateControl, const float backlog, const uint32_t time);
+float NgimuRateControlGetRate(const NgimuRateControl * const ngimuRateControl, const size_t streamIndex);
+bool NgimuRateControlIsReduced(const NgimuRateControl * const ngimuRateControl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -8,38 +8,729 @@
 // Includes
 
 #include "NgimuReceive.h"
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+#include "NgimuDerive.h"
+#endif
 #include <stddef.h>
-#include <stdio.h> // snprintf
+#include <stdint.h>
+#include <string.h> // memcmp, memcpy
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+// Definitions
+
+#if !NGIMU_RECEIVE_ENABLE_SENSORS && !NGIMU_RECEIVE_ENABLE_QUATERNION && !NGIMU_RECEIVE_ENABLE_EULER
+#error "At least one message type must be enabled."
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_DERIVED && !NGIMU_RECEIVE_ENABLE_QUATERNION
+#error "Derived outputs require \"/quaternion\" messages to be enabled."
+#endif
+
+/**
+ * @brief Address table entry.  The address length and argument count are
+ * stored so that a message can be rejected without a string comparison.
+ */
+typedef struct {
+    const char* address;
+    size_t addressLength;
+    OscError(*process)(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+    size_t argumentCount;
+} AddressTableEntry;
+
+/**
+ * @brief Initialiser for an address table entry.  The address must be a string
+ * literal so that its length can be determined at compile time.
+ */
+#define ADDRESS_TABLE_ENTRY(address, process, argumentCount) { address, sizeof (address) - 1, process, argumentCount }
+
+/**
+ * @brief Type tag string of the longest layout that can be decoded using the
+ * single pass float extraction.
+ */
+#define FLOAT32_TYPE_TAG_STRING ",ffffffffffffffff"
+
+/**
+ * @brief Maximum number of arguments that can be decoded using the single pass
+ * float extraction.
+ */
+#define MAX_NUMBER_OF_FLOAT32_ARGUMENTS (sizeof (FLOAT32_TYPE_TAG_STRING) - 2)
+
+/**
+ * @brief Compile-time assertion that the float members of a structure are
+ * contiguous so that they can be written as a single array.
+ */
+#define ASSERT_CONTIGUOUS(type, first, last, numberOfMembers) typedef char type##Contiguous[((offsetof(type, last) - offsetof(type, first)) == (((numberOfMembers) - 1) * sizeof (float))) ? 1 : -1]
+
+/**
+ * @brief Address of the first of the contiguous float members of a structure,
+ * derived from the structure address so that it may be used as an array.
+ */
+#define FLOAT32_MEMBERS(structure, type, first) ((float *) ((char *) (structure) + offsetof(type, first)))
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+ASSERT_CONTIGUOUS(NgimuSensors, gyroscopeX, barometer, 10);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+ASSERT_CONTIGUOUS(NgimuQuaternion, w, z, 4);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+ASSERT_CONTIGUOUS(NgimuEuler, roll, yaw, 3);
+#endif
+
+/**
+ * @brief OSC bundle header including the terminating null character.
+ */
+#define OSC_BUNDLE_HEADER "#bundle"
+
+/**
+ * @brief Minimum size of an OSC bundle: header and time tag.
+ */
+#define MIN_OSC_BUNDLE_SIZE (sizeof (OSC_BUNDLE_HEADER) + sizeof (uint64_t))
+
+/**
+ * @brief Word with every byte set to the specified value.
+ */
+#define REPEAT_BYTE(byte) ((((size_t) -1) / 0xFF) * (unsigned char) (byte))
+
+/**
+ * @brief Non-zero if any byte of the word is zero.
+ */
+#define HAS_ZERO_BYTE(word) (((word) - REPEAT_BYTE(0x01)) & ~(word) & REPEAT_BYTE(0x80))
+
+/**
+ * @brief Statistics operations.  These expand to nothing if statistics are
+ * disabled.
+ */
+#if NGIMU_RECEIVE_ENABLE_STATISTICS
+#define STATISTICS_ADD(ngimuReceiver, member, value) ((ngimuReceiver)->statistics.member += (uint32_t) (value))
+#define STATISTICS_START_DECODE(ngimuReceiver) ((ngimuReceiver)->decodeStartCycleCount = NGIMU_RECEIVE_GET_CYCLE_COUNT())
+#define STATISTICS_END_DECODE(ngimuReceiver) AddDecodeCycles(ngimuReceiver)
+#define STATISTICS_OSC_ERROR(ngimuReceiver, oscError) AddOscError(ngimuReceiver, oscError)
+#else
+#define STATISTICS_ADD(ngimuReceiver, member, value)
+#define STATISTICS_START_DECODE(ngimuReceiver)
+#define STATISTICS_END_DECODE(ngimuReceiver)
+#define STATISTICS_OSC_ERROR(ngimuReceiver, oscError)
+#endif
+
+/**
+ * @brief Passes raw input to the capture callback.  This expands to nothing if
+ * capture is disabled.
+ */
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+#define CAPTURE(ngimuReceiver, transport, source, sourceSize) do { if ((ngimuReceiver)->captureCallback != NULL) { (ngimuReceiver)->captureCallback(transport, source, sourceSize, (ngimuReceiver)->captureContext); } } while (0)
+#else
+#define CAPTURE(ngimuReceiver, transport, source, sourceSize)
+#endif
+
+/**
+ * @brief True if a "/quaternion" message must be decoded for derived outputs.
+ * This expands to false if derived outputs are disabled.
+ */
+#if NGIMU_RECEIVE_ENABLE_DERIVED && NGIMU_RECEIVE_ENABLE_EULER
+#define DERIVED_OUTPUT_REQUIRED(ngimuReceiver) (((ngimuReceiver)->deriveEuler && ((ngimuReceiver)->eulerCallback != NULL)) || ((ngimuReceiver)->rotationMatrixCallback != NULL))
+#elif NGIMU_RECEIVE_ENABLE_DERIVED
+#define DERIVED_OUTPUT_REQUIRED(ngimuReceiver) ((ngimuReceiver)->rotationMatrixCallback != NULL)
+#else
+#define DERIVED_OUTPUT_REQUIRED(ngimuReceiver) (false)
+#endif
 
 //------------------------------------------------------------------------------
 // Variable declarations
 
-static OscSlipDecoder oscSlipDecoder;
+static NgimuReceiver defaultReceiver;
 static void (*receiveErrorCallback)(const char* const errorMessage);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
 static void (*sensorsCallback)(const NgimuSensors ngimuSensors);
+static void (*sensorsPointerCallback)(const NgimuSensors * const ngimuSensors, void * const userContext);
+static void* sensorsUserContext;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
 static void (*quaternionCallback)(const NgimuQuaternion ngimuQuaternion);
+static void (*quaternionPointerCallback)(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+static void* quaternionUserContext;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
 static void (*eulerCallback)(const NgimuEuler ngimuEuler);
+static void (*eulerPointerCallback)(const NgimuEuler * const ngimuEuler, void * const userContext);
+static void* eulerUserContext;
+#endif
+static void (*bundleCallback)(const NgimuBundle ngimuBundle);
+static void (*bundlePointerCallback)(const NgimuBundle * const ngimuBundle, void * const userContext);
+static void* bundleUserContext;
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+static void (*sensorsQCallback)(const NgimuSensorsQ ngimuSensorsQ);
+static void (*sensorsQPointerCallback)(const NgimuSensorsQ * const ngimuSensorsQ, void * const userContext);
+static void* sensorsQUserContext;
+#endif
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+static void (*quaternionQCallback)(const NgimuQuaternionQ ngimuQuaternionQ);
+static void (*quaternionQPointerCallback)(const NgimuQuaternionQ * const ngimuQuaternionQ, void * const userContext);
+static void* quaternionQUserContext;
+#endif
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+static void (*rotationMatrixCallback)(const NgimuRotationMatrix ngimuRotationMatrix);
+static void (*rotationMatrixPointerCallback)(const NgimuRotationMatrix * const ngimuRotationMatrix, void * const userContext);
+static void* rotationMatrixUserContext;
+#endif
 
 //------------------------------------------------------------------------------
 // Function prototypes
 
-static void ProcessPacket(OscPacket * const oscMessage);
-static void ProcessMessage(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
-static OscError ProcessAddress(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
-static OscError ProcessSensors(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
-static OscError ProcessQuaternion(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
-static OscError ProcessEuler(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+static void UpdateDefaultReceiverCallbacks();
+static void DefaultReceiveErrorCallback(const NgimuReceiveError * const ngimuReceiveError, void * const userContext);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static void DefaultSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+static void DefaultQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+static void DefaultEulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext);
+#endif
+static void DefaultBundleCallback(const NgimuBundle * const ngimuBundle, void * const userContext);
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+static void DefaultSensorsQCallback(const NgimuSensorsQ * const ngimuSensorsQ, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+static void DefaultQuaternionQCallback(const NgimuQuaternionQ * const ngimuQuaternionQ, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+static void DefaultRotationMatrixCallback(const NgimuRotationMatrix * const ngimuRotationMatrix, void * const userContext);
+#endif
+static void DecodeSerialBytes(NgimuReceiver * const ngimuReceiver, const char * const source, const size_t sourceSize);
+static void DecodeSerialByte(NgimuReceiver * const ngimuReceiver, const char byte);
+static void SpillInPlacePacket(NgimuReceiver * const ngimuReceiver);
+static size_t FindSlipSpecialCharacter(const char * const source, const size_t sourceSize);
+static void ProcessPacket(NgimuReceiver * const ngimuReceiver, const char * const contents, const size_t contentsSize);
+static bool CheckContents(NgimuReceiver * const ngimuReceiver, const char * const contents, const size_t contentsSize, const unsigned int depth, size_t * const numberOfMessages);
+static OscError ProcessContents(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, const char * const contents, const size_t contentsSize);
+static void ProcessMessage(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+static OscError ProcessAddress(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static OscError ProcessSensors(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+static OscError ProcessQuaternion(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+static OscError ProcessEuler(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+#endif
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+static void ProcessDerivedOutputs(NgimuReceiver * const ngimuReceiver, const NgimuQuaternion * const ngimuQuaternion);
+#endif
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+static OscError ProcessSensorsQ(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+#endif
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+static OscError ProcessQuaternionQ(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+#endif
+static NgimuBundle* PrepareBundle(NgimuReceiver * const ngimuReceiver, const NgimuBundleContents contents, const OscTimeTag * const oscTimeTag);
+static void DeliverBundle(NgimuReceiver * const ngimuReceiver);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static OscError WriteSensorsColumns(NgimuReceiver * const ngimuReceiver, NgimuSensorsColumns * const columns, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+static OscError WriteQuaternionColumns(NgimuReceiver * const ngimuReceiver, NgimuQuaternionColumns * const columns, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+static OscError WriteEulerColumns(NgimuReceiver * const ngimuReceiver, NgimuEulerColumns * const columns, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage);
+#endif
+static bool IsAddressIgnored(const NgimuReceiver * const ngimuReceiver, const OscMessage * const oscMessage);
+static void ReceiveError(NgimuReceiver * const ngimuReceiver, const NgimuReceiveErrorCode code, const OscError oscError, const char * const oscAddressPattern);
+static size_t AppendString(char * const destination, const size_t destinationSize, size_t index, const char * const source);
+#if NGIMU_RECEIVE_ENABLE_STATISTICS
+static void AddDecodeCycles(NgimuReceiver * const ngimuReceiver);
+static void AddOscError(NgimuReceiver * const ngimuReceiver, const OscError oscError);
+#endif
+static uint32_t ReadBigEndian32(const char * const source);
+static OscError GetArgumentsAsFloat32Array(OscMessage * const oscMessage, float * const destination, const size_t numberOfArguments);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static OscError GetSelectedArgumentsAsFloat32Array(OscMessage * const oscMessage, float * const destination, const size_t numberOfArguments, const unsigned int skippedArguments);
+#endif
+static void ByteSwapFloat32Array(float * const destination, const char * const source, const size_t numberOfArguments);
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && (NGIMU_RECEIVE_ENABLE_SENSORS || NGIMU_RECEIVE_ENABLE_QUATERNION)
+static OscError GetArgumentsAsFixedPointArray(OscMessage * const oscMessage, int32_t * const destination, const size_t numberOfArguments, const int fractionalBits, const unsigned int skippedArguments);
+static int32_t Float32ToFixedPoint(const uint32_t float32, const int fractionalBits);
+#endif
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+static int16_t SaturateInt16(const int32_t value);
+#endif
+
+//------------------------------------------------------------------------------
+// Constants
+
+/**
+ * @brief Table of known message types.  New message types are added here.
+ */
+static const AddressTableEntry addressTable[] = {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    ADDRESS_TABLE_ENTRY("/sensors", ProcessSensors, 10),
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    ADDRESS_TABLE_ENTRY("/quaternion", ProcessQuaternion, 4),
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    ADDRESS_TABLE_ENTRY("/euler", ProcessEuler, 3),
+#endif
+};
+
+#define ADDRESS_TABLE_LENGTH (sizeof (addressTable) / sizeof (addressTable[0]))
+
+/**
+ * @brief Time tag passed to callbacks for messages that are not contained
+ * within a bundle.  A value of 1 means "immediately" in the OSC specification.
+ */
+static const OscTimeTag immediateTimeTag = {.value = 1};
 
 //------------------------------------------------------------------------------
-// Functions
+// Functions - Receiver
+
+/**
+ * @brief Initialises receiver.  This function must be called before the
+ * receiver is used.  All callbacks are cleared.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+void NgimuReceiverInitialise(NgimuReceiver * const ngimuReceiver) {
+    memset(ngimuReceiver, 0, sizeof (*ngimuReceiver));
+}
+
+/**
+ * @brief Sets the user context passed to all callback functions of the
+ * receiver.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param userContext User context.
+ */
+void NgimuReceiverSetUserContext(NgimuReceiver * const ngimuReceiver, void * const userContext) {
+    ngimuReceiver->userContext = userContext;
+}
+
+/**
+ * @brief Sets receive error callback function.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newReceiveErrorCallback Receive error callback function.
+ */
+void NgimuReceiverSetReceiveErrorCallback(NgimuReceiver * const ngimuReceiver, void (*newReceiveErrorCallback)(const NgimuReceiveError * const ngimuReceiveError, void * const userContext)) {
+    ngimuReceiver->receiveErrorCallback = newReceiveErrorCallback;
+}
+
+/**
+ * @brief Adds an address to the list of unrecognised addresses that are
+ * discarded without an error.  The string is not copied and must remain valid
+ * for the lifetime of the receiver.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param address Address, e.g. "/battery".
+ * @return True if successful, false if the list is full.
+ */
+bool NgimuReceiverIgnoreAddress(NgimuReceiver * const ngimuReceiver, const char * const address) {
+    if (ngimuReceiver->numberOfIgnoredAddresses >= NGIMU_RECEIVER_MAX_IGNORED_ADDRESSES) {
+        return false;
+    }
+    ngimuReceiver->ignoredAddresses[ngimuReceiver->numberOfIgnoredAddresses] = address;
+    ngimuReceiver->ignoredAddressLengths[ngimuReceiver->numberOfIgnoredAddresses] = strlen(address);
+    ngimuReceiver->numberOfIgnoredAddresses++;
+    return true;
+}
+
+/**
+ * @brief Sets whether all unrecognised addresses are discarded without an
+ * error.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param ignoreUnrecognisedAddresses True to discard all unrecognised
+ * addresses without an error.
+ */
+void NgimuReceiverSetIgnoreUnrecognisedAddresses(NgimuReceiver * const ngimuReceiver, const bool ignoreUnrecognisedAddresses) {
+    ngimuReceiver->ignoreUnrecognisedAddresses = ignoreUnrecognisedAddresses;
+}
+
+/**
+ * @brief Sets unrecognised message callback function.  The callback is called
+ * for each message with an unrecognised address, e.g. a response to a setting
+ * read or write, and returns true if the message was handled.  Messages that
+ * are not handled are reported as unrecognised addresses.  The message is only
+ * valid for the duration of the callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newUnrecognisedMessageCallback Unrecognised message callback
+ * function.
+ * @param unrecognisedMessageContext Context passed to the callback function.
+ */
+void NgimuReceiverSetUnrecognisedMessageCallback(NgimuReceiver * const ngimuReceiver, bool (*newUnrecognisedMessageCallback)(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage, void * const unrecognisedMessageContext), void * const unrecognisedMessageContext) {
+    ngimuReceiver->unrecognisedMessageCallback = newUnrecognisedMessageCallback;
+    ngimuReceiver->unrecognisedMessageContext = unrecognisedMessageContext;
+}
+
+/**
+ * @brief Sets time tag callback function.  The callback is called with the OSC
+ * address pattern and OSC time tag of each message before the message is
+ * processed, e.g. to monitor the timing of each message type.  The address
+ * pattern is only valid for the duration of the callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newTimeTagCallback Time tag callback function.
+ * @param timeTagContext Context passed to the callback function.
+ */
+void NgimuReceiverSetTimeTagCallback(NgimuReceiver * const ngimuReceiver, void (*newTimeTagCallback)(const char * const oscAddressPattern, const size_t oscAddressPatternLength, const OscTimeTag * const oscTimeTag, void * const timeTagContext), void * const timeTagContext) {
+    ngimuReceiver->timeTagCallback = newTimeTagCallback;
+    ngimuReceiver->timeTagContext = timeTagContext;
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Sets receive "/sensors" callback function.  The callback receives a
+ * pointer to a structure owned by the receiver that is only valid for the
+ * duration of the callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newSensorsCallback "/sensors" callback function.
+ */
+void NgimuReceiverSetSensorsCallback(NgimuReceiver * const ngimuReceiver, void (*newSensorsCallback)(const NgimuSensors * const ngimuSensors, void * const userContext)) {
+    ngimuReceiver->sensorsCallback = newSensorsCallback;
+}
+
+/**
+ * @brief Sets the "/sensors" fields that are decoded, e.g.
+ * NgimuSensorsFieldsGyroscope | NgimuSensorsFieldsAccelerometer.  The
+ * arguments of other fields are not extracted and the structure members
+ * retain their previous values.  All fields are decoded by default.  Applies
+ * to the "/sensors", "/sensors" fixed-point and bundle callbacks.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param ngimuSensorsFields "/sensors" fields to be decoded.
+ */
+void NgimuReceiverSetSensorsFields(NgimuReceiver * const ngimuReceiver, const unsigned int ngimuSensorsFields) {
+    ngimuReceiver->sensorsSkippedArguments = NgimuSensorsFieldsAll & ~ngimuSensorsFields;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Sets receive "/quaternion" callback function.  The callback receives a
+ * pointer to a structure owned by the receiver that is only valid for the
+ * duration of the callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newQuaternionCallback "/quaternion" callback function.
+ */
+void NgimuReceiverSetQuaternionCallback(NgimuReceiver * const ngimuReceiver, void (*newQuaternionCallback)(const NgimuQuaternion * const ngimuQuaternion, void * const userContext)) {
+    ngimuReceiver->quaternionCallback = newQuaternionCallback;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief Sets receive "/euler" callback function.  The callback receives a
+ * pointer to a structure owned by the receiver that is only valid for the
+ * duration of the callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newEulerCallback "/euler" callback function.
+ */
+void NgimuReceiverSetEulerCallback(NgimuReceiver * const ngimuReceiver, void (*newEulerCallback)(const NgimuEuler * const ngimuEuler, void * const userContext)) {
+    ngimuReceiver->eulerCallback = newEulerCallback;
+}
+#endif
+
+/**
+ * @brief Sets bundle callback function.  While assigned, the recognised
+ * messages of each OSC packet are decoded into one bundle structure that is
+ * provided once the packet has been processed, instead of being passed to the
+ * message callbacks.  A message that is not within a bundle is provided as a
+ * bundle of one message.  If a bundle contains more than one message of the
+ * same type then the messages decoded so far are provided first.  The callback
+ * receives a pointer to a structure owned by the receiver that is only valid
+ * for the duration of the callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newBundleCallback Bundle callback function, or NULL to use the
+ * message callbacks.
+ */
+void NgimuReceiverSetBundleCallback(NgimuReceiver * const ngimuReceiver, void (*newBundleCallback)(const NgimuBundle * const ngimuBundle, void * const userContext)) {
+    ngimuReceiver->bundleCallback = newBundleCallback;
+    ngimuReceiver->ngimuBundle.contents = 0;
+}
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Sets receive "/sensors" fixed-point callback function.  While
+ * assigned, "/sensors" messages are decoded to fixed-point instead of being
+ * passed to the "/sensors" or bundle callbacks.  The callback receives a
+ * pointer to a structure owned by the receiver that is only valid for the
+ * duration of the callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newSensorsQCallback "/sensors" fixed-point callback function, or NULL.
+ */
+void NgimuReceiverSetSensorsQCallback(NgimuReceiver * const ngimuReceiver, void (*newSensorsQCallback)(const NgimuSensorsQ * const ngimuSensorsQ, void * const userContext)) {
+    ngimuReceiver->sensorsQCallback = newSensorsQCallback;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Sets receive "/quaternion" fixed-point callback function.  While
+ * assigned, "/quaternion" messages are decoded to fixed-point instead of being
+ * passed to the "/quaternion" or bundle callbacks, and derived outputs are not
+ * provided.  The callback receives a pointer to a structure owned by the
+ * receiver that is only valid for the duration of the callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newQuaternionQCallback "/quaternion" fixed-point callback function, or
+ * NULL.
+ */
+void NgimuReceiverSetQuaternionQCallback(NgimuReceiver * const ngimuReceiver, void (*newQuaternionQCallback)(const NgimuQuaternionQ * const ngimuQuaternionQ, void * const userContext)) {
+    ngimuReceiver->quaternionQCallback = newQuaternionQCallback;
+}
+#endif
+
+/**
+ * @brief Sets column buffers that decoded messages are written to instead of
+ * being passed to the message callbacks, e.g. for batch processing of a
+ * capture.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param ngimuColumns Address of columns structure, or NULL to use the message
+ * callbacks.
+ */
+void NgimuReceiverSetColumns(NgimuReceiver * const ngimuReceiver, NgimuColumns * const ngimuColumns) {
+    ngimuReceiver->ngimuColumns = ngimuColumns;
+}
+
+/**
+ * @brief Process byte received from NGIMU via a serial communication channel.
+ * This function should be called for each byte receive within a serial stream.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param byte Serial byte
+ */
+void NgimuReceiverProcessSerialByte(NgimuReceiver * const ngimuReceiver, const char byte) {
+    STATISTICS_ADD(ngimuReceiver, numberOfBytes, 1);
+    CAPTURE(ngimuReceiver, NgimuReceiveTransportSerial, &byte, 1);
+    if (ngimuReceiver->slipInPlace != NULL) {
+        SpillInPlacePacket(ngimuReceiver);
+    }
+    DecodeSerialByte(ngimuReceiver, byte);
+}
+
+/**
+ * @brief Process block of bytes received from NGIMU via a serial communication
+ * channel, e.g. a DMA buffer.  Runs of bytes without SLIP special characters
+ * are copied to the SLIP decoder buffer in bulk.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ */
+void NgimuReceiverProcessSerialBytes(NgimuReceiver * const ngimuReceiver, const char * const source, const size_t sourceSize) {
+    STATISTICS_ADD(ngimuReceiver, numberOfBytes, sourceSize);
+    CAPTURE(ngimuReceiver, NgimuReceiveTransportSerial, source, sourceSize);
+    if (ngimuReceiver->slipInPlace != NULL) {
+        SpillInPlacePacket(ngimuReceiver);
+    }
+    DecodeSerialBytes(ngimuReceiver, source, sourceSize);
+}
+
+/**
+ * @brief Process block of bytes received from NGIMU via a serial communication
+ * channel by decoding the SLIP encoding in place, so that packets are not
+ * copied to the SLIP decoder buffer.  The source is modified.  A packet that is
+ * incomplete at the end of the block remains in the source and is completed in
+ * place if the next block immediately follows it in memory, e.g. the next chunk
+ * of a circular DMA buffer.  Otherwise, e.g. on wrap-around of a circular
+ * buffer, the incomplete packet is copied to the SLIP decoder buffer.  The
+ * bytes of an incomplete packet must not be modified until the next block has
+ * been processed.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ */
+void NgimuReceiverProcessSerialBytesInPlace(NgimuReceiver * const ngimuReceiver, char * const source, const size_t sourceSize) {
+    STATISTICS_ADD(ngimuReceiver, numberOfBytes, sourceSize);
+    CAPTURE(ngimuReceiver, NgimuReceiveTransportSerial, source, sourceSize);
+    size_t index = 0;
+
+    // Copy incomplete packet if not contiguous with source
+    if ((ngimuReceiver->slipInPlace != NULL) && (ngimuReceiver->slipInPlaceEnd != source)) {
+        SpillInPlacePacket(ngimuReceiver);
+    }
+
+    // Complete packet in SLIP decoder buffer
+    if ((ngimuReceiver->slipInPlace == NULL) && ((ngimuReceiver->slipBufferIndex > 0) || ngimuReceiver->slipEscape || ngimuReceiver->slipDiscard)) {
+        const char * const end = memchr(source, SLIP_END, sourceSize);
+        if (end == NULL) {
+            DecodeSerialBytes(ngimuReceiver, source, sourceSize);
+            return;
+        }
+        index = (size_t) (end - source) + 1;
+        DecodeSerialBytes(ngimuReceiver, source, index);
+    }
+
+    // Decode remaining packets in place
+    char* packet = &source[index];
+    size_t packetSize = 0;
+    if (ngimuReceiver->slipInPlace != NULL) {
+        packet = ngimuReceiver->slipInPlace;
+        packetSize = ngimuReceiver->slipBufferIndex;
+        ngimuReceiver->slipInPlace = NULL;
+        ngimuReceiver->slipBufferIndex = 0;
+    }
+    while (index < sourceSize) {
+
+        // Skip to end of invalid packet
+        if (ngimuReceiver->slipDiscard == true) {
+            const char * const end = memchr(&source[index], SLIP_END, sourceSize - index);
+            if (end == NULL) {
+                return;
+            }
+            index = (size_t) (end - source);
+        }
+
+        // Move run of plain bytes
+        else if (ngimuReceiver->slipEscape == false) {
+            const size_t runLength = FindSlipSpecialCharacter(&source[index], sourceSize - index);
+            if (&packet[packetSize] != &source[index]) {
+                memmove(&packet[packetSize], &source[index], runLength);
+            }
+            packetSize += runLength;
+            index += runLength;
+            if (index >= sourceSize) {
+                break;
+            }
+        }
+
+        // Process packet on SLIP END
+        const char byte = source[index++];
+        if (byte == SLIP_END) {
+            if ((ngimuReceiver->slipDiscard == false) && (packetSize > 0)) {
+                ProcessPacket(ngimuReceiver, packet, packetSize);
+            }
+            packet = &source[index];
+            packetSize = 0;
+            ngimuReceiver->slipEscape = false;
+            ngimuReceiver->slipDiscard = false;
+            continue;
+        }
+
+        // Decode escape sequence
+        if (ngimuReceiver->slipEscape == false) {
+            ngimuReceiver->slipEscape = true;
+            continue;
+        }
+        ngimuReceiver->slipEscape = false;
+        if (byte == SLIP_ESC_END) {
+            packet[packetSize++] = SLIP_END;
+        } else if (byte == SLIP_ESC_ESC) {
+            packet[packetSize++] = SLIP_ESC;
+        } else {
+            ngimuReceiver->slipDiscard = true;
+            STATISTICS_ADD(ngimuReceiver, numberOfSlipErrors, 1);
+            ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorUnexpectedByteAfterSlipEsc, NULL);
+        }
+    }
+
+    // Keep incomplete packet in place
+    if ((ngimuReceiver->slipDiscard == false) && ((packetSize > 0) || ngimuReceiver->slipEscape)) {
+        ngimuReceiver->slipInPlace = packet;
+        ngimuReceiver->slipBufferIndex = packetSize;
+        ngimuReceiver->slipInPlaceEnd = &source[sourceSize];
+    }
+}
+
+/**
+ * @brief Process UDP packet received from NGIMU via Wi-Fi.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ */
+void NgimuReceiverProcessUdpPacket(NgimuReceiver * const ngimuReceiver, const char * const source, const size_t sourceSize) {
+    STATISTICS_ADD(ngimuReceiver, numberOfBytes, sourceSize);
+    CAPTURE(ngimuReceiver, NgimuReceiveTransportUdp, source, sourceSize);
+    ProcessPacket(ngimuReceiver, source, sourceSize);
+}
+
+/**
+ * @brief Process a batch of UDP packets received from NGIMUs via Wi-Fi.
+ * Packets are processed in order.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param packets Array of UDP packet descriptors.
+ * @param numberOfPackets Number of packets.
+ */
+void NgimuReceiverProcessUdpPackets(NgimuReceiver * const ngimuReceiver, const NgimuUdpPacket * const packets, const size_t numberOfPackets) {
+    size_t index;
+    for (index = 0; index < numberOfPackets; index++) {
+        STATISTICS_ADD(ngimuReceiver, numberOfBytes, packets[index].size);
+        CAPTURE(ngimuReceiver, NgimuReceiveTransportUdp, packets[index].buffer, packets[index].size);
+        ProcessPacket(ngimuReceiver, packets[index].buffer, packets[index].size);
+    }
+}
+
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+/**
+ * @brief Sets capture callback function.  The callback is called with all raw
+ * input before it is decoded.  The source is only valid for the duration of
+ * the callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newCaptureCallback Capture callback function.
+ * @param captureContext Context passed to the callback function.
+ */
+void NgimuReceiverSetCaptureCallback(NgimuReceiver * const ngimuReceiver, void (*newCaptureCallback)(const NgimuReceiveTransport transport, const char * const source, const size_t sourceSize, void * const captureContext), void * const captureContext) {
+    ngimuReceiver->captureCallback = newCaptureCallback;
+    ngimuReceiver->captureContext = captureContext;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+/**
+ * @brief Sets whether Euler angles are derived from each "/quaternion" message
+ * and provided through the "/euler" callback or bundle callback as if an
+ * "/euler" message was received.  "/euler" messages are still decoded, and
+ * both the received and derived Euler angles are provided, so "/euler"
+ * messages should be disabled on the NGIMU.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param deriveEuler True to derive Euler angles.
+ * @param derivedAccuracy Accuracy of the derived Euler angles.
+ */
+void NgimuReceiverSetDerivedEuler(NgimuReceiver * const ngimuReceiver, const bool deriveEuler, const NgimuDerivedAccuracy derivedAccuracy) {
+    ngimuReceiver->deriveEuler = deriveEuler;
+    ngimuReceiver->derivedAccuracy = derivedAccuracy;
+}
+
+/**
+ * @brief Sets rotation matrix callback function.  The callback is called with
+ * a rotation matrix derived from each "/quaternion" message.  The callback
+ * receives a pointer to a structure owned by the receiver that is only valid
+ * for the duration of the callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param newRotationMatrixCallback Rotation matrix callback function.
+ */
+void NgimuReceiverSetRotationMatrixCallback(NgimuReceiver * const ngimuReceiver, void (*newRotationMatrixCallback)(const NgimuRotationMatrix * const ngimuRotationMatrix, void * const userContext)) {
+    ngimuReceiver->rotationMatrixCallback = newRotationMatrixCallback;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_STATISTICS
+/**
+ * @brief Gets receiver statistics.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param ngimuReceiveStatistics Address of statistics structure to be written.
+ */
+void NgimuReceiverGetStatistics(const NgimuReceiver * const ngimuReceiver, NgimuReceiveStatistics * const ngimuReceiveStatistics) {
+    *ngimuReceiveStatistics = ngimuReceiver->statistics;
+}
+
+/**
+ * @brief Resets receiver statistics.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+void NgimuReceiverResetStatistics(NgimuReceiver * const ngimuReceiver) {
+    memset(&ngimuReceiver->statistics, 0, sizeof (ngimuReceiver->statistics));
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Functions - Default receiver
 
 /**
  * @brief Initialises module.  This function should be called once on system
  * start up.
  */
 void NgimuReceiveInitialise() {
-    OscSlipDecoderInitialise(&oscSlipDecoder);
-    oscSlipDecoder.processPacket = ProcessPacket;
+    NgimuReceiverInitialise(&defaultReceiver);
+    UpdateDefaultReceiverCallbacks();
 }
 
 /**
@@ -48,277 +739,1581 @@ void NgimuReceiveInitialise() {
  */
 void NgimuReceiveSetReceiveErrorCallback(void (*newReceiveErrorCallback)(const char* const errorMessage)) {
     receiveErrorCallback = newReceiveErrorCallback;
+    UpdateDefaultReceiverCallbacks();
 }
 
+/**
+ * @brief Adds an address to the list of unrecognised addresses that are
+ * discarded without an error.  The string is not copied and must remain valid.
+ * This function must be called after NgimuReceiveInitialise.
+ * @param address Address, e.g. "/battery".
+ * @return True if successful, false if the list is full.
+ */
+bool NgimuReceiveIgnoreAddress(const char * const address) {
+    return NgimuReceiverIgnoreAddress(&defaultReceiver, address);
+}
+
+/**
+ * @brief Sets whether all unrecognised addresses are discarded without an
+ * error.  This function must be called after NgimuReceiveInitialise.
+ * @param ignoreUnrecognisedAddresses True to discard all unrecognised
+ * addresses without an error.
+ */
+void NgimuReceiveSetIgnoreUnrecognisedAddresses(const bool ignoreUnrecognisedAddresses) {
+    NgimuReceiverSetIgnoreUnrecognisedAddresses(&defaultReceiver, ignoreUnrecognisedAddresses);
+}
+
+/**
+ * @brief Sets unrecognised message callback function.  This function must be
+ * called after NgimuReceiveInitialise.
+ * @param newUnrecognisedMessageCallback Unrecognised message callback
+ * function.
+ * @param unrecognisedMessageContext Context passed to the callback function.
+ */
+void NgimuReceiveSetUnrecognisedMessageCallback(bool (*newUnrecognisedMessageCallback)(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage, void * const unrecognisedMessageContext), void * const unrecognisedMessageContext) {
+    NgimuReceiverSetUnrecognisedMessageCallback(&defaultReceiver, newUnrecognisedMessageCallback, unrecognisedMessageContext);
+}
+
+/**
+ * @brief Sets time tag callback function.  This function must be called after
+ * NgimuReceiveInitialise.
+ * @param newTimeTagCallback Time tag callback function.
+ * @param timeTagContext Context passed to the callback function.
+ */
+void NgimuReceiveSetTimeTagCallback(void (*newTimeTagCallback)(const char * const oscAddressPattern, const size_t oscAddressPatternLength, const OscTimeTag * const oscTimeTag, void * const timeTagContext), void * const timeTagContext) {
+    NgimuReceiverSetTimeTagCallback(&defaultReceiver, newTimeTagCallback, timeTagContext);
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
 /**
  * @brief Sets receive "/sensors" callback function.
  * @param newSensorsCallback "/sensors" callback function.
  */
 void NgimuReceiveSetSensorsCallback(void (*newSensorsCallback)(const NgimuSensors ngimuSensors)) {
     sensorsCallback = newSensorsCallback;
+    UpdateDefaultReceiverCallbacks();
 }
+#endif
 
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
 /**
  * @brief Sets receive "/quaternion" callback function.
  * @param newQuaternionCallback "/quaternion" callback function.
  */
 void NgimuReceiveSetQuaternionCallback(void (*newQuaternionCallback)(const NgimuQuaternion ngimuQuaternion)) {
     quaternionCallback = newQuaternionCallback;
+    UpdateDefaultReceiverCallbacks();
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief Sets receive "/euler" callback function.
+ * @param newEulerCallback "/euler" callback function.
+ */
+void NgimuReceiveSetEulerCallback(void (*newEulerCallback)(const NgimuEuler ngimuEuler)) {
+    eulerCallback = newEulerCallback;
+    UpdateDefaultReceiverCallbacks();
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Sets receive "/sensors" pointer callback function.  The callback
+ * receives a pointer to structure owned by this module that is only valid for
+ * the duration of the callback.
+ * @param newSensorsPointerCallback "/sensors" pointer callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuReceiveSetSensorsPointerCallback(void (*newSensorsPointerCallback)(const NgimuSensors * const ngimuSensors, void * const userContext), void * const userContext) {
+    sensorsPointerCallback = newSensorsPointerCallback;
+    sensorsUserContext = userContext;
+    UpdateDefaultReceiverCallbacks();
+}
+
+/**
+ * @brief Sets the "/sensors" fields decoded by the default receiver.  This
+ * function must be called after NgimuReceiveInitialise.  See
+ * NgimuReceiverSetSensorsFields.
+ * @param ngimuSensorsFields "/sensors" fields to be decoded.
+ */
+void NgimuReceiveSetSensorsFields(const unsigned int ngimuSensorsFields) {
+    NgimuReceiverSetSensorsFields(&defaultReceiver, ngimuSensorsFields);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Sets receive "/quaternion" pointer callback function.  The callback
+ * receives a pointer to structure owned by this module that is only valid for
+ * the duration of the callback.
+ * @param newQuaternionPointerCallback "/quaternion" pointer callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuReceiveSetQuaternionPointerCallback(void (*newQuaternionPointerCallback)(const NgimuQuaternion * const ngimuQuaternion, void * const userContext), void * const userContext) {
+    quaternionPointerCallback = newQuaternionPointerCallback;
+    quaternionUserContext = userContext;
+    UpdateDefaultReceiverCallbacks();
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief Sets receive "/euler" pointer callback function.  The callback
+ * receives a pointer to structure owned by this module that is only valid for
+ * the duration of the callback.
+ * @param newEulerPointerCallback "/euler" pointer callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuReceiveSetEulerPointerCallback(void (*newEulerPointerCallback)(const NgimuEuler * const ngimuEuler, void * const userContext), void * const userContext) {
+    eulerPointerCallback = newEulerPointerCallback;
+    eulerUserContext = userContext;
+    UpdateDefaultReceiverCallbacks();
+}
+#endif
+
+/**
+ * @brief Sets bundle callback function.  See NgimuReceiverSetBundleCallback.
+ * @param newBundleCallback Bundle callback function.
+ */
+void NgimuReceiveSetBundleCallback(void (*newBundleCallback)(const NgimuBundle ngimuBundle)) {
+    bundleCallback = newBundleCallback;
+    UpdateDefaultReceiverCallbacks();
+}
+
+/**
+ * @brief Sets bundle pointer callback function.  The callback receives a
+ * pointer to structure owned by this module that is only valid for the
+ * duration of the callback.  See NgimuReceiverSetBundleCallback.
+ * @param newBundlePointerCallback Bundle pointer callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuReceiveSetBundlePointerCallback(void (*newBundlePointerCallback)(const NgimuBundle * const ngimuBundle, void * const userContext), void * const userContext) {
+    bundlePointerCallback = newBundlePointerCallback;
+    bundleUserContext = userContext;
+    UpdateDefaultReceiverCallbacks();
+}
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Sets receive "/sensors" fixed-point callback function.  See
+ * NgimuReceiverSetSensorsQCallback.
+ * @param newSensorsQCallback "/sensors" fixed-point callback function.
+ */
+void NgimuReceiveSetSensorsQCallback(void (*newSensorsQCallback)(const NgimuSensorsQ ngimuSensorsQ)) {
+    sensorsQCallback = newSensorsQCallback;
+    UpdateDefaultReceiverCallbacks();
+}
+
+/**
+ * @brief Sets receive "/sensors" fixed-point pointer callback function.  The
+ * callback receives a pointer to a structure owned by this module that is only
+ * valid for the duration of the callback.
+ * @param newSensorsQPointerCallback "/sensors" fixed-point pointer callback
+ * function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuReceiveSetSensorsQPointerCallback(void (*newSensorsQPointerCallback)(const NgimuSensorsQ * const ngimuSensorsQ, void * const userContext), void * const userContext) {
+    sensorsQPointerCallback = newSensorsQPointerCallback;
+    sensorsQUserContext = userContext;
+    UpdateDefaultReceiverCallbacks();
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Sets receive "/quaternion" fixed-point callback function.  See
+ * NgimuReceiverSetQuaternionQCallback.
+ * @param newQuaternionQCallback "/quaternion" fixed-point callback function.
+ */
+void NgimuReceiveSetQuaternionQCallback(void (*newQuaternionQCallback)(const NgimuQuaternionQ ngimuQuaternionQ)) {
+    quaternionQCallback = newQuaternionQCallback;
+    UpdateDefaultReceiverCallbacks();
+}
+
+/**
+ * @brief Sets receive "/quaternion" fixed-point pointer callback function.
+ * The callback receives a pointer to a structure owned by this module that is
+ * only valid for the duration of the callback.
+ * @param newQuaternionQPointerCallback "/quaternion" fixed-point pointer
+ * callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuReceiveSetQuaternionQPointerCallback(void (*newQuaternionQPointerCallback)(const NgimuQuaternionQ * const ngimuQuaternionQ, void * const userContext), void * const userContext) {
+    quaternionQPointerCallback = newQuaternionQPointerCallback;
+    quaternionQUserContext = userContext;
+    UpdateDefaultReceiverCallbacks();
+}
+#endif
+
+/**
+ * @brief Sets column buffers that decoded messages are written to instead of
+ * being passed to the message callbacks.  This function must be called after
+ * NgimuReceiveInitialise.
+ * @param ngimuColumns Address of columns structure, or NULL to use the message
+ * callbacks.
+ */
+void NgimuReceiveSetColumns(NgimuColumns * const ngimuColumns) {
+    NgimuReceiverSetColumns(&defaultReceiver, ngimuColumns);
+}
+
+/**
+ * @brief Process byte received from NGIMU via a serial communication channel.
+ * This function should be called for each byte receive within a serial stream.
+ * @param byte Serial byte
+ */
+void NgimuReceiveProcessSerialByte(const char byte) {
+    NgimuReceiverProcessSerialByte(&defaultReceiver, byte);
+}
+
+/**
+ * @brief Process block of bytes received from NGIMU via a serial communication
+ * channel, e.g. a DMA buffer.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ */
+void NgimuReceiveProcessSerialBytes(const char * const source, const size_t sourceSize) {
+    NgimuReceiverProcessSerialBytes(&defaultReceiver, source, sourceSize);
+}
+
+/**
+ * @brief Process block of bytes received from NGIMU via a serial communication
+ * channel by decoding the SLIP encoding in place.  See
+ * NgimuReceiverProcessSerialBytesInPlace.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ */
+void NgimuReceiveProcessSerialBytesInPlace(char * const source, const size_t sourceSize) {
+    NgimuReceiverProcessSerialBytesInPlace(&defaultReceiver, source, sourceSize);
+}
+
+/**
+ * @brief Process UDP packet received from NGIMU via Wi-Fi.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ */
+void NgimuReceiveProcessUdpPacket(const char * const source, const size_t sourceSize) {
+    NgimuReceiverProcessUdpPacket(&defaultReceiver, source, sourceSize);
+}
+
+/**
+ * @brief Process a batch of UDP packets received from NGIMUs via Wi-Fi.
+ * Packets are processed in order.
+ * @param packets Array of UDP packet descriptors.
+ * @param numberOfPackets Number of packets.
+ */
+void NgimuReceiveProcessUdpPackets(const NgimuUdpPacket * const packets, const size_t numberOfPackets) {
+    NgimuReceiverProcessUdpPackets(&defaultReceiver, packets, numberOfPackets);
+}
+
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+/**
+ * @brief Sets capture callback function.  This function must be called after
+ * NgimuReceiveInitialise.
+ * @param newCaptureCallback Capture callback function.
+ * @param captureContext Context passed to the callback function.
+ */
+void NgimuReceiveSetCaptureCallback(void (*newCaptureCallback)(const NgimuReceiveTransport transport, const char * const source, const size_t sourceSize, void * const captureContext), void * const captureContext) {
+    NgimuReceiverSetCaptureCallback(&defaultReceiver, newCaptureCallback, captureContext);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+/**
+ * @brief Sets whether Euler angles are derived from each "/quaternion" message
+ * and provided through the "/euler" callbacks.  This function must be called
+ * after NgimuReceiveInitialise.
+ * @param deriveEuler True to derive Euler angles.
+ * @param derivedAccuracy Accuracy of the derived Euler angles.
+ */
+void NgimuReceiveSetDerivedEuler(const bool deriveEuler, const NgimuDerivedAccuracy derivedAccuracy) {
+    NgimuReceiverSetDerivedEuler(&defaultReceiver, deriveEuler, derivedAccuracy);
+}
+
+/**
+ * @brief Sets rotation matrix callback function.  The callback is called with
+ * a rotation matrix derived from each "/quaternion" message.
+ * @param newRotationMatrixCallback Rotation matrix callback function.
+ */
+void NgimuReceiveSetRotationMatrixCallback(void (*newRotationMatrixCallback)(const NgimuRotationMatrix ngimuRotationMatrix)) {
+    rotationMatrixCallback = newRotationMatrixCallback;
+    UpdateDefaultReceiverCallbacks();
+}
+
+/**
+ * @brief Sets rotation matrix pointer callback function.  The callback
+ * receives a pointer to structure owned by this module that is only valid for
+ * the duration of the callback.
+ * @param newRotationMatrixPointerCallback Rotation matrix pointer callback
+ * function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuReceiveSetRotationMatrixPointerCallback(void (*newRotationMatrixPointerCallback)(const NgimuRotationMatrix * const ngimuRotationMatrix, void * const userContext), void * const userContext) {
+    rotationMatrixPointerCallback = newRotationMatrixPointerCallback;
+    rotationMatrixUserContext = userContext;
+    UpdateDefaultReceiverCallbacks();
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_STATISTICS
+/**
+ * @brief Gets module statistics.
+ * @param ngimuReceiveStatistics Address of statistics structure to be written.
+ */
+void NgimuReceiveGetStatistics(NgimuReceiveStatistics * const ngimuReceiveStatistics) {
+    NgimuReceiverGetStatistics(&defaultReceiver, ngimuReceiveStatistics);
+}
+
+/**
+ * @brief Resets module statistics.
+ */
+void NgimuReceiveResetStatistics() {
+    NgimuReceiverResetStatistics(&defaultReceiver);
+}
+#endif
+
+/**
+ * @brief Empties the column buffers, e.g. after the application has processed
+ * the contents.  The number of discarded messages is also reset.
+ * @param ngimuColumns Address of columns structure.
+ */
+void NgimuColumnsClear(NgimuColumns * const ngimuColumns) {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    ngimuColumns->sensors.count = 0;
+    ngimuColumns->sensors.numberOfDiscarded = 0;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    ngimuColumns->quaternion.count = 0;
+    ngimuColumns->quaternion.numberOfDiscarded = 0;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    ngimuColumns->euler.count = 0;
+    ngimuColumns->euler.numberOfDiscarded = 0;
+#endif
+}
+
+/**
+ * @brief Writes the error message of a receive error to a string.  The string
+ * is truncated if the destination is too small.
+ * @param ngimuReceiveError Address of receive error structure.
+ * @param destination Destination string.
+ * @param destinationSize Destination size.
+ * @return Length of the string written, not including the terminating null
+ * character.
+ */
+size_t NgimuReceiveErrorToString(const NgimuReceiveError * const ngimuReceiveError, char * const destination, const size_t destinationSize) {
+    if (destinationSize == 0) {
+        return 0;
+    }
+    size_t index = 0;
+    switch (ngimuReceiveError->code) {
+        case NgimuReceiveErrorCodeOsc:
+            index = AppendString(destination, destinationSize, index, OscErrorGetMessage(ngimuReceiveError->oscError));
+            break;
+        case NgimuReceiveErrorCodeAddressNotRecognised:
+            index = AppendString(destination, destinationSize, index, "OSC address pattern not recognised: ");
+            index = AppendString(destination, destinationSize, index, ngimuReceiveError->oscAddressPattern);
+            break;
+        case NgimuReceiveErrorCodeBundleTooDeep:
+            index = AppendString(destination, destinationSize, index, "OSC bundles nested too deeply");
+            break;
+        case NgimuReceiveErrorCodeTooManyMessages:
+            index = AppendString(destination, destinationSize, index, "Too many OSC messages in packet");
+            break;
+    }
+    destination[index] = '\0';
+    return index;
+}
+
+/**
+ * @brief Assigns the default receiver callbacks that forward to the module
+ * callbacks.  A default receiver callback is only assigned if a corresponding
+ * module callback is assigned so that unused messages are not decoded.
+ */
+static void UpdateDefaultReceiverCallbacks() {
+    defaultReceiver.receiveErrorCallback = (receiveErrorCallback != NULL) ? DefaultReceiveErrorCallback : NULL;
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    defaultReceiver.sensorsCallback = ((sensorsCallback != NULL) || (sensorsPointerCallback != NULL)) ? DefaultSensorsCallback : NULL;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    defaultReceiver.quaternionCallback = ((quaternionCallback != NULL) || (quaternionPointerCallback != NULL)) ? DefaultQuaternionCallback : NULL;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    defaultReceiver.eulerCallback = ((eulerCallback != NULL) || (eulerPointerCallback != NULL)) ? DefaultEulerCallback : NULL;
+#endif
+    defaultReceiver.bundleCallback = ((bundleCallback != NULL) || (bundlePointerCallback != NULL)) ? DefaultBundleCallback : NULL;
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+    defaultReceiver.sensorsQCallback = ((sensorsQCallback != NULL) || (sensorsQPointerCallback != NULL)) ? DefaultSensorsQCallback : NULL;
+#endif
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+    defaultReceiver.quaternionQCallback = ((quaternionQCallback != NULL) || (quaternionQPointerCallback != NULL)) ? DefaultQuaternionQCallback : NULL;
+#endif
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+    defaultReceiver.rotationMatrixCallback = ((rotationMatrixCallback != NULL) || (rotationMatrixPointerCallback != NULL)) ? DefaultRotationMatrixCallback : NULL;
+#endif
+}
+
+/**
+ * @brief Default receiver error callback.  Formats the error message for the
+ * module receive error callback.
+ * @param ngimuReceiveError Address of receive error structure.
+ * @param userContext Unused.
+ */
+static void DefaultReceiveErrorCallback(const NgimuReceiveError * const ngimuReceiveError, void * const userContext) {
+    if (receiveErrorCallback != NULL) {
+        char string[64 + MAX_OSC_ADDRESS_PATTERN_LENGTH];
+        NgimuReceiveErrorToString(ngimuReceiveError, string, sizeof (string));
+        receiveErrorCallback(string);
+    }
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Default receiver "/sensors" callback.
+ * @param ngimuSensors Address of "/sensors" structure.
+ * @param userContext Unused.
+ */
+static void DefaultSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+    if (sensorsPointerCallback != NULL) {
+        sensorsPointerCallback(ngimuSensors, sensorsUserContext);
+    }
+    if (sensorsCallback != NULL) {
+        sensorsCallback(*ngimuSensors);
+    }
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Default receiver "/quaternion" callback.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ * @param userContext Unused.
+ */
+static void DefaultQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+    if (quaternionPointerCallback != NULL) {
+        quaternionPointerCallback(ngimuQuaternion, quaternionUserContext);
+    }
+    if (quaternionCallback != NULL) {
+        quaternionCallback(*ngimuQuaternion);
+    }
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief Default receiver "/euler" callback.
+ * @param ngimuEuler Address of "/euler" structure.
+ * @param userContext Unused.
+ */
+static void DefaultEulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+    if (eulerPointerCallback != NULL) {
+        eulerPointerCallback(ngimuEuler, eulerUserContext);
+    }
+    if (eulerCallback != NULL) {
+        eulerCallback(*ngimuEuler);
+    }
+}
+#endif
+
+/**
+ * @brief Default receiver bundle callback.
+ * @param ngimuBundle Address of bundle structure.
+ * @param userContext Unused.
+ */
+static void DefaultBundleCallback(const NgimuBundle * const ngimuBundle, void * const userContext) {
+    if (bundlePointerCallback != NULL) {
+        bundlePointerCallback(ngimuBundle, bundleUserContext);
+    }
+    if (bundleCallback != NULL) {
+        bundleCallback(*ngimuBundle);
+    }
+}
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Default receiver "/sensors" fixed-point callback.
+ * @param ngimuSensorsQ Address of "/sensors" fixed-point structure.
+ * @param userContext Unused.
+ */
+static void DefaultSensorsQCallback(const NgimuSensorsQ * const ngimuSensorsQ, void * const userContext) {
+    if (sensorsQPointerCallback != NULL) {
+        sensorsQPointerCallback(ngimuSensorsQ, sensorsQUserContext);
+    }
+    if (sensorsQCallback != NULL) {
+        sensorsQCallback(*ngimuSensorsQ);
+    }
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Default receiver "/quaternion" fixed-point callback.
+ * @param ngimuQuaternionQ Address of "/quaternion" fixed-point structure.
+ * @param userContext Unused.
+ */
+static void DefaultQuaternionQCallback(const NgimuQuaternionQ * const ngimuQuaternionQ, void * const userContext) {
+    if (quaternionQPointerCallback != NULL) {
+        quaternionQPointerCallback(ngimuQuaternionQ, quaternionQUserContext);
+    }
+    if (quaternionQCallback != NULL) {
+        quaternionQCallback(*ngimuQuaternionQ);
+    }
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+/**
+ * @brief Default receiver rotation matrix callback.
+ * @param ngimuRotationMatrix Address of rotation matrix structure.
+ * @param userContext Unused.
+ */
+static void DefaultRotationMatrixCallback(const NgimuRotationMatrix * const ngimuRotationMatrix, void * const userContext) {
+    if (rotationMatrixPointerCallback != NULL) {
+        rotationMatrixPointerCallback(ngimuRotationMatrix, rotationMatrixUserContext);
+    }
+    if (rotationMatrixCallback != NULL) {
+        rotationMatrixCallback(*ngimuRotationMatrix);
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Functions - Decoding
+
+/**
+ * @brief Decodes block of SLIP stream.  Runs of bytes without SLIP special
+ * characters are copied to the SLIP decoder buffer in bulk.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ */
+static void DecodeSerialBytes(NgimuReceiver * const ngimuReceiver, const char * const source, const size_t sourceSize) {
+    size_t index = 0;
+    while (index < sourceSize) {
+
+        // Skip to end of invalid packet
+        if (ngimuReceiver->slipDiscard == true) {
+            const char * const end = memchr(&source[index], SLIP_END, sourceSize - index);
+            if (end == NULL) {
+                return;
+            }
+            index = (size_t) (end - source);
+        }
+
+        // Copy run of plain bytes
+        else if (ngimuReceiver->slipEscape == false) {
+            const size_t runLength = FindSlipSpecialCharacter(&source[index], sourceSize - index);
+            if (runLength > (sizeof (ngimuReceiver->slipBuffer) - ngimuReceiver->slipBufferIndex)) {
+                ngimuReceiver->slipDiscard = true;
+                STATISTICS_ADD(ngimuReceiver, numberOfSlipErrors, 1);
+                ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorDecodedSlipPacketTooLong, NULL);
+                continue;
+            }
+            memcpy(&ngimuReceiver->slipBuffer[ngimuReceiver->slipBufferIndex], &source[index], runLength);
+            ngimuReceiver->slipBufferIndex += runLength;
+            index += runLength;
+            if (index >= sourceSize) {
+                return;
+            }
+        }
+
+        // Process SLIP special character or escaped byte
+        DecodeSerialByte(ngimuReceiver, source[index++]);
+    }
+}
+
+/**
+ * @brief Decodes byte of SLIP stream.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param byte Serial byte
+ */
+static void DecodeSerialByte(NgimuReceiver * const ngimuReceiver, const char byte) {
+
+    // Process packet on SLIP END
+
+    if (byte == SLIP_END) {
+        if ((ngimuReceiver->slipDiscard == false) && (ngimuReceiver->slipBufferIndex > 0)) {
+            ProcessPacket(ngimuReceiver, ngimuReceiver->slipBuffer, ngimuReceiver->slipBufferIndex);
+        }
+        ngimuReceiver->slipBufferIndex = 0;
+        ngimuReceiver->slipEscape = false;
+        ngimuReceiver->slipDiscard = false;
+        return;
+    }
+
+    // Discard remainder of invalid packet
+    if (ngimuReceiver->slipDiscard == true) {
+        return;
+    }
+
+    // Decode escape sequence
+    char decodedByte = byte;
+    if (ngimuReceiver->slipEscape == true) {
+        ngimuReceiver->slipEscape = false;
+        if (byte == SLIP_ESC_END) {
+            decodedByte = SLIP_END;
+        } else if (byte == SLIP_ESC_ESC) {
+            decodedByte = SLIP_ESC;
+        } else {
+            ngimuReceiver->slipDiscard = true;
+            STATISTICS_ADD(ngimuReceiver, numberOfSlipErrors, 1);
+            ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorUnexpectedByteAfterSlipEsc, NULL);
+            return;
+        }
+    } else if (byte == SLIP_ESC) {
+        ngimuReceiver->slipEscape = true;
+        return;
+    }
+
+    // Add byte to buffer
+    if (ngimuReceiver->slipBufferIndex >= sizeof (ngimuReceiver->slipBuffer)) {
+        ngimuReceiver->slipDiscard = true;
+        STATISTICS_ADD(ngimuReceiver, numberOfSlipErrors, 1);
+        ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorDecodedSlipPacketTooLong, NULL);
+        return;
+    }
+    ngimuReceiver->slipBuffer[ngimuReceiver->slipBufferIndex++] = decodedByte;
+}
+
+/**
+ * @brief Copies the packet that is incomplete in the source of
+ * NgimuReceiverProcessSerialBytesInPlace to the SLIP decoder buffer so that it
+ * may be completed from a source that is not contiguous.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+static void SpillInPlacePacket(NgimuReceiver * const ngimuReceiver) {
+    if (ngimuReceiver->slipBufferIndex > sizeof (ngimuReceiver->slipBuffer)) {
+        ngimuReceiver->slipBufferIndex = 0;
+        ngimuReceiver->slipDiscard = true;
+        STATISTICS_ADD(ngimuReceiver, numberOfSlipErrors, 1);
+        ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorDecodedSlipPacketTooLong, NULL);
+    } else {
+        memcpy(ngimuReceiver->slipBuffer, ngimuReceiver->slipInPlace, ngimuReceiver->slipBufferIndex);
+    }
+    ngimuReceiver->slipInPlace = NULL;
 }
 
 /**
- * @brief Sets receive "/euler" callback function.
- * @param newEulerCallback "/euler" callback function.
+ * @brief Finds the first SLIP END or ESC character.  The source is scanned a
+ * word at a time.
+ * @param source Address of source byte array.
+ * @param sourceSize Source size.
+ * @return Index of the first SLIP END or ESC character, or the source size if
+ * there is none.
  */
-void NgimuReceiveSetEulerCallback(void (*newEulerCallback)(const NgimuEuler ngimuEuler)) {
-    eulerCallback = newEulerCallback;
+static size_t FindSlipSpecialCharacter(const char * const source, const size_t sourceSize) {
+    size_t index = 0;
+    for (; (index + sizeof (size_t)) <= sourceSize; index += sizeof (size_t)) {
+        size_t word;
+        memcpy(&word, &source[index], sizeof (word));
+        if ((HAS_ZERO_BYTE(word ^ REPEAT_BYTE(SLIP_END)) | HAS_ZERO_BYTE(word ^ REPEAT_BYTE(SLIP_ESC))) != 0) {
+            break;
+        }
+    }
+    for (; index < sourceSize; index++) {
+        if ((source[index] == SLIP_END) || (source[index] == SLIP_ESC)) {
+            break;
+        }
+    }
+    return index;
 }
 
 /**
- * @brief Process byte received from NGIMU via a serial communication channel.
- * This function should be called for each byte receive within a serial stream.
- * @param byte Serial byte
+ * @brief Process OSC packet received by the SLIP decoder or via UDP.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param contents OSC packet contents.
+ * @param contentsSize Contents size.
  */
-void NgimuReceiveProcessSerialByte(const char byte) {
-    OscSlipDecoderProcessByte(&oscSlipDecoder, byte);
+static void ProcessPacket(NgimuReceiver * const ngimuReceiver, const char * const contents, const size_t contentsSize) {
+    STATISTICS_ADD(ngimuReceiver, numberOfPackets, 1);
+
+    // Reject packet before processing any message
+    if (contentsSize > NGIMU_RECEIVE_MAX_PACKET_SIZE) {
+        ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorPacketSizeTooLarge, NULL);
+        return;
+    }
+    size_t numberOfMessages = 0;
+    if (CheckContents(ngimuReceiver, contents, contentsSize, 0, &numberOfMessages) == false) {
+        return;
+    }
+
+    // Process packet
+    const OscError oscError = ProcessContents(ngimuReceiver, &immediateTimeTag, contents, contentsSize);
+    if (oscError != OscErrorNone) {
+        ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, oscError, NULL);
+    }
+    if (ngimuReceiver->bundleCallback != NULL) {
+        DeliverBundle(ngimuReceiver);
+    }
 }
 
 /**
- * @brief Process UDP packet received from NGIMU via Wi-Fi.
- * @param source Address of source byte array.
- * @param sourceSize Source size.
+ * @brief Checks the size of OSC contents and of each bundle element, the
+ * bundle depth and the number of messages, without parsing messages.  OSC
+ * bundles are checked recursively.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param contents OSC contents.
+ * @param contentsSize Contents size.
+ * @param depth Number of enclosing bundles.
+ * @param numberOfMessages Number of messages found so far in the packet.
+ * @return True if the contents may be processed.
  */
-void NgimuReceiveProcessUdpPacket(const char * const source, const size_t sourceSize) {
-    OscPacket oscPacket;
-    OscPacketInitialiseFromCharArray(&oscPacket, source, sourceSize);
-    oscPacket.processMessage = &ProcessMessage;
-    OscPacketProcessMessages(&oscPacket);
+static bool CheckContents(NgimuReceiver * const ngimuReceiver, const char * const contents, const size_t contentsSize, const unsigned int depth, size_t * const numberOfMessages) {
+
+    // Check contents size
+    if (contentsSize == 0) {
+        ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorContentsEmpty, NULL);
+        return false;
+    }
+    if ((contentsSize % 4) != 0) {
+        ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorSizeIsNotMultipleOfFour, NULL);
+        return false;
+    }
+
+    // Count message
+    if (contents[0] == '/') {
+        (*numberOfMessages)++;
+        if (*numberOfMessages > NGIMU_RECEIVE_MAX_MESSAGES_PER_PACKET) {
+            ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeTooManyMessages, OscErrorNone, NULL);
+            return false;
+        }
+        return true;
+    }
+
+    // Check bundle header and depth
+    if ((contentsSize < MIN_OSC_BUNDLE_SIZE) || (memcmp(contents, OSC_BUNDLE_HEADER, sizeof (OSC_BUNDLE_HEADER)) != 0)) {
+        ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorNoHashAtStartOfBundle, NULL);
+        return false;
+    }
+    if (depth >= NGIMU_RECEIVE_MAX_BUNDLE_DEPTH) {
+        ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeBundleTooDeep, OscErrorNone, NULL);
+        return false;
+    }
+
+    // Check each bundle element
+    size_t index = MIN_OSC_BUNDLE_SIZE;
+    while (index < contentsSize) {
+        if ((contentsSize - index) < 4) {
+            ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorUnexpectedEndOfSource, NULL);
+            return false;
+        }
+        const uint32_t elementSize = ReadBigEndian32(&contents[index]);
+        index += 4;
+        if (elementSize > (contentsSize - index)) {
+            ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, OscErrorUnexpectedEndOfSource, NULL);
+            return false;
+        }
+        if (CheckContents(ngimuReceiver, &contents[index], elementSize, depth + 1, numberOfMessages) == false) {
+            return false;
+        }
+        index += elementSize;
+    }
+    return true;
 }
 
 /**
- * @brief Callback function executed for each OSC packet received by a SLIP
- * decoder.
- * @param oscPacket Address of the decoded OSC packet.
+ * @brief Process OSC contents.  OSC bundles are processed recursively.  The
+ * contents must have been checked by CheckContents.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param oscTimeTag OSC time tag of the enclosing bundle.
+ * @param contents OSC contents.
+ * @param contentsSize Contents size.
+ * @return Error code (0 if successful).
  */
-static void ProcessPacket(OscPacket * const oscPacket) {
-    oscPacket->processMessage = &ProcessMessage;
-    OscError oscError = OscPacketProcessMessages(oscPacket);
-    if ((oscError != OscErrorNone) && (receiveErrorCallback != NULL)) {
-        receiveErrorCallback(OscErrorGetMessage(oscError));
+static OscError ProcessContents(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, const char * const contents, const size_t contentsSize) {
+
+    // Process message
+    if (contents[0] == '/') {
+        STATISTICS_START_DECODE(ngimuReceiver);
+        OscMessage oscMessage;
+        const OscError oscError = OscMessageInitialiseFromCharArray(&oscMessage, contents, contentsSize);
+        if (oscError != OscErrorNone) {
+            return oscError;
+        }
+        ProcessMessage(ngimuReceiver, oscTimeTag, &oscMessage);
+        return OscErrorNone;
+    }
+
+    // Get bundle time tag
+    OscTimeTag bundleTimeTag;
+    bundleTimeTag.value = ((uint64_t) ReadBigEndian32(&contents[sizeof (OSC_BUNDLE_HEADER)]) << 32) | ReadBigEndian32(&contents[sizeof (OSC_BUNDLE_HEADER) + 4]);
+
+    // Process each bundle element
+    size_t index = MIN_OSC_BUNDLE_SIZE;
+    while (index < contentsSize) {
+        const uint32_t elementSize = ReadBigEndian32(&contents[index]);
+        index += 4;
+        const OscError oscError = ProcessContents(ngimuReceiver, &bundleTimeTag, &contents[index], elementSize);
+        if (oscError != OscErrorNone) {
+            return oscError;
+        }
+        index += elementSize;
     }
+    return OscErrorNone;
 }
 
 /**
- * @brief Callback function executed for each message found within received OSC
- * packet.
+ * @brief Process message found within received OSC packet.
+ * @param ngimuReceiver Address of receiver structure.
  * @param oscTimeTag OSC time tag associated with message.
  * @param oscMessage Address of OSC message.
  */
-static void ProcessMessage(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
-    const OscError oscError = ProcessAddress(oscTimeTag, oscMessage);
-    if ((oscError != OscErrorNone) && (receiveErrorCallback != NULL)) {
-        receiveErrorCallback(OscErrorGetMessage(oscError));
+static void ProcessMessage(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+    const OscError oscError = ProcessAddress(ngimuReceiver, oscTimeTag, oscMessage);
+    if (oscError != OscErrorNone) {
+        ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeOsc, oscError, oscMessage->oscAddressPattern);
     }
 }
 
 /**
  * @brief Process OSC message according to OSC address pattern.
+ * @param ngimuReceiver Address of receiver structure.
  * @param oscTimeTag OSC time tag associated with message.
  * @param oscMessage Address of OSC message.
  * @return Error code (0 if successful).
  */
-static OscError ProcessAddress(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+static OscError ProcessAddress(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
 
-    // Process known message types
-    if (OscAddressMatch(oscMessage->oscAddressPattern, "/sensors")) {
-        return ProcessSensors(oscTimeTag, oscMessage);
-    }
-    if (OscAddressMatch(oscMessage->oscAddressPattern, "/quaternion")) {
-        return ProcessQuaternion(oscTimeTag, oscMessage);
+    // Time tag callback
+    if (ngimuReceiver->timeTagCallback != NULL) {
+        ngimuReceiver->timeTagCallback(oscMessage->oscAddressPattern, oscMessage->oscAddressPatternLength, oscTimeTag, ngimuReceiver->timeTagContext);
     }
-    if (OscAddressMatch(oscMessage->oscAddressPattern, "/euler")) {
-        return ProcessEuler(oscTimeTag, oscMessage);
+
+    // Process known message types
+    const size_t addressLength = oscMessage->oscAddressPatternLength;
+    const char secondCharacter = oscMessage->oscAddressPattern[1];
+    size_t index;
+    for (index = 0; index < ADDRESS_TABLE_LENGTH; index++) {
+        const AddressTableEntry * const entry = &addressTable[index];
+
+        // Reject on length and first character after '/' before comparing
+        if ((entry->addressLength != addressLength) || (entry->address[1] != secondCharacter)) {
+            continue;
+        }
+        if (memcmp(entry->address, oscMessage->oscAddressPattern, addressLength) != 0) {
+            continue;
+        }
+
+        // Reject message if there are not enough arguments
+        if ((oscMessage->oscTypeTagStringLength - 1) < entry->argumentCount) {
+            return OscErrorNoArgumentsAvailable;
+        }
+        return entry->process(ngimuReceiver, oscTimeTag, oscMessage);
     }
 
     // OSC address not recognised
-    if (receiveErrorCallback != NULL) {
-        static char string[256];
-        snprintf(string, sizeof (string), "OSC address pattern not recognised: %s", oscMessage->oscAddressPattern);
-        receiveErrorCallback(string);
+    STATISTICS_ADD(ngimuReceiver, numberOfUnrecognisedAddresses, 1);
+    if ((ngimuReceiver->unrecognisedMessageCallback != NULL) && ngimuReceiver->unrecognisedMessageCallback(oscTimeTag, oscMessage, ngimuReceiver->unrecognisedMessageContext)) {
+        return OscErrorNone;
+    }
+    if (IsAddressIgnored(ngimuReceiver, oscMessage) == false) {
+        ReceiveError(ngimuReceiver, NgimuReceiveErrorCodeAddressNotRecognised, OscErrorNone, oscMessage->oscAddressPattern);
     }
     return OscErrorNone;
 }
 
+#if NGIMU_RECEIVE_ENABLE_SENSORS
 /**
  * @brief Process "/sensors" message.
+ * @param ngimuReceiver Address of receiver structure.
  * @param oscTimeTag OSC time tag associated with message.
  * @param oscMessage Address of OSC message.
  * @return Error code (0 if successful).
  */
-static OscError ProcessSensors(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+static OscError ProcessSensors(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+    STATISTICS_ADD(ngimuReceiver, numberOfSensorsMessages, 1);
+
+    // Write to columns if assigned
+    if (ngimuReceiver->ngimuColumns != NULL) {
+        return WriteSensorsColumns(ngimuReceiver, &ngimuReceiver->ngimuColumns->sensors, oscTimeTag, oscMessage);
+    }
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT
+    // Decode to fixed-point if callback assigned
+    if (ngimuReceiver->sensorsQCallback != NULL) {
+        return ProcessSensorsQ(ngimuReceiver, oscTimeTag, oscMessage);
+    }
+#endif
 
     // Do nothing if no callback assigned
-    if (sensorsCallback == NULL) {
+    if ((ngimuReceiver->sensorsCallback == NULL) && (ngimuReceiver->bundleCallback == NULL)) {
         return OscErrorNone;
     }
 
     // Get timestamp
-    NgimuSensors ngimuSensors;
-    ngimuSensors.timestamp = *oscTimeTag;
+    NgimuSensors * const ngimuSensors = (ngimuReceiver->bundleCallback == NULL) ? &ngimuReceiver->ngimuSensors : &PrepareBundle(ngimuReceiver, NgimuBundleContentsSensors, oscTimeTag)->sensors;
+    ngimuSensors->timestamp = *oscTimeTag;
 
-    // Get gyroscope X axis
-    OscError oscError;
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuSensors.gyroscopeX);
+    // Get arguments
+    const OscError oscError = GetSelectedArgumentsAsFloat32Array(oscMessage, FLOAT32_MEMBERS(ngimuSensors, NgimuSensors, gyroscopeX), 10, ngimuReceiver->sensorsSkippedArguments);
     if (oscError != OscErrorNone) {
         return oscError;
     }
 
-    // Get gyroscope Y axis
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuSensors.gyroscopeY);
-    if (oscError != OscErrorNone) {
-        return oscError;
+    // Callback
+    STATISTICS_END_DECODE(ngimuReceiver);
+    if (ngimuReceiver->bundleCallback != NULL) {
+        ngimuReceiver->ngimuBundle.contents |= NgimuBundleContentsSensors;
+        return OscErrorNone;
     }
+    ngimuReceiver->sensorsCallback(ngimuSensors, ngimuReceiver->userContext);
+    return OscErrorNone;
+}
+#endif
 
-    // Get gyroscope Z axis
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuSensors.gyroscopeZ);
-    if (oscError != OscErrorNone) {
-        return oscError;
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Process "/quaternion" message.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param oscTimeTag OSC time tag associated with message.
+ * @param oscMessage Address of OSC message.
+ * @return Error code (0 if successful).
+ */
+static OscError ProcessQuaternion(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+    STATISTICS_ADD(ngimuReceiver, numberOfQuaternionMessages, 1);
+
+    // Write to columns if assigned
+    if (ngimuReceiver->ngimuColumns != NULL) {
+        return WriteQuaternionColumns(ngimuReceiver, &ngimuReceiver->ngimuColumns->quaternion, oscTimeTag, oscMessage);
     }
 
-    // Get accelerometer X axis
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuSensors.accelerometerX);
-    if (oscError != OscErrorNone) {
-        return oscError;
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT
+    // Decode to fixed-point if callback assigned
+    if (ngimuReceiver->quaternionQCallback != NULL) {
+        return ProcessQuaternionQ(ngimuReceiver, oscTimeTag, oscMessage);
     }
+#endif
 
-    // Get accelerometer Y axis
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuSensors.accelerometerY);
-    if (oscError != OscErrorNone) {
-        return oscError;
+    // Do nothing if no callback assigned
+    if ((ngimuReceiver->quaternionCallback == NULL) && (ngimuReceiver->bundleCallback == NULL) && (DERIVED_OUTPUT_REQUIRED(ngimuReceiver) == false)) {
+        return OscErrorNone;
     }
 
-    // Get accelerometer Z axis
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuSensors.accelerometerZ);
+    // Get timestamp
+    NgimuQuaternion * const ngimuQuaternion = (ngimuReceiver->bundleCallback == NULL) ? &ngimuReceiver->ngimuQuaternion : &PrepareBundle(ngimuReceiver, NgimuBundleContentsQuaternion, oscTimeTag)->quaternion;
+    ngimuQuaternion->timestamp = *oscTimeTag;
+
+    // Get arguments
+    const OscError oscError = GetArgumentsAsFloat32Array(oscMessage, FLOAT32_MEMBERS(ngimuQuaternion, NgimuQuaternion, w), 4);
     if (oscError != OscErrorNone) {
         return oscError;
     }
 
-    // Get magnetometer X axis
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuSensors.magnetometerX);
-    if (oscError != OscErrorNone) {
-        return oscError;
+    // Callback
+    STATISTICS_END_DECODE(ngimuReceiver);
+    if (ngimuReceiver->bundleCallback != NULL) {
+        ngimuReceiver->ngimuBundle.contents |= NgimuBundleContentsQuaternion;
+    } else if (ngimuReceiver->quaternionCallback != NULL) {
+        ngimuReceiver->quaternionCallback(ngimuQuaternion, ngimuReceiver->userContext);
+    }
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+    ProcessDerivedOutputs(ngimuReceiver, ngimuQuaternion);
+#endif
+    return OscErrorNone;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief Process "/euler" message.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param oscTimeTag OSC time tag associated with message.
+ * @param oscMessage Address of OSC message.
+ * @return Error code (0 if successful).
+ */
+static OscError ProcessEuler(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+    STATISTICS_ADD(ngimuReceiver, numberOfEulerMessages, 1);
+
+    // Write to columns if assigned
+    if (ngimuReceiver->ngimuColumns != NULL) {
+        return WriteEulerColumns(ngimuReceiver, &ngimuReceiver->ngimuColumns->euler, oscTimeTag, oscMessage);
+    }
+
+    // Do nothing if no callback assigned
+    if ((ngimuReceiver->eulerCallback == NULL) && (ngimuReceiver->bundleCallback == NULL)) {
+        return OscErrorNone;
     }
 
-    // Get magnetometer Y axis
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuSensors.magnetometerY);
+    // Get timestamp
+    NgimuEuler * const ngimuEuler = (ngimuReceiver->bundleCallback == NULL) ? &ngimuReceiver->ngimuEuler : &PrepareBundle(ngimuReceiver, NgimuBundleContentsEuler, oscTimeTag)->euler;
+    ngimuEuler->timestamp = *oscTimeTag;
+
+    // Get arguments
+    const OscError oscError = GetArgumentsAsFloat32Array(oscMessage, FLOAT32_MEMBERS(ngimuEuler, NgimuEuler, roll), 3);
     if (oscError != OscErrorNone) {
         return oscError;
     }
 
-    // Get magnetometer Z axis
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuSensors.magnetometerZ);
+    // Callback
+    STATISTICS_END_DECODE(ngimuReceiver);
+    if (ngimuReceiver->bundleCallback != NULL) {
+        ngimuReceiver->ngimuBundle.contents |= NgimuBundleContentsEuler;
+        return OscErrorNone;
+    }
+    ngimuReceiver->eulerCallback(ngimuEuler, ngimuReceiver->userContext);
+    return OscErrorNone;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+/**
+ * @brief Derives Euler angles and a rotation matrix from a "/quaternion"
+ * message and passes them to the assigned callbacks.  Derived Euler angles are
+ * processed as if an "/euler" message was received so that a bundle that
+ * already contains an "/euler" message is provided before the derived Euler
+ * angles are written.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ */
+static void ProcessDerivedOutputs(NgimuReceiver * const ngimuReceiver, const NgimuQuaternion * const ngimuQuaternion) {
+#if NGIMU_RECEIVE_ENABLE_EULER
+    if (ngimuReceiver->deriveEuler && (ngimuReceiver->bundleCallback != NULL)) {
+        const OscTimeTag timestamp = ngimuQuaternion->timestamp;
+        NgimuDeriveEuler(ngimuQuaternion, &PrepareBundle(ngimuReceiver, NgimuBundleContentsEuler, &timestamp)->euler, ngimuReceiver->derivedAccuracy);
+        ngimuReceiver->ngimuBundle.contents |= NgimuBundleContentsEuler;
+    } else if (ngimuReceiver->deriveEuler && (ngimuReceiver->eulerCallback != NULL)) {
+        NgimuDeriveEuler(ngimuQuaternion, &ngimuReceiver->ngimuEuler, ngimuReceiver->derivedAccuracy);
+        ngimuReceiver->eulerCallback(&ngimuReceiver->ngimuEuler, ngimuReceiver->userContext);
+    }
+#endif
+    if (ngimuReceiver->rotationMatrixCallback != NULL) {
+        NgimuDeriveRotationMatrix(ngimuQuaternion, &ngimuReceiver->ngimuRotationMatrix);
+        ngimuReceiver->rotationMatrixCallback(&ngimuReceiver->ngimuRotationMatrix, ngimuReceiver->userContext);
+    }
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Process "/sensors" message as fixed-point.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param oscTimeTag OSC time tag associated with message.
+ * @param oscMessage Address of OSC message.
+ * @return Error code (0 if successful).
+ */
+static OscError ProcessSensorsQ(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+
+    // Get timestamp
+    NgimuSensorsQ * const ngimuSensorsQ = &ngimuReceiver->ngimuSensorsQ;
+    ngimuSensorsQ->timestamp = *oscTimeTag;
+
+    // Get arguments
+    int32_t arguments[10];
+    const OscError oscError = GetArgumentsAsFixedPointArray(oscMessage, arguments, 10, 16, ngimuReceiver->sensorsSkippedArguments);
     if (oscError != OscErrorNone) {
         return oscError;
     }
+    const unsigned int skippedArguments = ngimuReceiver->sensorsSkippedArguments;
+    if ((skippedArguments & NgimuSensorsFieldsGyroscope) == 0) {
+        ngimuSensorsQ->gyroscopeX = arguments[0];
+        ngimuSensorsQ->gyroscopeY = arguments[1];
+        ngimuSensorsQ->gyroscopeZ = arguments[2];
+    }
+    if ((skippedArguments & NgimuSensorsFieldsAccelerometer) == 0) {
+        ngimuSensorsQ->accelerometerX = arguments[3];
+        ngimuSensorsQ->accelerometerY = arguments[4];
+        ngimuSensorsQ->accelerometerZ = arguments[5];
+    }
+    if ((skippedArguments & NgimuSensorsFieldsMagnetometer) == 0) {
+        ngimuSensorsQ->magnetometerX = arguments[6];
+        ngimuSensorsQ->magnetometerY = arguments[7];
+        ngimuSensorsQ->magnetometerZ = arguments[8];
+    }
+    if ((skippedArguments & NgimuSensorsFieldsBarometer) == 0) {
+        ngimuSensorsQ->barometer = arguments[9];
+    }
+
+    // Callback
+    STATISTICS_END_DECODE(ngimuReceiver);
+    ngimuReceiver->sensorsQCallback(ngimuSensorsQ, ngimuReceiver->userContext);
+    return OscErrorNone;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Process "/quaternion" message as fixed-point.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param oscTimeTag OSC time tag associated with message.
+ * @param oscMessage Address of OSC message.
+ * @return Error code (0 if successful).
+ */
+static OscError ProcessQuaternionQ(NgimuReceiver * const ngimuReceiver, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+
+    // Get timestamp
+    NgimuQuaternionQ * const ngimuQuaternionQ = &ngimuReceiver->ngimuQuaternionQ;
+    ngimuQuaternionQ->timestamp = *oscTimeTag;
 
-    // Get barometer
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuSensors.barometer);
+    // Get arguments
+    int32_t arguments[4];
+    const OscError oscError = GetArgumentsAsFixedPointArray(oscMessage, arguments, 4, 15, 0);
     if (oscError != OscErrorNone) {
         return oscError;
     }
+    ngimuQuaternionQ->w = SaturateInt16(arguments[0]);
+    ngimuQuaternionQ->x = SaturateInt16(arguments[1]);
+    ngimuQuaternionQ->y = SaturateInt16(arguments[2]);
+    ngimuQuaternionQ->z = SaturateInt16(arguments[3]);
 
     // Callback
-    sensorsCallback(ngimuSensors);
+    STATISTICS_END_DECODE(ngimuReceiver);
+    ngimuReceiver->quaternionQCallback(ngimuQuaternionQ, ngimuReceiver->userContext);
     return OscErrorNone;
 }
+#endif
 
 /**
- * @brief Process "/quaternion" message.
+ * @brief Prepares the bundle for a message of the specified type.  The current
+ * bundle is provided first if it already contains a message of this type.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param contents Message type.
+ * @param oscTimeTag OSC time tag associated with message.
+ * @return Address of bundle structure.
+ */
+static NgimuBundle* PrepareBundle(NgimuReceiver * const ngimuReceiver, const NgimuBundleContents contents, const OscTimeTag * const oscTimeTag) {
+    NgimuBundle * const ngimuBundle = &ngimuReceiver->ngimuBundle;
+    if ((ngimuBundle->contents & contents) != 0) {
+        DeliverBundle(ngimuReceiver);
+    }
+    if (ngimuBundle->contents == 0) {
+        ngimuBundle->timestamp = *oscTimeTag;
+    }
+    return ngimuBundle;
+}
+
+/**
+ * @brief Provides the bundle to the bundle callback if it contains any
+ * messages.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+static void DeliverBundle(NgimuReceiver * const ngimuReceiver) {
+    if (ngimuReceiver->ngimuBundle.contents == 0) {
+        return;
+    }
+    ngimuReceiver->bundleCallback(&ngimuReceiver->ngimuBundle, ngimuReceiver->userContext);
+    ngimuReceiver->ngimuBundle.contents = 0;
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Writes "/sensors" message to column buffers.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param columns Address of "/sensors" columns structure.
  * @param oscTimeTag OSC time tag associated with message.
  * @param oscMessage Address of OSC message.
  * @return Error code (0 if successful).
  */
-static OscError ProcessQuaternion(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+static OscError WriteSensorsColumns(NgimuReceiver * const ngimuReceiver, NgimuSensorsColumns * const columns, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
 
-    // Do nothing if no callback assigned
-    if (quaternionCallback == NULL) {
+    // Discard message if buffers full
+    if (columns->count >= columns->capacity) {
+        if (columns->capacity > 0) {
+            columns->numberOfDiscarded++;
+        }
         return OscErrorNone;
     }
 
-    // Get timestamp
-    NgimuQuaternion ngimuQuaternion;
-    ngimuQuaternion.timestamp = *oscTimeTag;
-
-    // Get W element
-    OscError oscError;
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuQuaternion.w);
+    // Get arguments
+    float arguments[10];
+    const OscError oscError = GetArgumentsAsFloat32Array(oscMessage, arguments, 10);
     if (oscError != OscErrorNone) {
         return oscError;
     }
 
-    // Get X element
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuQuaternion.x);
-    if (oscError != OscErrorNone) {
-        return oscError;
+    // Write columns
+    STATISTICS_END_DECODE(ngimuReceiver);
+    const size_t index = columns->count++;
+    columns->timestamp[index] = oscTimeTag->value;
+    columns->gyroscopeX[index] = arguments[0];
+    columns->gyroscopeY[index] = arguments[1];
+    columns->gyroscopeZ[index] = arguments[2];
+    columns->accelerometerX[index] = arguments[3];
+    columns->accelerometerY[index] = arguments[4];
+    columns->accelerometerZ[index] = arguments[5];
+    columns->magnetometerX[index] = arguments[6];
+    columns->magnetometerY[index] = arguments[7];
+    columns->magnetometerZ[index] = arguments[8];
+    columns->barometer[index] = arguments[9];
+    return OscErrorNone;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Writes "/quaternion" message to column buffers.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param columns Address of "/quaternion" columns structure.
+ * @param oscTimeTag OSC time tag associated with message.
+ * @param oscMessage Address of OSC message.
+ * @return Error code (0 if successful).
+ */
+static OscError WriteQuaternionColumns(NgimuReceiver * const ngimuReceiver, NgimuQuaternionColumns * const columns, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+
+    // Discard message if buffers full
+    if (columns->count >= columns->capacity) {
+        if (columns->capacity > 0) {
+            columns->numberOfDiscarded++;
+        }
+        return OscErrorNone;
     }
 
-    // Get Y element
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuQuaternion.y);
+    // Get arguments
+    float arguments[4];
+    const OscError oscError = GetArgumentsAsFloat32Array(oscMessage, arguments, 4);
     if (oscError != OscErrorNone) {
         return oscError;
     }
 
-    // Get Z element
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuQuaternion.z);
+    // Write columns
+    STATISTICS_END_DECODE(ngimuReceiver);
+    const size_t index = columns->count++;
+    columns->timestamp[index] = oscTimeTag->value;
+    columns->w[index] = arguments[0];
+    columns->x[index] = arguments[1];
+    columns->y[index] = arguments[2];
+    columns->z[index] = arguments[3];
+    return OscErrorNone;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief Writes "/euler" message to column buffers.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param columns Address of "/euler" columns structure.
+ * @param oscTimeTag OSC time tag associated with message.
+ * @param oscMessage Address of OSC message.
+ * @return Error code (0 if successful).
+ */
+static OscError WriteEulerColumns(NgimuReceiver * const ngimuReceiver, NgimuEulerColumns * const columns, const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+
+    // Discard message if buffers full
+    if (columns->count >= columns->capacity) {
+        if (columns->capacity > 0) {
+            columns->numberOfDiscarded++;
+        }
+        return OscErrorNone;
+    }
+
+    // Get arguments
+    float arguments[3];
+    const OscError oscError = GetArgumentsAsFloat32Array(oscMessage, arguments, 3);
     if (oscError != OscErrorNone) {
         return oscError;
     }
 
-    // Callback
-    quaternionCallback(ngimuQuaternion);
+    // Write columns
+    STATISTICS_END_DECODE(ngimuReceiver);
+    const size_t index = columns->count++;
+    columns->timestamp[index] = oscTimeTag->value;
+    columns->roll[index] = arguments[0];
+    columns->pitch[index] = arguments[1];
+    columns->yaw[index] = arguments[2];
     return OscErrorNone;
 }
+#endif
 
 /**
- * @brief Process "/euler" message.
- * @param oscTimeTag OSC time tag associated with message.
+ * @brief Returns true if an unrecognised address should be discarded without
+ * an error.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param oscMessage Address of OSC message.
+ * @return True if the address should be discarded without an error.
+ */
+static bool IsAddressIgnored(const NgimuReceiver * const ngimuReceiver, const OscMessage * const oscMessage) {
+    if ((ngimuReceiver->ignoreUnrecognisedAddresses == true) || (ngimuReceiver->receiveErrorCallback == NULL)) {
+        return true;
+    }
+    size_t index;
+    for (index = 0; index < ngimuReceiver->numberOfIgnoredAddresses; index++) {
+        if (ngimuReceiver->ignoredAddressLengths[index] != oscMessage->oscAddressPatternLength) {
+            continue;
+        }
+        if (memcmp(ngimuReceiver->ignoredAddresses[index], oscMessage->oscAddressPattern, oscMessage->oscAddressPatternLength) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Reports error through the receive error callback.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param code Error code.
+ * @param oscError OSC error code.
+ * @param oscAddressPattern OSC address pattern associated with error, or NULL.
+ */
+static void ReceiveError(NgimuReceiver * const ngimuReceiver, const NgimuReceiveErrorCode code, const OscError oscError, const char * const oscAddressPattern) {
+    if (code == NgimuReceiveErrorCodeOsc) {
+        STATISTICS_OSC_ERROR(ngimuReceiver, oscError);
+    }
+    if (ngimuReceiver->receiveErrorCallback == NULL) {
+        return;
+    }
+    NgimuReceiveError ngimuReceiveError;
+    ngimuReceiveError.code = code;
+    ngimuReceiveError.oscError = oscError;
+    ngimuReceiveError.oscAddressPattern = oscAddressPattern;
+    ngimuReceiver->receiveErrorCallback(&ngimuReceiveError, ngimuReceiver->userContext);
+}
+
+/**
+ * @brief Appends a string without writing the terminating null character.
+ * @param destination Destination string.
+ * @param destinationSize Destination size.
+ * @param index Index at which to append.
+ * @param source Source string.
+ * @return Index after the appended string.  The index is limited to leave space
+ * for a terminating null character.
+ */
+static size_t AppendString(char * const destination, const size_t destinationSize, size_t index, const char * const source) {
+    size_t sourceIndex = 0;
+    while ((source[sourceIndex] != '\0') && (index < (destinationSize - 1))) {
+        destination[index++] = source[sourceIndex++];
+    }
+    return index;
+}
+
+#if NGIMU_RECEIVE_ENABLE_STATISTICS
+/**
+ * @brief Adds the number of cycles since STATISTICS_START_DECODE to the decode
+ * cycle histogram.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+static void AddDecodeCycles(NgimuReceiver * const ngimuReceiver) {
+    uint32_t cycles = (uint32_t) (NGIMU_RECEIVE_GET_CYCLE_COUNT() - ngimuReceiver->decodeStartCycleCount);
+    size_t bucket = 0;
+    while ((cycles != 0) && (bucket < (NGIMU_RECEIVE_NUMBER_OF_CYCLE_BUCKETS - 1))) {
+        cycles >>= 1;
+        bucket++;
+    }
+    ngimuReceiver->statistics.decodeCycleHistogram[bucket]++;
+}
+
+/**
+ * @brief Adds OSC error to the OSC error counts.
+ * @param ngimuReceiver Address of receiver structure.
+ * @param oscError OSC error code.
+ */
+static void AddOscError(NgimuReceiver * const ngimuReceiver, const OscError oscError) {
+    size_t index = (size_t) oscError;
+    if (index >= NGIMU_RECEIVE_NUMBER_OF_OSC_ERROR_COUNTS) {
+        index = NGIMU_RECEIVE_NUMBER_OF_OSC_ERROR_COUNTS - 1;
+    }
+    ngimuReceiver->statistics.oscErrorCounts[index]++;
+}
+#endif
+
+/**
+ * @brief Reads a big-endian 32-bit value.
+ * @param source Source bytes.
+ * @return Value in host byte order.
+ */
+static uint32_t ReadBigEndian32(const char * const source) {
+    const unsigned char * const bytes = (const unsigned char *) source;
+    return ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) | ((uint32_t) bytes[2] << 8) | (uint32_t) bytes[3];
+}
+
+/**
+ * @brief Gets float32 arguments.  The arguments are byte swapped in a single
+ * pass if the type tag string is all float32 and the arguments are present.
+ * Otherwise, each argument is got separately so that other numerical argument
+ * types are converted to float32.
  * @param oscMessage Address of OSC message.
+ * @param destination Destination array.
+ * @param numberOfArguments Number of arguments.
  * @return Error code (0 if successful).
  */
-static OscError ProcessEuler(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage) {
+static OscError GetArgumentsAsFloat32Array(OscMessage * const oscMessage, float * const destination, const size_t numberOfArguments) {
 
-    // Do nothing if no callback assigned
-    if (eulerCallback == NULL) {
+    // Single pass if type tag string matches expected layout
+    if ((numberOfArguments <= MAX_NUMBER_OF_FLOAT32_ARGUMENTS)
+            && (oscMessage->oscTypeTagStringLength == (numberOfArguments + 1))
+            && (memcmp(oscMessage->oscTypeTagString, FLOAT32_TYPE_TAG_STRING, numberOfArguments + 1) == 0)
+            && (oscMessage->argumentsSize >= (numberOfArguments * sizeof (float)))) {
+        ByteSwapFloat32Array(destination, oscMessage->arguments, numberOfArguments);
         return OscErrorNone;
     }
 
-    // Get timestamp
-    NgimuEuler ngimuEuler;
-    ngimuEuler.timestamp = *oscTimeTag;
+    // Otherwise get each argument
+    size_t index;
+    for (index = 0; index < numberOfArguments; index++) {
+        const OscError oscError = OscMessageGetArgumentAsFloat32(oscMessage, &destination[index]);
+        if (oscError != OscErrorNone) {
+            return oscError;
+        }
+    }
+    return OscErrorNone;
+}
 
-    // Get roll
-    OscError oscError;
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuEuler.roll);
-    if (oscError != OscErrorNone) {
-        return oscError;
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Gets float32 arguments, skipping the arguments that are not required.
+ * Destination elements of skipped arguments are not written.
+ * @param oscMessage Address of OSC message.
+ * @param destination Destination array.
+ * @param numberOfArguments Number of arguments.
+ * @param skippedArguments Bit n set if argument n is not required.
+ * @return Error code (0 if successful).
+ */
+static OscError GetSelectedArgumentsAsFloat32Array(OscMessage * const oscMessage, float * const destination, const size_t numberOfArguments, const unsigned int skippedArguments) {
+    if (skippedArguments == 0) {
+        return GetArgumentsAsFloat32Array(oscMessage, destination, numberOfArguments);
     }
 
-    // Get pitch
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuEuler.pitch);
-    if (oscError != OscErrorNone) {
-        return oscError;
+    // Decode all arguments if type tag string does not match expected layout
+    size_t index;
+    if ((numberOfArguments > MAX_NUMBER_OF_FLOAT32_ARGUMENTS)
+            || (oscMessage->oscTypeTagStringLength != (numberOfArguments + 1))
+            || (memcmp(oscMessage->oscTypeTagString, FLOAT32_TYPE_TAG_STRING, numberOfArguments + 1) != 0)
+            || (oscMessage->argumentsSize < (numberOfArguments * sizeof (float)))) {
+        float arguments[MAX_NUMBER_OF_FLOAT32_ARGUMENTS];
+        if (numberOfArguments > MAX_NUMBER_OF_FLOAT32_ARGUMENTS) {
+            return OscErrorUnexpectedArgumentType;
+        }
+        const OscError oscError = GetArgumentsAsFloat32Array(oscMessage, arguments, numberOfArguments);
+        if (oscError != OscErrorNone) {
+            return oscError;
+        }
+        for (index = 0; index < numberOfArguments; index++) {
+            if ((skippedArguments & (1u << index)) == 0) {
+                destination[index] = arguments[index];
+            }
+        }
+        return OscErrorNone;
     }
 
-    // Get yaw
-    oscError = OscMessageGetArgumentAsFloat32(oscMessage, &ngimuEuler.yaw);
-    if (oscError != OscErrorNone) {
-        return oscError;
+    // Otherwise byte swap each run of required arguments
+    index = 0;
+    while (index < numberOfArguments) {
+        if ((skippedArguments & (1u << index)) != 0) {
+            index++;
+            continue;
+        }
+        size_t end = index + 1;
+        while ((end < numberOfArguments) && ((skippedArguments & (1u << end)) == 0)) {
+            end++;
+        }
+        ByteSwapFloat32Array(&destination[index], &oscMessage->arguments[index * sizeof (float)], end - index);
+        index = end;
     }
+    return OscErrorNone;
+}
+#endif
 
-    // Callback
-    eulerCallback(ngimuEuler);
+/**
+ * @brief Converts an array of big-endian float32 arguments to host byte order.
+ * Uses NEON or SSSE3 where available.
+ * @param destination Destination array.
+ * @param source Source arguments.
+ * @param numberOfArguments Number of arguments.
+ */
+static void ByteSwapFloat32Array(float * const destination, const char * const source, const size_t numberOfArguments) {
+#ifdef LITTLE_ENDIAN_PLATFORM
+    size_t index = 0;
+#if defined(__ARM_NEON)
+    for (; (index + 4) <= numberOfArguments; index += 4) {
+        vst1q_u8((uint8_t *) &destination[index], vrev32q_u8(vld1q_u8((const uint8_t *) &source[index * sizeof (float)])));
+    }
+#elif defined(__SSSE3__)
+    const __m128i mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    for (; (index + 4) <= numberOfArguments; index += 4) {
+        _mm_storeu_si128((__m128i *) &destination[index], _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) &source[index * sizeof (float)]), mask));
+    }
+#endif
+    for (; index < numberOfArguments; index++) {
+        uint32_t word;
+        memcpy(&word, &source[index * sizeof (float)], sizeof (word));
+#if defined(__GNUC__)
+        word = __builtin_bswap32(word);
+#else
+        word = (word >> 24) | ((word >> 8) & 0x0000FF00) | ((word << 8) & 0x00FF0000) | (word << 24);
+#endif
+        memcpy(&destination[index], &word, sizeof (word));
+    }
+#else
+    memcpy(destination, source, numberOfArguments * sizeof (float));
+#endif
+}
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && (NGIMU_RECEIVE_ENABLE_SENSORS || NGIMU_RECEIVE_ENABLE_QUATERNION)
+/**
+ * @brief Gets float32 arguments as fixed-point values.  The arguments are
+ * converted from their IEEE-754 bits so that no floating-point operations are
+ * required.  All arguments must be float32.
+ * @param oscMessage Address of OSC message.
+ * @param destination Destination array.
+ * @param numberOfArguments Number of arguments.
+ * @param fractionalBits Number of fractional bits of the fixed-point format.
+ * @param skippedArguments Bit n set if argument n is not required.
+ * @return Error code (0 if successful).
+ */
+static OscError GetArgumentsAsFixedPointArray(OscMessage * const oscMessage, int32_t * const destination, const size_t numberOfArguments, const int fractionalBits, const unsigned int skippedArguments) {
+    if ((numberOfArguments > MAX_NUMBER_OF_FLOAT32_ARGUMENTS)
+            || (oscMessage->oscTypeTagStringLength != (numberOfArguments + 1))
+            || (memcmp(oscMessage->oscTypeTagString, FLOAT32_TYPE_TAG_STRING, numberOfArguments + 1) != 0)) {
+        return OscErrorUnexpectedArgumentType;
+    }
+    if (oscMessage->argumentsSize < (numberOfArguments * sizeof (uint32_t))) {
+        return OscErrorMessageTooShortForArgumentType;
+    }
+    size_t index;
+    for (index = 0; index < numberOfArguments; index++) {
+        if ((skippedArguments & (1u << index)) != 0) {
+            continue;
+        }
+        destination[index] = Float32ToFixedPoint(ReadBigEndian32(&oscMessage->arguments[index * sizeof (uint32_t)]), fractionalBits);
+    }
     return OscErrorNone;
 }
 
+/**
+ * @brief Converts the IEEE-754 bits of a float32 to a fixed-point value,
+ * rounded to nearest.  Values beyond the range of int32_t, infinities and NaNs
+ * are saturated.  Subnormal values are converted to zero.
+ * @param float32 IEEE-754 bits.
+ * @param fractionalBits Number of fractional bits of the fixed-point format.
+ * @return Fixed-point value.
+ */
+static int32_t Float32ToFixedPoint(const uint32_t float32, const int fractionalBits) {
+    const int exponent = (int) ((float32 >> 23) & 0xFF);
+    if (exponent == 0) {
+        return 0;
+    }
+
+    // Value is mantissa * 2^shift in the fixed-point format
+    const int shift = exponent - (127 + 23) + fractionalBits;
+    const uint32_t mantissa = (float32 & 0x007FFFFF) | 0x00800000;
+    uint32_t magnitude;
+    if (shift > 7) {
+        magnitude = INT32_MAX;
+    } else if (shift >= 0) {
+        magnitude = mantissa << shift;
+    } else if (shift >= -24) {
+        magnitude = (mantissa + ((uint32_t) 1 << (-shift - 1))) >> -shift;
+    } else {
+        magnitude = 0;
+    }
+    return ((float32 & 0x80000000) != 0) ? -(int32_t) magnitude : (int32_t) magnitude;
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Saturates a value to the range of int16_t.
+ * @param value Value.
+ * @return Saturated value.
+ */
+static int16_t SaturateInt16(const int32_t value) {
+    if (value > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t) value;
+}
+#endif
+
 //------------------------------------------------------------------------------
 // End of file
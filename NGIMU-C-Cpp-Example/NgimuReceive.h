@@ -15,10 +15,163 @@ extern "C" {
 // Includes
 
 #include "Osc99.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 //------------------------------------------------------------------------------
 // Definitions
 
+/**
+ * @brief Message types to be decoded.  A message type set to 0 is removed from
+ * the binary and from the dispatch path, and its callback functions are not
+ * available.  The values may be set here or by the compiler command line.
+ */
+#ifndef NGIMU_RECEIVE_ENABLE_SENSORS
+#define NGIMU_RECEIVE_ENABLE_SENSORS (1)
+#endif
+#ifndef NGIMU_RECEIVE_ENABLE_QUATERNION
+#define NGIMU_RECEIVE_ENABLE_QUATERNION (1)
+#endif
+#ifndef NGIMU_RECEIVE_ENABLE_EULER
+#define NGIMU_RECEIVE_ENABLE_EULER (1)
+#endif
+
+/**
+ * @brief Set to 1 to enable receiver statistics.  When set to 0, statistics are
+ * removed from the receiver structure and the hot path, and the statistics
+ * functions are not available.
+ */
+#ifndef NGIMU_RECEIVE_ENABLE_STATISTICS
+#define NGIMU_RECEIVE_ENABLE_STATISTICS (0)
+#endif
+
+/**
+ * @brief Set to 1 to enable the capture callback that provides all raw input
+ * to the receiver, e.g. for recording with NgimuCapture.  When set to 0, the
+ * capture callback is removed from the receiver structure and the hot path.
+ */
+#ifndef NGIMU_RECEIVE_ENABLE_CAPTURE
+#define NGIMU_RECEIVE_ENABLE_CAPTURE (0)
+#endif
+
+/**
+ * @brief Set to 1 to enable derived outputs.  Each "/quaternion" message may
+ * then be converted to Euler angles provided through the "/euler" callback and
+ * to a rotation matrix provided through the rotation matrix callback, so that
+ * the NGIMU need only send "/quaternion" messages.  Requires NgimuDerive.c.
+ */
+#ifndef NGIMU_RECEIVE_ENABLE_DERIVED
+#define NGIMU_RECEIVE_ENABLE_DERIVED (0)
+#endif
+
+/**
+ * @brief Set to 1 to enable fixed-point output.  "/sensors" and "/quaternion"
+ * messages may then be decoded to integer structures directly from the
+ * IEEE-754 bits of the arguments, without floating-point operations, for
+ * platforms without an FPU such as AVR.
+ */
+#ifndef NGIMU_RECEIVE_ENABLE_FIXED_POINT
+#define NGIMU_RECEIVE_ENABLE_FIXED_POINT (0)
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_STATISTICS
+
+/**
+ * @brief Cycle counter used for the decode cycle histogram.  May be defined by
+ * the compiler command line for other platforms.  The DWT cycle counter on
+ * Cortex-M3/M4 must be enabled by the application.
+ */
+#ifndef NGIMU_RECEIVE_GET_CYCLE_COUNT
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NGIMU_RECEIVE_GET_CYCLE_COUNT() ((uint32_t) __builtin_ia32_rdtsc())
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define NGIMU_RECEIVE_GET_CYCLE_COUNT() (*(volatile uint32_t *) 0xE0001004)
+#else
+#define NGIMU_RECEIVE_GET_CYCLE_COUNT() ((uint32_t) 0)
+#endif
+#endif
+
+/**
+ * @brief Number of decode cycle histogram buckets.  Bucket 0 counts messages
+ * decoded in 0 cycles and bucket n counts messages decoded in 2^(n-1) to
+ * 2^n - 1 cycles.  The last bucket also counts all longer durations.
+ */
+#define NGIMU_RECEIVE_NUMBER_OF_CYCLE_BUCKETS (24)
+
+/**
+ * @brief Number of OSC error counts.  The last count also counts all greater
+ * OSC error codes.
+ */
+#define NGIMU_RECEIVE_NUMBER_OF_OSC_ERROR_COUNTS (48)
+
+#endif
+
+/**
+ * @brief Size of the SLIP decoder buffer of each receiver.  When serial bytes
+ * are only processed in place, this buffer is only used for packets that
+ * straddle non-contiguous chunks and may be reduced to the size of the largest
+ * packet sent by the NGIMU, e.g. on devices such as the Arduino MEGA.
+ */
+#ifndef NGIMU_RECEIVER_SLIP_BUFFER_SIZE
+#define NGIMU_RECEIVER_SLIP_BUFFER_SIZE (MAX_TRANSPORT_SIZE)
+#endif
+
+/**
+ * @brief Limits of the work done for each OSC packet so that the worst-case
+ * decode time of malformed or hostile input is bounded.  The size and
+ * structure of each packet are checked before any message is processed.  A
+ * packet larger than NGIMU_RECEIVE_MAX_PACKET_SIZE, or with bundles nested
+ * deeper than NGIMU_RECEIVE_MAX_BUNDLE_DEPTH, or with more than
+ * NGIMU_RECEIVE_MAX_MESSAGES_PER_PACKET messages, is rejected as a whole.  The
+ * bundle depth also bounds the stack used by the decoder.  The defaults
+ * accept all packets sent by the NGIMU.
+ */
+#ifndef NGIMU_RECEIVE_MAX_PACKET_SIZE
+#define NGIMU_RECEIVE_MAX_PACKET_SIZE (MAX_OSC_PACKET_SIZE)
+#endif
+#ifndef NGIMU_RECEIVE_MAX_BUNDLE_DEPTH
+#define NGIMU_RECEIVE_MAX_BUNDLE_DEPTH (4)
+#endif
+#ifndef NGIMU_RECEIVE_MAX_MESSAGES_PER_PACKET
+#define NGIMU_RECEIVE_MAX_MESSAGES_PER_PACKET (64)
+#endif
+
+/**
+ * @brief Maximum number of ignored addresses of each receiver.
+ */
+#define NGIMU_RECEIVER_MAX_IGNORED_ADDRESSES (8)
+
+/**
+ * @brief Transport of raw input.
+ */
+typedef enum {
+    NgimuReceiveTransportSerial,
+    NgimuReceiveTransportUdp,
+} NgimuReceiveTransport;
+
+/**
+ * @brief Receive error codes.
+ */
+typedef enum {
+    NgimuReceiveErrorCodeOsc,
+    NgimuReceiveErrorCodeAddressNotRecognised,
+    NgimuReceiveErrorCodeBundleTooDeep,
+    NgimuReceiveErrorCodeTooManyMessages,
+} NgimuReceiveErrorCode;
+
+/**
+ * @brief Receive error.  The OSC error is only valid for
+ * NgimuReceiveErrorCodeOsc.  The OSC address pattern is NULL if the error is
+ * not associated with a message and is only valid for the duration of the
+ * callback.
+ */
+typedef struct {
+    NgimuReceiveErrorCode code;
+    OscError oscError;
+    const char* oscAddressPattern;
+} NgimuReceiveError;
+
 /**
  * @brief Timestamp and argument values for "/sensors" message.
  */
@@ -36,6 +189,18 @@ typedef struct {
     float barometer;
 } NgimuSensors;
 
+/**
+ * @brief "/sensors" fields.  Each value has one bit set for each argument of
+ * the field.
+ */
+typedef enum {
+    NgimuSensorsFieldsGyroscope = 0x007,
+    NgimuSensorsFieldsAccelerometer = 0x038,
+    NgimuSensorsFieldsMagnetometer = 0x1C0,
+    NgimuSensorsFieldsBarometer = 0x200,
+    NgimuSensorsFieldsAll = 0x3FF,
+} NgimuSensorsFields;
+
 /**
  * @brief Timestamp and argument values for "/quaternion" message.
  */
@@ -47,6 +212,42 @@ typedef struct {
     float z;
 } NgimuQuaternion;
 
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT
+
+/**
+ * @brief Timestamp and argument values for "/sensors" message in Q16.16
+ * fixed-point format, i.e. the value multiplied by 65536.  Values beyond the
+ * range of the format are saturated.
+ */
+typedef struct {
+    OscTimeTag timestamp;
+    int32_t gyroscopeX;
+    int32_t gyroscopeY;
+    int32_t gyroscopeZ;
+    int32_t accelerometerX;
+    int32_t accelerometerY;
+    int32_t accelerometerZ;
+    int32_t magnetometerX;
+    int32_t magnetometerY;
+    int32_t magnetometerZ;
+    int32_t barometer;
+} NgimuSensorsQ;
+
+/**
+ * @brief Timestamp and argument values for "/quaternion" message in Q15
+ * fixed-point format, i.e. the value multiplied by 32768.  A value of 1 is
+ * saturated to 32767.
+ */
+typedef struct {
+    OscTimeTag timestamp;
+    int16_t w;
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} NgimuQuaternionQ;
+
+#endif
+
 /**
  * @brief Timestamp and argument values for "/euler" message.
  */
@@ -57,16 +258,329 @@ typedef struct {
     float yaw;
 } NgimuEuler;
 
+/**
+ * @brief Timestamp and elements of a rotation matrix derived from a
+ * "/quaternion" message.  Elements are in row-major order.
+ */
+typedef struct {
+    OscTimeTag timestamp;
+    float xx;
+    float xy;
+    float xz;
+    float yx;
+    float yy;
+    float yz;
+    float zx;
+    float zy;
+    float zz;
+} NgimuRotationMatrix;
+
+/**
+ * @brief Accuracy of derived Euler angles.  NgimuDerivedAccuracyExact uses the
+ * standard library functions.  NgimuDerivedAccuracyHigh and
+ * NgimuDerivedAccuracyLow use polynomial approximations with a maximum error of
+ * approximately 0.001 degrees and 0.1 degrees respectively.
+ */
+typedef enum {
+    NgimuDerivedAccuracyExact,
+    NgimuDerivedAccuracyHigh,
+    NgimuDerivedAccuracyLow,
+} NgimuDerivedAccuracy;
+
+/**
+ * @brief Bundle content flags.
+ */
+typedef enum {
+    NgimuBundleContentsSensors = 1 << 0,
+    NgimuBundleContentsQuaternion = 1 << 1,
+    NgimuBundleContentsEuler = 1 << 2,
+} NgimuBundleContents;
+
+/**
+ * @brief Messages decoded from one OSC packet.  The contents indicate which
+ * message structures are valid.  The timestamp is the OSC time tag of the
+ * first message.
+ */
+typedef struct {
+    OscTimeTag timestamp;
+    unsigned int contents;
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuSensors sensors;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuQuaternion quaternion;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuEuler euler;
+#endif
+} NgimuBundle;
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief Column buffers for "/sensors" messages.  Each buffer has capacity
+ * elements and element n of each buffer belongs to message n.  Timestamps are
+ * OSC time tag values.
+ */
+typedef struct {
+    size_t capacity;
+    size_t count;
+    size_t numberOfDiscarded;
+    uint64_t* timestamp;
+    float* gyroscopeX;
+    float* gyroscopeY;
+    float* gyroscopeZ;
+    float* accelerometerX;
+    float* accelerometerY;
+    float* accelerometerZ;
+    float* magnetometerX;
+    float* magnetometerY;
+    float* magnetometerZ;
+    float* barometer;
+} NgimuSensorsColumns;
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief Column buffers for "/quaternion" messages.  See NgimuSensorsColumns.
+ */
+typedef struct {
+    size_t capacity;
+    size_t count;
+    size_t numberOfDiscarded;
+    uint64_t* timestamp;
+    float* w;
+    float* x;
+    float* y;
+    float* z;
+} NgimuQuaternionColumns;
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief Column buffers for "/euler" messages.  See NgimuSensorsColumns.
+ */
+typedef struct {
+    size_t capacity;
+    size_t count;
+    size_t numberOfDiscarded;
+    uint64_t* timestamp;
+    float* roll;
+    float* pitch;
+    float* yaw;
+} NgimuEulerColumns;
+#endif
+
+/**
+ * @brief Column buffers for all message types.  Buffers are provided by the
+ * application.  A message type with a capacity of 0 is not decoded.  Messages
+ * received while the buffers of the message type are full are discarded and
+ * counted.
+ */
+typedef struct {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuSensorsColumns sensors;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuQuaternionColumns quaternion;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuEulerColumns euler;
+#endif
+} NgimuColumns;
+
+#if NGIMU_RECEIVE_ENABLE_STATISTICS
+/**
+ * @brief Receiver statistics.  Message counts include messages that are not
+ * decoded because no callback is assigned.  The decode cycle histogram
+ * includes only messages that are decoded and excludes the time spent in the
+ * callback.
+ */
+typedef struct {
+    uint32_t numberOfBytes;
+    uint32_t numberOfPackets;
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    uint32_t numberOfSensorsMessages;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    uint32_t numberOfQuaternionMessages;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    uint32_t numberOfEulerMessages;
+#endif
+    uint32_t numberOfUnrecognisedAddresses;
+    uint32_t numberOfSlipErrors;
+    uint32_t oscErrorCounts[NGIMU_RECEIVE_NUMBER_OF_OSC_ERROR_COUNTS];
+    uint32_t decodeCycleHistogram[NGIMU_RECEIVE_NUMBER_OF_CYCLE_BUCKETS];
+} NgimuReceiveStatistics;
+#endif
+
+/**
+ * @brief UDP packet descriptor for batch processing.  The source address is
+ * platform-specific (e.g. struct sockaddr_in) and not interpreted by this
+ * module.
+ */
+typedef struct {
+    const char* buffer;
+    size_t size;
+    const void* sourceAddress;
+} NgimuUdpPacket;
+
+/**
+ * @brief Receiver structure.  Each instance decodes one stream independently
+ * and may be used without locks provided that each instance is only accessed
+ * from one context.  Structure members are used internally and should not be
+ * used by the user application.
+ */
+typedef struct {
+    char slipBuffer[NGIMU_RECEIVER_SLIP_BUFFER_SIZE];
+    size_t slipBufferIndex;
+    bool slipEscape;
+    bool slipDiscard;
+    char* slipInPlace;
+    const char* slipInPlaceEnd;
+    const char* ignoredAddresses[NGIMU_RECEIVER_MAX_IGNORED_ADDRESSES];
+    size_t ignoredAddressLengths[NGIMU_RECEIVER_MAX_IGNORED_ADDRESSES];
+    size_t numberOfIgnoredAddresses;
+    bool ignoreUnrecognisedAddresses;
+    bool (*unrecognisedMessageCallback)(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage, void * const unrecognisedMessageContext);
+    void* unrecognisedMessageContext;
+    void (*timeTagCallback)(const char * const oscAddressPattern, const size_t oscAddressPatternLength, const OscTimeTag * const oscTimeTag, void * const timeTagContext);
+    void* timeTagContext;
+    void (*receiveErrorCallback)(const NgimuReceiveError * const ngimuReceiveError, void * const userContext);
+    void* userContext;
+    NgimuColumns* ngimuColumns;
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    void (*sensorsCallback)(const NgimuSensors * const ngimuSensors, void * const userContext);
+    NgimuSensors ngimuSensors;
+    unsigned int sensorsSkippedArguments;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    void (*quaternionCallback)(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+    NgimuQuaternion ngimuQuaternion;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    void (*eulerCallback)(const NgimuEuler * const ngimuEuler, void * const userContext);
+    NgimuEuler ngimuEuler;
+#endif
+    void (*bundleCallback)(const NgimuBundle * const ngimuBundle, void * const userContext);
+    NgimuBundle ngimuBundle;
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+    void (*sensorsQCallback)(const NgimuSensorsQ * const ngimuSensorsQ, void * const userContext);
+    NgimuSensorsQ ngimuSensorsQ;
+#endif
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+    void (*quaternionQCallback)(const NgimuQuaternionQ * const ngimuQuaternionQ, void * const userContext);
+    NgimuQuaternionQ ngimuQuaternionQ;
+#endif
+#if NGIMU_RECEIVE_ENABLE_STATISTICS
+    NgimuReceiveStatistics statistics;
+    uint32_t decodeStartCycleCount;
+#endif
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+    void (*captureCallback)(const NgimuReceiveTransport transport, const char * const source, const size_t sourceSize, void * const captureContext);
+    void* captureContext;
+#endif
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+    bool deriveEuler;
+    NgimuDerivedAccuracy derivedAccuracy;
+    void (*rotationMatrixCallback)(const NgimuRotationMatrix * const ngimuRotationMatrix, void * const userContext);
+    NgimuRotationMatrix ngimuRotationMatrix;
+#endif
+} NgimuReceiver;
+
 //------------------------------------------------------------------------------
 // Function prototypes
 
+void NgimuReceiverInitialise(NgimuReceiver * const ngimuReceiver);
+void NgimuReceiverSetUserContext(NgimuReceiver * const ngimuReceiver, void * const userContext);
+void NgimuReceiverSetReceiveErrorCallback(NgimuReceiver * const ngimuReceiver, void (*newReceiveErrorCallback)(const NgimuReceiveError * const ngimuReceiveError, void * const userContext));
+bool NgimuReceiverIgnoreAddress(NgimuReceiver * const ngimuReceiver, const char * const address);
+void NgimuReceiverSetIgnoreUnrecognisedAddresses(NgimuReceiver * const ngimuReceiver, const bool ignoreUnrecognisedAddresses);
+void NgimuReceiverSetUnrecognisedMessageCallback(NgimuReceiver * const ngimuReceiver, bool (*newUnrecognisedMessageCallback)(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage, void * const unrecognisedMessageContext), void * const unrecognisedMessageContext);
+void NgimuReceiverSetTimeTagCallback(NgimuReceiver * const ngimuReceiver, void (*newTimeTagCallback)(const char * const oscAddressPattern, const size_t oscAddressPatternLength, const OscTimeTag * const oscTimeTag, void * const timeTagContext), void * const timeTagContext);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+void NgimuReceiverSetSensorsCallback(NgimuReceiver * const ngimuReceiver, void (*newSensorsCallback)(const NgimuSensors * const ngimuSensors, void * const userContext));
+void NgimuReceiverSetSensorsFields(NgimuReceiver * const ngimuReceiver, const unsigned int ngimuSensorsFields);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+void NgimuReceiverSetQuaternionCallback(NgimuReceiver * const ngimuReceiver, void (*newQuaternionCallback)(const NgimuQuaternion * const ngimuQuaternion, void * const userContext));
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+void NgimuReceiverSetEulerCallback(NgimuReceiver * const ngimuReceiver, void (*newEulerCallback)(const NgimuEuler * const ngimuEuler, void * const userContext));
+#endif
+void NgimuReceiverSetBundleCallback(NgimuReceiver * const ngimuReceiver, void (*newBundleCallback)(const NgimuBundle * const ngimuBundle, void * const userContext));
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+void NgimuReceiverSetSensorsQCallback(NgimuReceiver * const ngimuReceiver, void (*newSensorsQCallback)(const NgimuSensorsQ * const ngimuSensorsQ, void * const userContext));
+#endif
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+void NgimuReceiverSetQuaternionQCallback(NgimuReceiver * const ngimuReceiver, void (*newQuaternionQCallback)(const NgimuQuaternionQ * const ngimuQuaternionQ, void * const userContext));
+#endif
+void NgimuReceiverSetColumns(NgimuReceiver * const ngimuReceiver, NgimuColumns * const ngimuColumns);
+void NgimuReceiverProcessSerialByte(NgimuReceiver * const ngimuReceiver, const char byte);
+void NgimuReceiverProcessSerialBytes(NgimuReceiver * const ngimuReceiver, const char * const source, const size_t sourceSize);
+void NgimuReceiverProcessSerialBytesInPlace(NgimuReceiver * const ngimuReceiver, char * const source, const size_t sourceSize);
+void NgimuReceiverProcessUdpPacket(NgimuReceiver * const ngimuReceiver, const char * const source, const size_t sourceSize);
+void NgimuReceiverProcessUdpPackets(NgimuReceiver * const ngimuReceiver, const NgimuUdpPacket * const packets, const size_t numberOfPackets);
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+void NgimuReceiverSetCaptureCallback(NgimuReceiver * const ngimuReceiver, void (*newCaptureCallback)(const NgimuReceiveTransport transport, const char * const source, const size_t sourceSize, void * const captureContext), void * const captureContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+void NgimuReceiverSetDerivedEuler(NgimuReceiver * const ngimuReceiver, const bool deriveEuler, const NgimuDerivedAccuracy derivedAccuracy);
+void NgimuReceiverSetRotationMatrixCallback(NgimuReceiver * const ngimuReceiver, void (*newRotationMatrixCallback)(const NgimuRotationMatrix * const ngimuRotationMatrix, void * const userContext));
+#endif
+#if NGIMU_RECEIVE_ENABLE_STATISTICS
+void NgimuReceiverGetStatistics(const NgimuReceiver * const ngimuReceiver, NgimuReceiveStatistics * const ngimuReceiveStatistics);
+void NgimuReceiverResetStatistics(NgimuReceiver * const ngimuReceiver);
+#endif
 void NgimuReceiveInitialise();
 void NgimuReceiveSetReceiveErrorCallback(void (*newReceiveErrorCallback)(const char* const errorMessage));
+bool NgimuReceiveIgnoreAddress(const char * const address);
+void NgimuReceiveSetIgnoreUnrecognisedAddresses(const bool ignoreUnrecognisedAddresses);
+void NgimuReceiveSetUnrecognisedMessageCallback(bool (*newUnrecognisedMessageCallback)(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage, void * const unrecognisedMessageContext), void * const unrecognisedMessageContext);
+void NgimuReceiveSetTimeTagCallback(void (*newTimeTagCallback)(const char * const oscAddressPattern, const size_t oscAddressPatternLength, const OscTimeTag * const oscTimeTag, void * const timeTagContext), void * const timeTagContext);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
 void NgimuReceiveSetSensorsCallback(void (*newSensorsCallback)(const NgimuSensors ngimuSensors));
+void NgimuReceiveSetSensorsPointerCallback(void (*newSensorsPointerCallback)(const NgimuSensors * const ngimuSensors, void * const userContext), void * const userContext);
+void NgimuReceiveSetSensorsFields(const unsigned int ngimuSensorsFields);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
 void NgimuReceiveSetQuaternionCallback(void (*newQuaternionCallback)(const NgimuQuaternion ngimuQuaternion));
+void NgimuReceiveSetQuaternionPointerCallback(void (*newQuaternionPointerCallback)(const NgimuQuaternion * const ngimuQuaternion, void * const userContext), void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
 void NgimuReceiveSetEulerCallback(void (*newEulerCallback)(const NgimuEuler ngimuEuler));
+void NgimuReceiveSetEulerPointerCallback(void (*newEulerPointerCallback)(const NgimuEuler * const ngimuEuler, void * const userContext), void * const userContext);
+#endif
+void NgimuReceiveSetBundleCallback(void (*newBundleCallback)(const NgimuBundle ngimuBundle));
+void NgimuReceiveSetBundlePointerCallback(void (*newBundlePointerCallback)(const NgimuBundle * const ngimuBundle, void * const userContext), void * const userContext);
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_SENSORS
+void NgimuReceiveSetSensorsQCallback(void (*newSensorsQCallback)(const NgimuSensorsQ ngimuSensorsQ));
+void NgimuReceiveSetSensorsQPointerCallback(void (*newSensorsQPointerCallback)(const NgimuSensorsQ * const ngimuSensorsQ, void * const userContext), void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_FIXED_POINT && NGIMU_RECEIVE_ENABLE_QUATERNION
+void NgimuReceiveSetQuaternionQCallback(void (*newQuaternionQCallback)(const NgimuQuaternionQ ngimuQuaternionQ));
+void NgimuReceiveSetQuaternionQPointerCallback(void (*newQuaternionQPointerCallback)(const NgimuQuaternionQ * const ngimuQuaternionQ, void * const userContext), void * const userContext);
+#endif
+void NgimuReceiveSetColumns(NgimuColumns * const ngimuColumns);
 void NgimuReceiveProcessSerialByte(const char byte);
+void NgimuReceiveProcessSerialBytes(const char * const source, const size_t sourceSize);
+void NgimuReceiveProcessSerialBytesInPlace(char * const source, const size_t sourceSize);
 void NgimuReceiveProcessUdpPacket(const char * const source, const size_t sourceSize);
+void NgimuReceiveProcessUdpPackets(const NgimuUdpPacket * const packets, const size_t numberOfPackets);
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+void NgimuReceiveSetCaptureCallback(void (*newCaptureCallback)(const NgimuReceiveTransport transport, const char * const source, const size_t sourceSize, void * const captureContext), void * const captureContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_DERIVED
+void NgimuReceiveSetDerivedEuler(const bool deriveEuler, const NgimuDerivedAccuracy derivedAccuracy);
+void NgimuReceiveSetRotationMatrixCallback(void (*newRotationMatrixCallback)(const NgimuRotationMatrix ngimuRotationMatrix));
+void NgimuReceiveSetRotationMatrixPointerCallback(void (*newRotationMatrixPointerCallback)(const NgimuRotationMatrix * const ngimuRotationMatrix, void * const userContext), void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_STATISTICS
+void NgimuReceiveGetStatistics(NgimuReceiveStatistics * const ngimuReceiveStatistics);
+void NgimuReceiveResetStatistics();
+#endif
+void NgimuColumnsClear(NgimuColumns * const ngimuColumns);
+size_t NgimuReceiveErrorToString(const NgimuReceiveError * const ngimuReceiveError, char * const destination, const size_t destinationSize);
 
 #ifdef __cplusplus
 }
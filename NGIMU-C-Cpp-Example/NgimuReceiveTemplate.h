@@ -0,0 +1,272 @@
+/**
+ * @file NgimuReceiveTemplate.h
+ * @author Seb Madgwick
+ * @brief Header-only C++ wrapper of the receiver that dispatches decoded
+ * messages to the members of a handler type, e.g.
+ *
+ * struct Handler {
+ *     void onSensors(const NgimuSensors& ngimuSensors) { ... }
+ *     void onQuaternion(const NgimuQuaternion& ngimuQuaternion) { ... }
+ * };
+ * Ngimu::Receiver<Handler> receiver;
+ *
+ * The handler members are called directly by a callback of the wrapper
+ * instantiated for the handler type so that they may be inlined.  Callbacks
+ * are only assigned for the members that the handler type provides so message
+ * types without a member are not decoded.  The supported members are:
+ *
+ * void onReceiveError(const NgimuReceiveError& ngimuReceiveError)
+ * void onSensors(const NgimuSensors& ngimuSensors)
+ * void onQuaternion(const NgimuQuaternion& ngimuQuaternion)
+ * void onEuler(const NgimuEuler& ngimuEuler)
+ *
+ * A member that cannot be called with a const reference argument, e.g.
+ * onSensors(NgimuSensors&), or a misspelt member is not detected and the
+ * message type is not decoded.  Compilation fails if the handler type provides
+ * none of the members.  Requires C++11.
+ */
+
+#ifndef NGIMU_RECEIVE_TEMPLATE_H
+#define NGIMU_RECEIVE_TEMPLATE_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuReceive.h"
+#include <stddef.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+namespace Ngimu {
+
+    namespace Detail {
+
+        /**
+         * @brief Compile-time boolean used to select an overload.
+         */
+        template<bool value>
+        struct Bool {
+        };
+
+        /**
+         * @brief Declaration of a value of any type for use in unevaluated
+         * expressions.  Equivalent to std::declval, which is not available on
+         * all Arduino platforms.
+         */
+        template<typename Type>
+        Type& DeclareValue();
+
+        /**
+         * @brief Type of void for any valid expression.
+         */
+        template<typename Type>
+        struct Void {
+            typedef void type;
+        };
+
+        /**
+         * @brief Defines a trait with a value of true if the handler type has a
+         * member that may be called with an argument of the message type.
+         */
+#define NGIMU_RECEIVE_TEMPLATE_HAS_MEMBER(trait, member, messageType) \
+        template<typename Handler, typename Enable = void> \
+        struct trait { \
+            static const bool value = false; \
+        }; \
+        template<typename Handler> \
+        struct trait<Handler, typename Void<decltype(DeclareValue<Handler>().member(DeclareValue<const messageType>()))>::type> { \
+            static const bool value = true; \
+        };
+
+        NGIMU_RECEIVE_TEMPLATE_HAS_MEMBER(HasOnReceiveError, onReceiveError, NgimuReceiveError)
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+        NGIMU_RECEIVE_TEMPLATE_HAS_MEMBER(HasOnSensors, onSensors, NgimuSensors)
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+        NGIMU_RECEIVE_TEMPLATE_HAS_MEMBER(HasOnQuaternion, onQuaternion, NgimuQuaternion)
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+        NGIMU_RECEIVE_TEMPLATE_HAS_MEMBER(HasOnEuler, onEuler, NgimuEuler)
+#endif
+
+#undef NGIMU_RECEIVE_TEMPLATE_HAS_MEMBER
+
+        /**
+         * @brief Trait with a value of true if the handler type has any of the
+         * supported members.
+         */
+        template<typename Handler>
+        struct HasAnyMember {
+            static const bool value = HasOnReceiveError<Handler>::value
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+                    || HasOnSensors<Handler>::value
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+                    || HasOnQuaternion<Handler>::value
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+                    || HasOnEuler<Handler>::value
+#endif
+                    ;
+        };
+
+    } // namespace Detail
+
+    /**
+     * @brief Receiver that dispatches decoded messages to a handler.  The
+     * receiver cannot be copied because its address is the user context of
+     * the underlying receiver structure.
+     */
+    template<typename Handler>
+    class Receiver {
+        static_assert(Detail::HasAnyMember<Handler>::value, "Handler must provide a member such as void onSensors(const NgimuSensors&)");
+
+    public:
+
+        /**
+         * @brief Constructor.
+         * @param handler Handler.
+         */
+        explicit Receiver(const Handler& handler = Handler()) : handler(handler) {
+            NgimuReceiverInitialise(&ngimuReceiver);
+            NgimuReceiverSetUserContext(&ngimuReceiver, this);
+            assignReceiveErrorCallback(Detail::Bool<Detail::HasOnReceiveError<Handler>::value>());
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+            assignSensorsCallback(Detail::Bool<Detail::HasOnSensors<Handler>::value>());
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+            assignQuaternionCallback(Detail::Bool<Detail::HasOnQuaternion<Handler>::value>());
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+            assignEulerCallback(Detail::Bool<Detail::HasOnEuler<Handler>::value>());
+#endif
+        }
+
+        Receiver(const Receiver&) = delete;
+
+        Receiver& operator=(const Receiver&) = delete;
+
+        /**
+         * @brief Returns the handler.
+         * @return Handler.
+         */
+        Handler& getHandler() {
+            return handler;
+        }
+
+        /**
+         * @brief Returns the underlying receiver structure so that the C API
+         * may be used for other settings, e.g. NgimuReceiverIgnoreAddress.  The
+         * user context and the callbacks assigned by the wrapper must not be
+         * modified.
+         * @return Address of receiver structure.
+         */
+        NgimuReceiver* get() {
+            return &ngimuReceiver;
+        }
+
+        /**
+         * @brief Processes byte received via serial.  See
+         * NgimuReceiverProcessSerialByte.
+         * @param byte Byte received via serial.
+         */
+        void processSerialByte(const char byte) {
+            NgimuReceiverProcessSerialByte(&ngimuReceiver, byte);
+        }
+
+        /**
+         * @brief Processes block of bytes received via serial.  See
+         * NgimuReceiverProcessSerialBytes.
+         * @param source Bytes received via serial.
+         * @param sourceSize Number of bytes.
+         */
+        void processSerialBytes(const char * const source, const size_t sourceSize) {
+            NgimuReceiverProcessSerialBytes(&ngimuReceiver, source, sourceSize);
+        }
+
+        /**
+         * @brief Processes block of bytes received via serial in place.  See
+         * NgimuReceiverProcessSerialBytesInPlace.
+         * @param source Bytes received via serial.
+         * @param sourceSize Number of bytes.
+         */
+        void processSerialBytesInPlace(char * const source, const size_t sourceSize) {
+            NgimuReceiverProcessSerialBytesInPlace(&ngimuReceiver, source, sourceSize);
+        }
+
+        /**
+         * @brief Processes packet received via UDP.  See
+         * NgimuReceiverProcessUdpPacket.
+         * @param source Packet received via UDP.
+         * @param sourceSize Packet size.
+         */
+        void processUdpPacket(const char * const source, const size_t sourceSize) {
+            NgimuReceiverProcessUdpPacket(&ngimuReceiver, source, sourceSize);
+        }
+
+    private:
+
+        NgimuReceiver ngimuReceiver;
+        Handler handler;
+
+        void assignReceiveErrorCallback(Detail::Bool<false>) {
+        }
+
+        void assignReceiveErrorCallback(Detail::Bool<true>) {
+            NgimuReceiverSetReceiveErrorCallback(&ngimuReceiver, receiveErrorCallback);
+        }
+
+        static void receiveErrorCallback(const NgimuReceiveError * const ngimuReceiveError, void * const userContext) {
+            static_cast<Receiver *> (userContext)->handler.onReceiveError(*ngimuReceiveError);
+        }
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+
+        void assignSensorsCallback(Detail::Bool<false>) {
+        }
+
+        void assignSensorsCallback(Detail::Bool<true>) {
+            NgimuReceiverSetSensorsCallback(&ngimuReceiver, sensorsCallback);
+        }
+
+        static void sensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+            static_cast<Receiver *> (userContext)->handler.onSensors(*ngimuSensors);
+        }
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+
+        void assignQuaternionCallback(Detail::Bool<false>) {
+        }
+
+        void assignQuaternionCallback(Detail::Bool<true>) {
+            NgimuReceiverSetQuaternionCallback(&ngimuReceiver, quaternionCallback);
+        }
+
+        static void quaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+            static_cast<Receiver *> (userContext)->handler.onQuaternion(*ngimuQuaternion);
+        }
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+
+        void assignEulerCallback(Detail::Bool<false>) {
+        }
+
+        void assignEulerCallback(Detail::Bool<true>) {
+            NgimuReceiverSetEulerCallback(&ngimuReceiver, eulerCallback);
+        }
+
+        static void eulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+            static_cast<Receiver *> (userContext)->handler.onEuler(*ngimuEuler);
+        }
+#endif
+    };
+
+} // namespace Ngimu
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
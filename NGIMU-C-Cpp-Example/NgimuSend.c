@@ -0,0 +1,379 @@
+/**
+ * @file NgimuSend.c
+ * @author Seb Madgwick
+ * @brief Module for sending setting reads, setting writes and commands to an
+ * NGIMU.  Messages are encoded directly into a buffer provided by the
+ * application, with SLIP encoding for serial, without dynamic memory or
+ * formatted printing.  A tracker matches the responses of pending requests so
+ * that several requests may be in flight at once.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuSend.h"
+#include <string.h> // memcmp, memcpy, memset, strlen
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Encoder state.  Bytes are SLIP encoded as they are written if the
+ * transport is serial.  Bytes that do not fit in the destination are counted
+ * but not written so that the encoder need not check for space at each step.
+ */
+typedef struct {
+    char* destination;
+    size_t destinationSize;
+    size_t index;
+    bool slip;
+} Encoder;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static void WriteByte(Encoder * const encoder, const char byte);
+static void WriteString(Encoder * const encoder, const char * const string);
+static void WriteBigEndian32(Encoder * const encoder, const uint32_t value);
+
+//------------------------------------------------------------------------------
+// Functions - Encoding
+
+/**
+ * @brief Encodes a message to be sent to the NGIMU.  A message with no
+ * argument reads a setting or sends a command.  A message with an argument
+ * writes a setting.
+ * @param transport Transport.  The message is SLIP encoded for serial.
+ * @param address Address, e.g. NGIMU_SEND_RATE_SENSORS.
+ * @param argument Address of argument structure, or NULL for no argument.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param size Address of the encoded size to be written.
+ * @return Error code (0 if successful).
+ */
+OscError NgimuSendEncode(const NgimuReceiveTransport transport, const char * const address, const NgimuSendArgument * const argument, char * const destination, const size_t destinationSize, size_t * const size) {
+
+    // Check address
+    if (address[0] != '/') {
+        return OscErrorNoSlashAtStartOfMessage;
+    }
+
+    // Initialise encoder
+    Encoder encoder;
+    encoder.destination = destination;
+    encoder.destinationSize = destinationSize;
+    encoder.index = 0;
+    encoder.slip = transport == NgimuReceiveTransportSerial;
+
+    // Write address
+    WriteString(&encoder, address);
+
+    // Write type tag string and argument
+    const NgimuSendArgumentType type = (argument == NULL) ? NgimuSendArgumentTypeNone : argument->type;
+    switch (type) {
+        case NgimuSendArgumentTypeNone:
+            WriteString(&encoder, ",");
+            break;
+        case NgimuSendArgumentTypeInt32:
+            WriteString(&encoder, ",i");
+            WriteBigEndian32(&encoder, (uint32_t) argument->value.int32);
+            break;
+        case NgimuSendArgumentTypeFloat32:
+        {
+            uint32_t value;
+            memcpy(&value, &argument->value.float32, sizeof (value));
+            WriteString(&encoder, ",f");
+            WriteBigEndian32(&encoder, value);
+            break;
+        }
+        case NgimuSendArgumentTypeBool:
+            WriteString(&encoder, argument->value.boolean ? ",T" : ",F");
+            break;
+        case NgimuSendArgumentTypeString:
+            WriteString(&encoder, ",s");
+            WriteString(&encoder, argument->value.string);
+            break;
+    }
+
+    // Terminate SLIP packet
+    if (encoder.slip) {
+        encoder.index++;
+        if (encoder.index <= encoder.destinationSize) {
+            encoder.destination[encoder.index - 1] = SLIP_END;
+        }
+    }
+
+    // Check size
+    if (encoder.index > destinationSize) {
+        return OscErrorDestinationTooSmall;
+    }
+    *size = encoder.index;
+    return OscErrorNone;
+}
+
+/**
+ * @brief Encodes a setting read.  The NGIMU responds with the setting value.
+ * @param transport Transport.
+ * @param address Address, e.g. NGIMU_SEND_RATE_SENSORS.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param size Address of the encoded size to be written.
+ * @return Error code (0 if successful).
+ */
+OscError NgimuSendEncodeRead(const NgimuReceiveTransport transport, const char * const address, char * const destination, const size_t destinationSize, size_t * const size) {
+    return NgimuSendEncode(transport, address, NULL, destination, destinationSize, size);
+}
+
+/**
+ * @brief Encodes a 32-bit integer setting write.  The NGIMU responds with the
+ * new setting value.
+ * @param transport Transport.
+ * @param address Address.
+ * @param int32 Value.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param size Address of the encoded size to be written.
+ * @return Error code (0 if successful).
+ */
+OscError NgimuSendEncodeWriteInt32(const NgimuReceiveTransport transport, const char * const address, const int32_t int32, char * const destination, const size_t destinationSize, size_t * const size) {
+    NgimuSendArgument argument;
+    argument.type = NgimuSendArgumentTypeInt32;
+    argument.value.int32 = int32;
+    return NgimuSendEncode(transport, address, &argument, destination, destinationSize, size);
+}
+
+/**
+ * @brief Encodes a 32-bit float setting write, e.g. a message rate in Hz.  The
+ * NGIMU responds with the new setting value.
+ * @param transport Transport.
+ * @param address Address, e.g. NGIMU_SEND_RATE_SENSORS.
+ * @param float32 Value.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param size Address of the encoded size to be written.
+ * @return Error code (0 if successful).
+ */
+OscError NgimuSendEncodeWriteFloat32(const NgimuReceiveTransport transport, const char * const address, const float float32, char * const destination, const size_t destinationSize, size_t * const size) {
+    NgimuSendArgument argument;
+    argument.type = NgimuSendArgumentTypeFloat32;
+    argument.value.float32 = float32;
+    return NgimuSendEncode(transport, address, &argument, destination, destinationSize, size);
+}
+
+/**
+ * @brief Encodes a boolean setting write.  The NGIMU responds with the new
+ * setting value.
+ * @param transport Transport.
+ * @param address Address.
+ * @param boolean Value.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param size Address of the encoded size to be written.
+ * @return Error code (0 if successful).
+ */
+OscError NgimuSendEncodeWriteBool(const NgimuReceiveTransport transport, const char * const address, const bool boolean, char * const destination, const size_t destinationSize, size_t * const size) {
+    NgimuSendArgument argument;
+    argument.type = NgimuSendArgumentTypeBool;
+    argument.value.boolean = boolean;
+    return NgimuSendEncode(transport, address, &argument, destination, destinationSize, size);
+}
+
+/**
+ * @brief Writes byte, SLIP encoded if required.
+ * @param encoder Address of encoder structure.
+ * @param byte Byte.
+ */
+static void WriteByte(Encoder * const encoder, const char byte) {
+    char escaped = byte;
+    if (encoder->slip && ((byte == SLIP_END) || (byte == SLIP_ESC))) {
+        if (encoder->index < encoder->destinationSize) {
+            encoder->destination[encoder->index] = SLIP_ESC;
+        }
+        encoder->index++;
+        escaped = (byte == SLIP_END) ? SLIP_ESC_END : SLIP_ESC_ESC;
+    }
+    if (encoder->index < encoder->destinationSize) {
+        encoder->destination[encoder->index] = escaped;
+    }
+    encoder->index++;
+}
+
+/**
+ * @brief Writes OSC string.  The string is terminated by at least one null
+ * character and padded to a multiple of four bytes.
+ * @param encoder Address of encoder structure.
+ * @param string String.
+ */
+static void WriteString(Encoder * const encoder, const char * const string) {
+    const size_t length = strlen(string);
+    size_t index;
+    for (index = 0; index < length; index++) {
+        WriteByte(encoder, string[index]);
+    }
+    const size_t paddedLength = (length + 4) & ~((size_t) 3);
+    for (; index < paddedLength; index++) {
+        WriteByte(encoder, '\0');
+    }
+}
+
+/**
+ * @brief Writes 32-bit value in big-endian byte order.
+ * @param encoder Address of encoder structure.
+ * @param value Value.
+ */
+static void WriteBigEndian32(Encoder * const encoder, const uint32_t value) {
+    WriteByte(encoder, (char) (value >> 24));
+    WriteByte(encoder, (char) (value >> 16));
+    WriteByte(encoder, (char) (value >> 8));
+    WriteByte(encoder, (char) value);
+}
+
+//------------------------------------------------------------------------------
+// Functions - Request tracker
+
+/**
+ * @brief Initialises request tracker.  This function must be called before
+ * the tracker is used.
+ * @param ngimuSendTracker Address of tracker structure.
+ * @param timeout Time after which a pending request times out, in the units
+ * of the times provided to NgimuSendTrackerAdd and NgimuSendTrackerUpdate.
+ */
+void NgimuSendTrackerInitialise(NgimuSendTracker * const ngimuSendTracker, const uint32_t timeout) {
+    memset(ngimuSendTracker, 0, sizeof (*ngimuSendTracker));
+    ngimuSendTracker->timeout = timeout;
+}
+
+/**
+ * @brief Sets response callback function.  The callback is called once for
+ * each request, either with the response or when the request times out.
+ * @param ngimuSendTracker Address of tracker structure.
+ * @param newResponseCallback Response callback function.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuSendTrackerSetResponseCallback(NgimuSendTracker * const ngimuSendTracker, void (*newResponseCallback)(const NgimuSendResponse * const ngimuSendResponse, void * const userContext), void * const userContext) {
+    ngimuSendTracker->responseCallback = newResponseCallback;
+    ngimuSendTracker->userContext = userContext;
+}
+
+/**
+ * @brief Assigns the receiver unrecognised message callback so that responses
+ * received by the receiver are matched to pending requests.
+ * @param ngimuSendTracker Address of tracker structure.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+void NgimuSendTrackerSetReceiverCallbacks(NgimuSendTracker * const ngimuSendTracker, NgimuReceiver * const ngimuReceiver) {
+    NgimuReceiverSetUnrecognisedMessageCallback(ngimuReceiver, NgimuSendTrackerUnrecognisedMessageCallback, ngimuSendTracker);
+}
+
+/**
+ * @brief Adds a pending request.  This function should be called when a
+ * setting read or write is sent.  Several requests may be pending for the
+ * same address and are matched to responses in the order that they were
+ * sent.  The address is not copied and must remain valid until the response
+ * callback.
+ * @param ngimuSendTracker Address of tracker structure.
+ * @param address Address, e.g. NGIMU_SEND_RATE_SENSORS.
+ * @param sendTime Time that the request was sent.
+ * @return True if successful, false if the maximum number of requests are
+ * pending.
+ */
+bool NgimuSendTrackerAdd(NgimuSendTracker * const ngimuSendTracker, const char * const address, const uint32_t sendTime) {
+    size_t index;
+    for (index = 0; index < NGIMU_SEND_MAX_PENDING_REQUESTS; index++) {
+        NgimuSendRequest * const request = &ngimuSendTracker->requests[index];
+        if (request->pending) {
+            continue;
+        }
+        request->pending = true;
+        request->address = address;
+        request->addressLength = strlen(address);
+        request->sendTime = sendTime;
+        request->sequence = ngimuSendTracker->sequence++;
+        ngimuSendTracker->numberOfPendingRequests++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Unrecognised message callback that matches the message to the oldest
+ * pending request with the same address.  May be assigned to a receiver with
+ * the tracker as the context.
+ * @param oscTimeTag OSC time tag associated with message.
+ * @param oscMessage Address of OSC message.
+ * @param unrecognisedMessageContext Address of tracker structure.
+ * @return True if the message was a response to a pending request.
+ */
+bool NgimuSendTrackerUnrecognisedMessageCallback(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage, void * const unrecognisedMessageContext) {
+    NgimuSendTracker * const ngimuSendTracker = (NgimuSendTracker *) unrecognisedMessageContext;
+
+    // Find oldest pending request with matching address
+    NgimuSendRequest* oldest = NULL;
+    size_t index;
+    for (index = 0; index < NGIMU_SEND_MAX_PENDING_REQUESTS; index++) {
+        NgimuSendRequest * const request = &ngimuSendTracker->requests[index];
+        if ((request->pending == false) || (request->addressLength != oscMessage->oscAddressPatternLength)) {
+            continue;
+        }
+        if (memcmp(request->address, oscMessage->oscAddressPattern, request->addressLength) != 0) {
+            continue;
+        }
+        if ((oldest == NULL) || ((int32_t) (request->sequence - oldest->sequence) < 0)) {
+            oldest = request;
+        }
+    }
+    if (oldest == NULL) {
+        return false;
+    }
+
+    // Complete request
+    oldest->pending = false;
+    ngimuSendTracker->numberOfPendingRequests--;
+    if (ngimuSendTracker->responseCallback != NULL) {
+        NgimuSendResponse response;
+        response.result = NgimuSendResultResponse;
+        response.address = oldest->address;
+        response.sendTime = oldest->sendTime;
+        response.oscMessage = oscMessage;
+        ngimuSendTracker->responseCallback(&response, ngimuSendTracker->userContext);
+    }
+    return true;
+}
+
+/**
+ * @brief Times out pending requests.  This function should be called
+ * periodically.
+ * @param ngimuSendTracker Address of tracker structure.
+ * @param time Current time.
+ */
+void NgimuSendTrackerUpdate(NgimuSendTracker * const ngimuSendTracker, const uint32_t time) {
+    size_t index;
+    for (index = 0; index < NGIMU_SEND_MAX_PENDING_REQUESTS; index++) {
+        NgimuSendRequest * const request = &ngimuSendTracker->requests[index];
+        if ((request->pending == false) || ((uint32_t) (time - request->sendTime) < ngimuSendTracker->timeout)) {
+            continue;
+        }
+        request->pending = false;
+        ngimuSendTracker->numberOfPendingRequests--;
+        if (ngimuSendTracker->responseCallback != NULL) {
+            NgimuSendResponse response;
+            response.result = NgimuSendResultTimeout;
+            response.address = request->address;
+            response.sendTime = request->sendTime;
+            response.oscMessage = NULL;
+            ngimuSendTracker->responseCallback(&response, ngimuSendTracker->userContext);
+        }
+    }
+}
+
+/**
+ * @brief Returns the number of pending requests.
+ * @param ngimuSendTracker Address of tracker structure.
+ * @return Number of pending requests.
+ */
+size_t NgimuSendTrackerGetNumberOfPendingRequests(const NgimuSendTracker * const ngimuSendTracker) {
+    return ngimuSendTracker->numberOfPendingRequests;
+}
+
+//------------------------------------------------------------------------------
+// End of file
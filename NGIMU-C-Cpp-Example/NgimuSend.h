@@ -0,0 +1,138 @@
+/**
+ * @file NgimuSend.h
+ * @author Seb Madgwick
+ * @brief Module for sending setting reads, setting writes and commands to an
+ * NGIMU.  Messages are encoded directly into a buffer provided by the
+ * application, with SLIP encoding for serial, without dynamic memory or
+ * formatted printing.  A tracker matches the responses of pending requests so
+ * that several requests may be in flight at once.
+ */
+
+#ifndef NGIMU_SEND_H
+#define NGIMU_SEND_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuReceive.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Setting addresses.
+ */
+#define NGIMU_SEND_RATE_SENSORS "/rate/sensors"
+#define NGIMU_SEND_RATE_QUATERNION "/rate/quaternion"
+#define NGIMU_SEND_RATE_EULER "/rate/euler"
+
+/**
+ * @brief Maximum number of requests that may be pending at once.
+ */
+#ifndef NGIMU_SEND_MAX_PENDING_REQUESTS
+#define NGIMU_SEND_MAX_PENDING_REQUESTS (8)
+#endif
+
+/**
+ * @brief Argument types.  A message with no argument reads a setting or sends
+ * a command.
+ */
+typedef enum {
+    NgimuSendArgumentTypeNone,
+    NgimuSendArgumentTypeInt32,
+    NgimuSendArgumentTypeFloat32,
+    NgimuSendArgumentTypeBool,
+    NgimuSendArgumentTypeString,
+} NgimuSendArgumentType;
+
+/**
+ * @brief Argument.  A string argument is not copied and need only be valid
+ * until the message has been encoded.
+ */
+typedef struct {
+    NgimuSendArgumentType type;
+
+    union {
+        int32_t int32;
+        float float32;
+        bool boolean;
+        const char* string;
+    } value;
+} NgimuSendArgument;
+
+/**
+ * @brief Request results.
+ */
+typedef enum {
+    NgimuSendResultResponse,
+    NgimuSendResultTimeout,
+} NgimuSendResult;
+
+/**
+ * @brief Response to a request.  The OSC message is NULL if the request timed
+ * out and is otherwise only valid for the duration of the callback.  Times are
+ * in the units provided by the application.
+ */
+typedef struct {
+    NgimuSendResult result;
+    const char* address;
+    uint32_t sendTime;
+    OscMessage* oscMessage;
+} NgimuSendResponse;
+
+/**
+ * @brief Pending request.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    bool pending;
+    const char* address;
+    size_t addressLength;
+    uint32_t sendTime;
+    uint32_t sequence;
+} NgimuSendRequest;
+
+/**
+ * @brief Request tracker structure.  Structure members are used internally and
+ * should not be used by the user application.
+ */
+typedef struct {
+    NgimuSendRequest requests[NGIMU_SEND_MAX_PENDING_REQUESTS];
+    size_t numberOfPendingRequests;
+    uint32_t sequence;
+    uint32_t timeout;
+    void (*responseCallback)(const NgimuSendResponse * const ngimuSendResponse, void * const userContext);
+    void* userContext;
+} NgimuSendTracker;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+OscError NgimuSendEncode(const NgimuReceiveTransport transport, const char * const address, const NgimuSendArgument * const argument, char * const destination, const size_t destinationSize, size_t * const size);
+OscError NgimuSendEncodeRead(const NgimuReceiveTransport transport, const char * const address, char * const destination, const size_t destinationSize, size_t * const size);
+OscError NgimuSendEncodeWriteInt32(const NgimuReceiveTransport transport, const char * const address, const int32_t int32, char * const destination, const size_t destinationSize, size_t * const size);
+OscError NgimuSendEncodeWriteFloat32(const NgimuReceiveTransport transport, const char * const address, const float float32, char * const destination, const size_t destinationSize, size_t * const size);
+OscError NgimuSendEncodeWriteBool(const NgimuReceiveTransport transport, const char * const address, const bool boolean, char * const destination, const size_t destinationSize, size_t * const size);
+void NgimuSendTrackerInitialise(NgimuSendTracker * const ngimuSendTracker, const uint32_t timeout);
+void NgimuSendTrackerSetResponseCallback(NgimuSendTracker * const ngimuSendTracker, void (*newResponseCallback)(const NgimuSendResponse * const ngimuSendResponse, void * const userContext), void * const userContext);
+void NgimuSendTrackerSetReceiverCallbacks(NgimuSendTracker * const ngimuSendTracker, NgimuReceiver * const ngimuReceiver);
+bool NgimuSendTrackerAdd(NgimuSendTracker * const ngimuSendTracker, const char * const address, const uint32_t sendTime);
+bool NgimuSendTrackerUnrecognisedMessageCallback(const OscTimeTag * const oscTimeTag, OscMessage * const oscMessage, void * const unrecognisedMessageContext);
+void NgimuSendTrackerUpdate(NgimuSendTracker * const ngimuSendTracker, const uint32_t time);
+size_t NgimuSendTrackerGetNumberOfPendingRequests(const NgimuSendTracker * const ngimuSendTracker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,199 @@
+/**
+ * @file NgimuSerialDma.cpp
+ * @author Seb Madgwick
+ * @brief Serial front end that receives bytes from an NGIMU into a circular DMA
+ * buffer and passes each completed chunk to the block decoder from interrupt
+ * context, so that the main loop does not need to poll the UART.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuSerialDma.h"
+#include <stddef.h>
+
+#if defined(KINETISK)
+#include <DMAChannel.h>
+#endif
+
+#if defined(KINETISK) || (defined(USE_HAL_DRIVER) && defined(HAL_UART_MODULE_ENABLED) && !defined(ARDUINO))
+
+//------------------------------------------------------------------------------
+// Variable declarations
+
+static volatile uint8_t dmaBuffer[NGIMU_SERIAL_DMA_BUFFER_SIZE] __attribute__((aligned(NGIMU_SERIAL_DMA_BUFFER_SIZE)));
+static size_t readIndex;
+static NgimuReceiver* ngimuReceiver;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static void ProcessDmaBuffer(const size_t writeIndex);
+static void ProcessChunk(const size_t index, const size_t numberOfBytes);
+
+//------------------------------------------------------------------------------
+// Functions - Common
+
+/**
+ * @brief Processes all bytes written by the DMA since the previous call.
+ * @param writeIndex Index of the next byte to be written by the DMA.
+ */
+static void ProcessDmaBuffer(const size_t writeIndex) {
+    if (writeIndex < readIndex) {
+        ProcessChunk(readIndex, NGIMU_SERIAL_DMA_BUFFER_SIZE - readIndex);
+        readIndex = 0;
+    }
+    if (writeIndex > readIndex) {
+        ProcessChunk(readIndex, writeIndex - readIndex);
+        readIndex = writeIndex;
+    }
+}
+
+/**
+ * @brief Passes a contiguous chunk of the DMA buffer to the block decoder.
+ * @param index Index of the first byte.
+ * @param numberOfBytes Number of bytes.
+ */
+static void ProcessChunk(const size_t index, const size_t numberOfBytes) {
+#if NGIMU_SERIAL_DMA_IN_PLACE
+    char * const chunk = (char *) &dmaBuffer[index];
+    if (ngimuReceiver == NULL) {
+        NgimuReceiveProcessSerialBytesInPlace(chunk, numberOfBytes);
+    } else {
+        NgimuReceiverProcessSerialBytesInPlace(ngimuReceiver, chunk, numberOfBytes);
+    }
+#else
+    const char * const chunk = (const char *) &dmaBuffer[index];
+    if (ngimuReceiver == NULL) {
+        NgimuReceiveProcessSerialBytes(chunk, numberOfBytes);
+    } else {
+        NgimuReceiverProcessSerialBytes(ngimuReceiver, chunk, numberOfBytes);
+    }
+#endif
+}
+
+#endif
+
+#if defined(KINETISK)
+
+//------------------------------------------------------------------------------
+// Variable declarations - Teensy 3.x
+
+static DMAChannel dmaChannel;
+static IntervalTimer flushTimer;
+
+//------------------------------------------------------------------------------
+// Function prototypes - Teensy 3.x
+
+static size_t GetWriteIndex();
+static void DmaInterrupt();
+static void FlushInterrupt();
+
+//------------------------------------------------------------------------------
+// Functions - Teensy 3.x
+
+/**
+ * @brief Initialises Serial1 and starts receiving by DMA.  This function
+ * should be called once on system start up instead of Serial1.begin().
+ * @param newNgimuReceiver Address of receiver structure, or NULL to use the
+ * default receiver.
+ * @param baudRate Baud rate.  Must match NGIMU settings.
+ */
+void NgimuSerialDmaBegin(NgimuReceiver * const newNgimuReceiver, const uint32_t baudRate) {
+    ngimuReceiver = newNgimuReceiver;
+    readIndex = 0;
+
+    // Initialise UART
+    Serial1.begin(baudRate);
+
+    // Route receive requests to DMA and disable the idle line interrupt so
+    // that the Serial1 interrupt does not read the receive FIFO
+    UART0_C2 &= ~UART_C2_ILIE;
+    UART0_RWFIFO = 1;
+    UART0_C5 |= UART_C5_RDMAS;
+
+    // Configure DMA channel
+    dmaChannel.source(UART0_D);
+    dmaChannel.destinationCircular(dmaBuffer, sizeof (dmaBuffer));
+    dmaChannel.triggerAtHardwareEvent(DMAMUX_SOURCE_UART0_RX);
+    dmaChannel.interruptAtHalf();
+    dmaChannel.interruptAtCompletion();
+    dmaChannel.attachInterrupt(DmaInterrupt);
+    NVIC_SET_PRIORITY(IRQ_DMA_CH0 + dmaChannel.channel, NGIMU_SERIAL_DMA_PRIORITY);
+    dmaChannel.enable();
+
+    // Start flush timer
+    flushTimer.priority(NGIMU_SERIAL_DMA_PRIORITY);
+    flushTimer.begin(FlushInterrupt, NGIMU_SERIAL_DMA_FLUSH_PERIOD);
+}
+
+/**
+ * @brief Returns the index of the next byte to be written by the DMA.
+ * @return Index of the next byte to be written by the DMA.
+ */
+static size_t GetWriteIndex() {
+    return ((uintptr_t) dmaChannel.destinationAddress() - (uintptr_t) dmaBuffer) & (NGIMU_SERIAL_DMA_BUFFER_SIZE - 1);
+}
+
+/**
+ * @brief DMA half and full transfer interrupt.
+ */
+static void DmaInterrupt() {
+    dmaChannel.clearInterrupt();
+    ProcessDmaBuffer(GetWriteIndex());
+}
+
+/**
+ * @brief Flush timer interrupt.  Processes bytes received since the last DMA
+ * interrupt so that the end of a packet is not delayed until the half or full
+ * transfer.
+ */
+static void FlushInterrupt() {
+    ProcessDmaBuffer(GetWriteIndex());
+}
+
+#endif
+
+#if defined(USE_HAL_DRIVER) && defined(HAL_UART_MODULE_ENABLED) && !defined(ARDUINO)
+
+//------------------------------------------------------------------------------
+// Variable declarations - STM32
+
+static UART_HandleTypeDef* uartHandle;
+
+//------------------------------------------------------------------------------
+// Functions - STM32
+
+/**
+ * @brief Starts receiving by DMA.  The UART receive DMA stream must be
+ * configured in circular mode.
+ * @param newNgimuReceiver Address of receiver structure, or NULL to use the
+ * default receiver.
+ * @param huart UART handle.
+ */
+void NgimuSerialDmaBeginStm32(NgimuReceiver * const newNgimuReceiver, UART_HandleTypeDef * const huart) {
+    ngimuReceiver = newNgimuReceiver;
+    uartHandle = huart;
+    readIndex = 0;
+    HAL_UARTEx_ReceiveToIdle_DMA(huart, (uint8_t *) dmaBuffer, sizeof (dmaBuffer));
+}
+
+/**
+ * @brief Processes received bytes.  This function must be called from
+ * HAL_UARTEx_RxEventCallback().  Events of UARTs other than the UART passed to
+ * NgimuSerialDmaBeginStm32() are ignored.
+ * @param huart UART handle.
+ * @param size Index of the next byte to be written by the DMA, as provided by
+ * HAL_UARTEx_RxEventCallback().
+ */
+void NgimuSerialDmaRxEventStm32(UART_HandleTypeDef * const huart, const uint16_t size) {
+    if (huart != uartHandle) {
+        return;
+    }
+    ProcessDmaBuffer(size & (NGIMU_SERIAL_DMA_BUFFER_SIZE - 1));
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
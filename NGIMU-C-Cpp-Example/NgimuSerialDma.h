@@ -0,0 +1,86 @@
+/**
+ * @file NgimuSerialDma.h
+ * @author Seb Madgwick
+ * @brief Serial front end that receives bytes from an NGIMU into a circular DMA
+ * buffer and passes each completed chunk to the block decoder from interrupt
+ * context, so that the main loop does not need to poll the UART.
+ *
+ * Teensy 3.x (Serial1):
+ * Call NgimuSerialDmaBegin() instead of Serial1.begin().  Chunks are processed
+ * on the DMA half and full transfer interrupts, and by a periodic flush timer
+ * that processes partially filled halves (equivalent to an idle line
+ * interrupt).
+ *
+ * STM32 (HAL):
+ * Configure the UART receive DMA stream in circular mode, call
+ * NgimuSerialDmaBeginStm32() and call NgimuSerialDmaRxEventStm32() from
+ * HAL_UARTEx_RxEventCallback().  HAL_UARTEx_ReceiveToIdle_DMA() raises the
+ * event on half transfer, full transfer and idle line.  On devices with a data
+ * cache (e.g. STM32F7/H7) the buffer must be placed in non-cacheable memory.
+ *
+ * Callbacks are executed in interrupt context.
+ */
+
+#ifndef NGIMU_SERIAL_DMA_H
+#define NGIMU_SERIAL_DMA_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#elif defined(USE_HAL_DRIVER)
+#include "main.h" // STM32CubeMX HAL includes
+#endif
+#include "NgimuReceive.h"
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief DMA buffer size.  Must be a power of two.  Half of the buffer must be
+ * able to hold the bytes received during the worst case interrupt latency.
+ */
+#ifndef NGIMU_SERIAL_DMA_BUFFER_SIZE
+#define NGIMU_SERIAL_DMA_BUFFER_SIZE (256)
+#endif
+
+/**
+ * @brief Set to 1 to decode the SLIP encoding in place in the DMA buffer so
+ * that packets are only copied to the receiver SLIP decoder buffer on
+ * wrap-around of the DMA buffer.  NGIMU_RECEIVER_SLIP_BUFFER_SIZE may then be
+ * reduced to the size of the largest packet.  Encoded packets must be shorter
+ * than half of the DMA buffer so that an incomplete packet is not overwritten
+ * by the DMA before it is completed.
+ */
+#ifndef NGIMU_SERIAL_DMA_IN_PLACE
+#define NGIMU_SERIAL_DMA_IN_PLACE (0)
+#endif
+
+/**
+ * @brief Interrupt priority of the DMA and flush timer interrupts.  Both use
+ * the same priority so that they cannot preempt each other.
+ */
+#define NGIMU_SERIAL_DMA_PRIORITY (128)
+
+/**
+ * @brief Flush timer period in microseconds.
+ */
+#define NGIMU_SERIAL_DMA_FLUSH_PERIOD (500)
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+#if defined(KINETISK)
+void NgimuSerialDmaBegin(NgimuReceiver * const ngimuReceiver, const uint32_t baudRate);
+#endif
+#if defined(USE_HAL_DRIVER) && defined(HAL_UART_MODULE_ENABLED) && !defined(ARDUINO)
+void NgimuSerialDmaBeginStm32(NgimuReceiver * const ngimuReceiver, UART_HandleTypeDef * const huart);
+void NgimuSerialDmaRxEventStm32(UART_HandleTypeDef * const huart, const uint16_t size);
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
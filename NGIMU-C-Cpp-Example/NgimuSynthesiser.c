@@ -0,0 +1,180 @@
+/**
+ * @file NgimuSynthesiser.c
+ * @author Seb Madgwick
+ * @brief Synthesis of OSC packets and SLIP frames as sent by the NGIMU, with
+ * pseudo-random arguments and time tags, for the benchmark and fuzz harnesses.
+ * The same seed always synthesises the same packets.  Functions do not check
+ * the destination size; the caller must provide sufficient space.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuSynthesiser.h"
+#include "Osc99.h" // SLIP_END, SLIP_ESC, SLIP_ESC_END, SLIP_ESC_ESC
+#include <string.h> // memcpy, memset, strlen
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Seed used if the seed is 0.  The state of xorshift32 must not be 0.
+ */
+#define DEFAULT_SEED (0x12345678)
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the synthesiser structure.
+ * @param ngimuSynthesiser Address of synthesiser structure.
+ * @param seed Seed of the pseudo-random number generator, or 0 for the default
+ * seed.
+ */
+void NgimuSynthesiserInitialise(NgimuSynthesiser * const ngimuSynthesiser, const uint32_t seed) {
+    ngimuSynthesiser->randomState = (seed != 0) ? seed : DEFAULT_SEED;
+}
+
+/**
+ * @brief Returns a pseudo-random number (xorshift32).
+ * @param ngimuSynthesiser Address of synthesiser structure.
+ * @return Pseudo-random number.
+ */
+uint32_t NgimuSynthesiserRandom(NgimuSynthesiser * const ngimuSynthesiser) {
+    uint32_t randomState = ngimuSynthesiser->randomState;
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    ngimuSynthesiser->randomState = randomState;
+    return randomState;
+}
+
+/**
+ * @brief Writes a big-endian 32-bit value.
+ * @param destination Destination.
+ * @param value Value.
+ * @return Number of bytes written.
+ */
+size_t NgimuSynthesiserWriteBigEndian32(char * const destination, const uint32_t value) {
+    destination[0] = (char) (value >> 24);
+    destination[1] = (char) (value >> 16);
+    destination[2] = (char) (value >> 8);
+    destination[3] = (char) value;
+    return 4;
+}
+
+/**
+ * @brief Writes a null-terminated OSC string padded to a multiple of four
+ * bytes.
+ * @param destination Destination.
+ * @param string String.
+ * @return Number of bytes written.
+ */
+size_t NgimuSynthesiserWriteString(char * const destination, const char * const string) {
+    const size_t length = strlen(string);
+    const size_t size = (length + 4) & ~(size_t) 3;
+    memset(destination, 0, size);
+    memcpy(destination, string, length);
+    return size;
+}
+
+/**
+ * @brief Writes an OSC message with random float32 arguments.
+ * @param ngimuSynthesiser Address of synthesiser structure.
+ * @param destination Destination.
+ * @param address OSC address.
+ * @param numberOfArguments Number of arguments.  Must not exceed
+ * NGIMU_SYNTHESISER_MAX_NUMBER_OF_ARGUMENTS.
+ * @return Number of bytes written.
+ */
+size_t NgimuSynthesiserWriteMessage(NgimuSynthesiser * const ngimuSynthesiser, char * const destination, const char * const address, const size_t numberOfArguments) {
+    char typeTagString[NGIMU_SYNTHESISER_MAX_NUMBER_OF_ARGUMENTS + 2];
+    typeTagString[0] = ',';
+    memset(&typeTagString[1], 'f', numberOfArguments);
+    typeTagString[numberOfArguments + 1] = '\0';
+    size_t size = NgimuSynthesiserWriteString(destination, address);
+    size += NgimuSynthesiserWriteString(&destination[size], typeTagString);
+    size_t index;
+    for (index = 0; index < numberOfArguments; index++) {
+        size += NgimuSynthesiserWriteBigEndian32(&destination[size], NgimuSynthesiserRandom(ngimuSynthesiser));
+    }
+    return size;
+}
+
+/**
+ * @brief Writes an OSC bundle element containing a message.
+ * @param ngimuSynthesiser Address of synthesiser structure.
+ * @param destination Destination.
+ * @param address OSC address.
+ * @param numberOfArguments Number of arguments.
+ * @return Number of bytes written.
+ */
+size_t NgimuSynthesiserWriteElement(NgimuSynthesiser * const ngimuSynthesiser, char * const destination, const char * const address, const size_t numberOfArguments) {
+    const size_t messageSize = NgimuSynthesiserWriteMessage(ngimuSynthesiser, &destination[4], address, numberOfArguments);
+    NgimuSynthesiserWriteBigEndian32(destination, (uint32_t) messageSize);
+    return 4 + messageSize;
+}
+
+/**
+ * @brief Writes an OSC bundle header with a random time tag.
+ * @param ngimuSynthesiser Address of synthesiser structure.
+ * @param destination Destination.
+ * @return Number of bytes written.
+ */
+size_t NgimuSynthesiserWriteBundleHeader(NgimuSynthesiser * const ngimuSynthesiser, char * const destination) {
+    size_t size = NgimuSynthesiserWriteString(destination, "#bundle");
+    size += NgimuSynthesiserWriteBigEndian32(&destination[size], NgimuSynthesiserRandom(ngimuSynthesiser));
+    size += NgimuSynthesiserWriteBigEndian32(&destination[size], NgimuSynthesiserRandom(ngimuSynthesiser));
+    return size;
+}
+
+/**
+ * @brief Writes an OSC packet as sent by the NGIMU.  The mix of packets
+ * approximates an NGIMU sending "/sensors" at twice the rate of "/quaternion"
+ * and "/euler".  The largest packet is 156 bytes.
+ * @param ngimuSynthesiser Address of synthesiser structure.
+ * @param destination Destination.
+ * @return Number of bytes written.
+ */
+size_t NgimuSynthesiserWritePacket(NgimuSynthesiser * const ngimuSynthesiser, char * const destination) {
+    const uint32_t type = NgimuSynthesiserRandom(ngimuSynthesiser) % 100;
+    if (type >= 90) {
+        return NgimuSynthesiserWriteMessage(ngimuSynthesiser, destination, "/euler", 3);
+    }
+    size_t size = NgimuSynthesiserWriteBundleHeader(ngimuSynthesiser, destination);
+    size += NgimuSynthesiserWriteElement(ngimuSynthesiser, &destination[size], "/sensors", 10);
+    if (type < 50) {
+        size += NgimuSynthesiserWriteElement(ngimuSynthesiser, &destination[size], "/quaternion", 4);
+        size += NgimuSynthesiserWriteElement(ngimuSynthesiser, &destination[size], "/euler", 3);
+    }
+    return size;
+}
+
+/**
+ * @brief SLIP encodes a packet.  The destination must have space for twice the
+ * packet size plus one byte.
+ * @param destination Destination.
+ * @param source Packet.
+ * @param sourceSize Packet size.
+ * @return Number of bytes written.
+ */
+size_t NgimuSynthesiserSlipEncode(char * const destination, const char * const source, const size_t sourceSize) {
+    size_t size = 0;
+    size_t index;
+    for (index = 0; index < sourceSize; index++) {
+        if (source[index] == SLIP_END) {
+            destination[size++] = SLIP_ESC;
+            destination[size++] = SLIP_ESC_END;
+        } else if (source[index] == SLIP_ESC) {
+            destination[size++] = SLIP_ESC;
+            destination[size++] = SLIP_ESC_ESC;
+        } else {
+            destination[size++] = source[index];
+        }
+    }
+    destination[size++] = SLIP_END;
+    return size;
+}
+
+//------------------------------------------------------------------------------
+// End of file
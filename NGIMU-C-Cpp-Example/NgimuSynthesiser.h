@@ -0,0 +1,64 @@
+/**
+ * @file NgimuSynthesiser.h
+ * @author Seb Madgwick
+ * @brief Synthesis of OSC packets and SLIP frames as sent by the NGIMU, with
+ * pseudo-random arguments and time tags, for the benchmark and fuzz harnesses.
+ * The same seed always synthesises the same packets.  Functions do not check
+ * the destination size; the caller must provide sufficient space.
+ */
+
+#ifndef NGIMU_SYNTHESISER_H
+#define NGIMU_SYNTHESISER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Size of an OSC bundle header and time tag.
+ */
+#define NGIMU_SYNTHESISER_BUNDLE_HEADER_SIZE (16)
+
+/**
+ * @brief Maximum number of float32 arguments of a synthesised message.
+ */
+#define NGIMU_SYNTHESISER_MAX_NUMBER_OF_ARGUMENTS (14)
+
+/**
+ * @brief Synthesiser structure.  Structure members are used internally and
+ * should not be used by the user application.
+ */
+typedef struct {
+    uint32_t randomState;
+} NgimuSynthesiser;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+void NgimuSynthesiserInitialise(NgimuSynthesiser * const ngimuSynthesiser, const uint32_t seed);
+uint32_t NgimuSynthesiserRandom(NgimuSynthesiser * const ngimuSynthesiser);
+size_t NgimuSynthesiserWriteBigEndian32(char * const destination, const uint32_t value);
+size_t NgimuSynthesiserWriteString(char * const destination, const char * const string);
+size_t NgimuSynthesiserWriteMessage(NgimuSynthesiser * const ngimuSynthesiser, char * const destination, const char * const address, const size_t numberOfArguments);
+size_t NgimuSynthesiserWriteElement(NgimuSynthesiser * const ngimuSynthesiser, char * const destination, const char * const address, const size_t numberOfArguments);
+size_t NgimuSynthesiserWriteBundleHeader(NgimuSynthesiser * const ngimuSynthesiser, char * const destination);
+size_t NgimuSynthesiserWritePacket(NgimuSynthesiser * const ngimuSynthesiser, char * const destination);
+size_t NgimuSynthesiserSlipEncode(char * const destination, const char * const source, const size_t sourceSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,331 @@
+/**
+ * @file main.c
+ * @author Seb Madgwick
+ * @brief Replays a capture recorded with NgimuCapture through a receiver.  The
+ * capture is memory-mapped so that captures larger than the available memory
+ * can be replayed at memory bandwidth.  Optionally, entries are paced
+ * according to their receive timestamps, or messages are decoded to column
+ * buffers instead of being passed to callbacks.
+ *
+ * Build:
+ * Compile main.c, ../NGIMU-C-Cpp-Example/NgimuCapture.c,
+ * ../NGIMU-C-Cpp-Example/NgimuReceive.c and the OSC99 source files, with
+ * ../NGIMU-C-Cpp-Example and the "Osc99" directory on the include path.
+ *
+ * Usage:
+ * ngimu-replay file [realtime | columns]
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#define _GNU_SOURCE // clock_nanosleep, must be defined before any system header
+
+#include "NgimuCapture.h"
+#include "NgimuReceive.h"
+#include <fcntl.h> // open
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h> // strcmp
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <time.h>
+#include <unistd.h> // close
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of messages of each type decoded before the column buffers are
+ * processed.
+ */
+#define COLUMNS_CAPACITY (65536)
+
+//------------------------------------------------------------------------------
+// Variable declarations
+
+static NgimuReceiver ngimuReceiver;
+static size_t numberOfMessages;
+static size_t numberOfErrors;
+static size_t numberOfDiscarded;
+static NgimuColumns ngimuColumns;
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static uint64_t sensorsTimestamps[COLUMNS_CAPACITY];
+static float sensorsColumns[10][COLUMNS_CAPACITY];
+static size_t numberOfSensorsMessages;
+static double gyroscopeXSum;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+static uint64_t quaternionTimestamps[COLUMNS_CAPACITY];
+static float quaternionColumns[4][COLUMNS_CAPACITY];
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+static uint64_t eulerTimestamps[COLUMNS_CAPACITY];
+static float eulerColumns[3][COLUMNS_CAPACITY];
+#endif
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static void InitialiseColumns();
+static bool IsColumnsHalfFull();
+static void ProcessColumns();
+static void Pace(const struct timespec * const start, const uint64_t elapsed);
+static uint64_t GetNanoseconds(const struct timespec * const timespec);
+static void ReceiveErrorCallback(const NgimuReceiveError * const ngimuReceiveError, void * const userContext);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static void SensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+static void QuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+static void EulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext);
+#endif
+
+//------------------------------------------------------------------------------
+// Functions
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s file [realtime | columns]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const bool realtime = (argc > 2) && (strcmp(argv[2], "realtime") == 0);
+    const bool columns = (argc > 2) && (strcmp(argv[2], "columns") == 0);
+
+    // Map capture
+    const int file = open(argv[1], O_RDONLY);
+    if (file < 0) {
+        perror("Unable to open file");
+        return EXIT_FAILURE;
+    }
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0) {
+        perror("Unable to get file size");
+        close(file);
+        return EXIT_FAILURE;
+    }
+    const size_t captureSize = (size_t) fileStat.st_size;
+    if (captureSize < NGIMU_CAPTURE_FILE_HEADER_SIZE) {
+        fprintf(stderr, "Invalid capture file header\n");
+        close(file);
+        return EXIT_FAILURE;
+    }
+    const char * const capture = mmap(NULL, captureSize, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (capture == MAP_FAILED) {
+        perror("Unable to map file");
+        return EXIT_FAILURE;
+    }
+    madvise((void *) capture, captureSize, MADV_SEQUENTIAL);
+
+    // Initialise reader
+    NgimuCaptureReader ngimuCaptureReader;
+    if (NgimuCaptureReaderInitialise(&ngimuCaptureReader, capture, captureSize) == false) {
+        fprintf(stderr, "Invalid capture file header\n");
+        munmap((void *) capture, captureSize);
+        return EXIT_FAILURE;
+    }
+
+    // Initialise receiver
+    NgimuReceiverInitialise(&ngimuReceiver);
+    NgimuReceiverSetReceiveErrorCallback(&ngimuReceiver, ReceiveErrorCallback);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuReceiverSetSensorsCallback(&ngimuReceiver, SensorsCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuReceiverSetQuaternionCallback(&ngimuReceiver, QuaternionCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuReceiverSetEulerCallback(&ngimuReceiver, EulerCallback);
+#endif
+    if (columns) {
+        InitialiseColumns();
+        NgimuReceiverSetColumns(&ngimuReceiver, &ngimuColumns);
+    }
+
+    // Replay each entry
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    NgimuCaptureEntry ngimuCaptureEntry;
+    size_t numberOfEntries = 0;
+    uint64_t firstTimestamp = 0;
+    while (NgimuCaptureReaderNext(&ngimuCaptureReader, &ngimuCaptureEntry) == true) {
+        if (numberOfEntries++ == 0) {
+            firstTimestamp = ngimuCaptureEntry.timestamp;
+        }
+        if (realtime && (ngimuCaptureEntry.timestamp >= firstTimestamp)) {
+            Pace(&start, ngimuCaptureEntry.timestamp - firstTimestamp);
+        }
+        NgimuCaptureProcessEntry(&ngimuReceiver, &ngimuCaptureEntry);
+        if (columns && IsColumnsHalfFull()) {
+            ProcessColumns();
+        }
+    }
+    if (columns) {
+        ProcessColumns();
+    }
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    munmap((void *) capture, captureSize);
+
+    // Print summary
+    const double seconds = (double) (GetNanoseconds(&end) - GetNanoseconds(&start)) / 1E9;
+    printf("%zu entries, %zu messages, %zu errors, %.3f s, %.1f MB/s\n", numberOfEntries, numberOfMessages, numberOfErrors, seconds, (seconds > 0.0) ? ((double) captureSize / seconds / 1E6) : 0.0);
+    if (columns) {
+        printf("%zu messages discarded by full column buffers\n", numberOfDiscarded);
+    }
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    if (columns && (numberOfSensorsMessages > 0)) {
+        printf("Mean gyroscope X: %f\n", gyroscopeXSum / (double) numberOfSensorsMessages);
+    }
+#endif
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Points the column buffers at the static arrays.
+ */
+static void InitialiseColumns() {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuSensorsColumns * const sensors = &ngimuColumns.sensors;
+    sensors->capacity = COLUMNS_CAPACITY;
+    sensors->timestamp = sensorsTimestamps;
+    sensors->gyroscopeX = sensorsColumns[0];
+    sensors->gyroscopeY = sensorsColumns[1];
+    sensors->gyroscopeZ = sensorsColumns[2];
+    sensors->accelerometerX = sensorsColumns[3];
+    sensors->accelerometerY = sensorsColumns[4];
+    sensors->accelerometerZ = sensorsColumns[5];
+    sensors->magnetometerX = sensorsColumns[6];
+    sensors->magnetometerY = sensorsColumns[7];
+    sensors->magnetometerZ = sensorsColumns[8];
+    sensors->barometer = sensorsColumns[9];
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuQuaternionColumns * const quaternion = &ngimuColumns.quaternion;
+    quaternion->capacity = COLUMNS_CAPACITY;
+    quaternion->timestamp = quaternionTimestamps;
+    quaternion->w = quaternionColumns[0];
+    quaternion->x = quaternionColumns[1];
+    quaternion->y = quaternionColumns[2];
+    quaternion->z = quaternionColumns[3];
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuEulerColumns * const euler = &ngimuColumns.euler;
+    euler->capacity = COLUMNS_CAPACITY;
+    euler->timestamp = eulerTimestamps;
+    euler->roll = eulerColumns[0];
+    euler->pitch = eulerColumns[1];
+    euler->yaw = eulerColumns[2];
+#endif
+}
+
+/**
+ * @brief Returns true if any column buffer is at least half full so that the
+ * column buffers are processed before messages are discarded.
+ * @return True if any column buffer is at least half full.
+ */
+static bool IsColumnsHalfFull() {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    if (ngimuColumns.sensors.count >= (COLUMNS_CAPACITY / 2)) {
+        return true;
+    }
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    if (ngimuColumns.quaternion.count >= (COLUMNS_CAPACITY / 2)) {
+        return true;
+    }
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    if (ngimuColumns.euler.count >= (COLUMNS_CAPACITY / 2)) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+/**
+ * @brief Processes the contents of the column buffers and empties them.  The
+ * gyroscope X column is summed as an example of a vectorisable operation.
+ */
+static void ProcessColumns() {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    const float * const gyroscopeX = ngimuColumns.sensors.gyroscopeX;
+    size_t index;
+    for (index = 0; index < ngimuColumns.sensors.count; index++) {
+        gyroscopeXSum += gyroscopeX[index];
+    }
+    numberOfSensorsMessages += ngimuColumns.sensors.count;
+    numberOfMessages += ngimuColumns.sensors.count;
+    numberOfDiscarded += ngimuColumns.sensors.numberOfDiscarded;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    numberOfMessages += ngimuColumns.quaternion.count;
+    numberOfDiscarded += ngimuColumns.quaternion.numberOfDiscarded;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    numberOfMessages += ngimuColumns.euler.count;
+    numberOfDiscarded += ngimuColumns.euler.numberOfDiscarded;
+#endif
+    NgimuColumnsClear(&ngimuColumns);
+}
+
+/**
+ * @brief Sleeps until the elapsed time since the start of the replay.
+ * @param start Start time.
+ * @param elapsed Elapsed time in nanoseconds.
+ */
+static void Pace(const struct timespec * const start, const uint64_t elapsed) {
+    const uint64_t time = GetNanoseconds(start) + elapsed;
+    struct timespec timespec;
+    timespec.tv_sec = (time_t) (time / 1000000000);
+    timespec.tv_nsec = (long) (time % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &timespec, NULL) != 0) {
+    }
+}
+
+/**
+ * @brief Converts a time to nanoseconds.
+ * @param timespec Time.
+ * @return Time in nanoseconds.
+ */
+static uint64_t GetNanoseconds(const struct timespec * const timespec) {
+    return ((uint64_t) timespec->tv_sec * 1000000000) + (uint64_t) timespec->tv_nsec;
+}
+
+// This function is called each time there is a receive error
+static void ReceiveErrorCallback(const NgimuReceiveError * const ngimuReceiveError, void * const userContext) {
+    numberOfErrors++;
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+
+// This function is called each time a "/sensors" message is received
+static void SensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+    numberOfMessages++;
+}
+
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+
+// This function is called each time a "/quaternion" message is received
+static void QuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+    numberOfMessages++;
+}
+
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+
+// This function is called each time a "/euler" message is received
+static void EulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+    numberOfMessages++;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
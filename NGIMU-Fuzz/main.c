@@ -0,0 +1,128 @@
+/**
+ * @file main.c
+ * @author Seb Madgwick
+ * @brief Desktop fuzz and worst-case timing harness of the NgimuReceive decode
+ * path.  Prints the worst-case duration and number of callbacks of each
+ * process function call for each generated input, and fails if the number of
+ * callbacks is exceeded or, if a budget is specified, the repeated duration
+ * exceeds the budget.
+ *
+ * Build:
+ * Compile main.c, ../NGIMU-C-Cpp-Example/NgimuFuzz.c,
+ * ../NGIMU-C-Cpp-Example/NgimuReceive.c,
+ * ../NGIMU-C-Cpp-Example/NgimuSynthesiser.c and the OSC99 source files, with
+ * ../NGIMU-C-Cpp-Example and the "Osc99" directory on the include path.
+ * Compile with optimisation (e.g. -O2) for representative timings, or with
+ * -fsanitize=address,undefined to check memory safety.  Alternatively, define
+ * NGIMU_FUZZ_LIBFUZZER and compile with clang -fsanitize=fuzzer,address for
+ * coverage-guided fuzzing by libFuzzer.
+ *
+ * Usage:
+ * ngimu-fuzz [iterations] [budget ns] [seed]
+ *
+ * The duration is only measured if the budget is not specified or is 0.
+ *
+ * The maximum duration includes preemption unless the process is permitted to
+ * run with real-time priority, e.g. as root.  The repeated duration is the
+ * minimum of repetitions of the worst-case input so excludes preemption.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#define _POSIX_C_SOURCE 199309L // clock_gettime, must be defined before any system header
+
+#include "NgimuFuzz.h"
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h> // abort, atof, atoi, strtoul
+#include <time.h>
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+#ifndef NGIMU_FUZZ_LIBFUZZER
+static uint64_t GetTicks();
+#endif
+
+//------------------------------------------------------------------------------
+// Functions
+
+#ifdef NGIMU_FUZZ_LIBFUZZER
+
+/**
+ * @brief libFuzzer entry point.  Aborts if a process function call exceeds the
+ * maximum number of callbacks.
+ * @param data Input.
+ * @param size Input size.
+ * @return 0.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (NgimuFuzzProcessInput((const char *) data, size) > NGIMU_FUZZ_MAX_CALLBACKS_PER_CALL) {
+        abort();
+    }
+    return 0;
+}
+
+#else
+
+int main(int argc, char* argv[]) {
+
+    // Configure fuzz
+    NgimuFuzzSettings settings;
+    settings.getTicks = GetTicks;
+    settings.ticksPerSecond = 1E9;
+    settings.iterations = (argc > 1) ? (unsigned int) atoi(argv[1]) : 100000;
+    settings.budgetNanoseconds = (argc > 2) ? atof(argv[2]) : 0.0;
+    settings.seed = (argc > 3) ? (uint32_t) strtoul(argv[3], NULL, 0) : 0;
+    if (settings.budgetNanoseconds < 0.0) {
+        fprintf(stderr, "Usage: %s [iterations] [budget ns] [seed]\nBudget must not be negative\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Run with real-time priority so that timings exclude preemption
+    struct sched_param schedParam;
+    schedParam.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    if (sched_setscheduler(0, SCHED_FIFO, &schedParam) != 0) {
+        perror("Unable to set real-time priority, timings include preemption");
+    }
+
+    // Run each scenario
+    bool withinBound = true;
+    NgimuFuzzScenario scenario;
+    for (scenario = 0; scenario < NgimuFuzzNumberOfScenarios; scenario++) {
+        NgimuFuzzResult result;
+        NgimuFuzzRun(&settings, scenario, &result);
+        printf("%s: %zu bytes, %zu messages, %zu errors\n", result.name, result.numberOfBytes, result.numberOfMessages, result.numberOfErrors);
+        printf("  %-18s %12s %10s %10s %12s\n", "Input", "Calls", "Callbacks", "Max ns", "Repeated ns");
+        NgimuFuzzInput input;
+        for (input = 0; input < NgimuFuzzNumberOfInputs; input++) {
+            const NgimuFuzzInputResult * const inputResult = &result.inputs[input];
+            printf("  %-18s %12zu %10zu %10.0f %12.0f\n", NgimuFuzzGetInputName(input), inputResult->numberOfCalls, inputResult->maxCallbacksPerCall, inputResult->maxNanosecondsPerCall, inputResult->repeatedNanosecondsPerCall);
+        }
+        printf("  %-18s %12s %10zu %10.0f %12.0f %s\n", "Worst case", "", result.maxCallbacksPerCall, result.maxNanosecondsPerCall, result.repeatedNanosecondsPerCall, result.withinBound ? "within bound" : "BOUND EXCEEDED");
+        withinBound = withinBound && result.withinBound;
+    }
+    if (settings.budgetNanoseconds > 0.0) {
+        printf("Callback bound %d, budget %.0f ns\n", NGIMU_FUZZ_MAX_CALLBACKS_PER_CALL, settings.budgetNanoseconds);
+    } else {
+        printf("Callback bound %d, no budget\n", NGIMU_FUZZ_MAX_CALLBACKS_PER_CALL);
+    }
+    return withinBound ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Returns monotonic time in nanoseconds.
+ * @return Monotonic time in nanoseconds.
+ */
+static uint64_t GetTicks() {
+    struct timespec timespec;
+    clock_gettime(CLOCK_MONOTONIC, &timespec);
+    return ((uint64_t) timespec.tv_sec * 1000000000) + (uint64_t) timespec.tv_nsec;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,410 @@
+/**
+ * @file NgimuShm.c
+ * @author Seb Madgwick
+ * @brief Publishing of decoded NGIMU messages to a POSIX shared memory ring so
+ * that any number of processes on the same host may consume the messages
+ * decoded by one receiving process.  The publisher writes each record to the
+ * next slot of the ring protected by a sequence lock.  Each subscriber maps
+ * the ring read-only, reads records at its own pace and detects records that
+ * were overwritten before they were read.  The publisher is never blocked by
+ * a subscriber.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#define _POSIX_C_SOURCE 200809L // ftruncate, shm_open, must be defined before any system header
+
+#include <errno.h>
+#include <fcntl.h> // O_CREAT, O_RDONLY, O_RDWR
+#include "NgimuShm.h"
+#include <stdio.h> // snprintf
+#include <string.h> // memcpy, memset
+#include <sys/mman.h> // mmap, munmap, shm_open, shm_unlink
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close, ftruncate
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Magic number identifying an initialised ring ("NGSH").
+ */
+#define MAGIC (0x4853474EU)
+
+/**
+ * @brief Ring layout version.  Must be incremented if the layout of the ring
+ * or of a record is modified.
+ */
+#define VERSION (1)
+
+/**
+ * @brief Returns the size of a ring of the capacity.
+ */
+#define RING_SIZE(capacity) (sizeof (NgimuShmRing) + ((size_t) (capacity) * sizeof (NgimuShmSlot)))
+
+/**
+ * @brief Relaxed atomic load and store.  Record words are accessed atomically
+ * so that a read concurrent with a write is not a data race.
+ */
+#define LOAD_RELAXED(value) __atomic_load_n(&(value), __ATOMIC_RELAXED)
+#define STORE_RELAXED(value, newValue) __atomic_store_n(&(value), (newValue), __ATOMIC_RELAXED)
+
+/**
+ * @brief Acquire load and release store.
+ */
+#define LOAD_ACQUIRE(value) __atomic_load_n(&(value), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(value, newValue) __atomic_store_n(&(value), (newValue), __ATOMIC_RELEASE)
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static void Publish(NgimuShmPublisher * const ngimuShmPublisher, const NgimuShmRecord * const ngimuShmRecord);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Creates the shared memory and initialises the ring.  Existing shared
+ * memory of the same name is reinitialised so that the publisher may be
+ * restarted while subscribers are running.  Existing shared memory of a
+ * different size is not modified because it may be mapped by subscribers of a
+ * different capacity.
+ * @param ngimuShmPublisher Address of publisher structure.
+ * @param name Shared memory name, e.g. "/ngimu".
+ * @param capacity Number of records in the ring.
+ * @return 0 if successful, otherwise -1 with errno set.  errno is EEXIST if
+ * existing shared memory of the name has a different capacity.
+ */
+int NgimuShmPublisherOpen(NgimuShmPublisher * const ngimuShmPublisher, const char * const name, const uint32_t capacity) {
+    memset(ngimuShmPublisher, 0, sizeof (*ngimuShmPublisher));
+    if ((capacity == 0) || (snprintf(ngimuShmPublisher->name, sizeof (ngimuShmPublisher->name), "%s", name) >= (int) sizeof (ngimuShmPublisher->name))) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Create and map shared memory
+    const int fileDescriptor = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fileDescriptor < 0) {
+        return -1;
+    }
+    const size_t size = RING_SIZE(capacity);
+    struct stat status;
+    if (fstat(fileDescriptor, &status) != 0) {
+        const int error = errno;
+        close(fileDescriptor);
+        errno = error;
+        return -1;
+    }
+    if ((status.st_size != 0) && ((size_t) status.st_size != size)) {
+        close(fileDescriptor);
+        errno = EEXIST;
+        return -1;
+    }
+    if (ftruncate(fileDescriptor, (off_t) size) != 0) {
+        const int error = errno;
+        close(fileDescriptor);
+        errno = error;
+        return -1;
+    }
+    void * const address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    const int error = errno;
+    close(fileDescriptor);
+    if (address == MAP_FAILED) {
+        errno = error;
+        return -1;
+    }
+
+    // Initialise ring
+    NgimuShmRing * const ring = (NgimuShmRing *) address;
+    STORE_RELEASE(ring->magic, 0);
+    ring->version = VERSION;
+    ring->capacity = capacity;
+    ring->recordSize = sizeof (NgimuShmRecord);
+    STORE_RELAXED(ring->writeIndex, 0);
+    uint32_t index;
+    for (index = 0; index < capacity; index++) {
+        STORE_RELAXED(ring->slots[index].sequence, 0);
+    }
+    STORE_RELEASE(ring->magic, MAGIC);
+    ngimuShmPublisher->ring = ring;
+    ngimuShmPublisher->size = size;
+    ngimuShmPublisher->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Unmaps the shared memory.  Mapped subscribers are not affected by
+ * unlinking, but new subscribers will not be able to open the shared memory.
+ * @param ngimuShmPublisher Address of publisher structure.
+ * @param unlink True to remove the shared memory name.
+ */
+void NgimuShmPublisherClose(NgimuShmPublisher * const ngimuShmPublisher, const bool unlink) {
+    if (ngimuShmPublisher->ring != NULL) {
+        munmap(ngimuShmPublisher->ring, ngimuShmPublisher->size);
+        ngimuShmPublisher->ring = NULL;
+    }
+    if (unlink) {
+        shm_unlink(ngimuShmPublisher->name);
+    }
+}
+
+/**
+ * @brief Writes a record to the ring.  The oldest record is overwritten if the
+ * ring is full.  This function must only be called from one thread.
+ * @param ngimuShmPublisher Address of publisher structure.
+ * @param key Key of the NGIMU that sent the message.
+ * @param ngimuQueueRecord Address of record.
+ */
+void NgimuShmPublisherPublish(NgimuShmPublisher * const ngimuShmPublisher, const uint64_t key, const NgimuQueueRecord * const ngimuQueueRecord) {
+    NgimuShmRecord ngimuShmRecord;
+    ngimuShmRecord.key = key;
+    ngimuShmRecord.record = *ngimuQueueRecord;
+    Publish(ngimuShmPublisher, &ngimuShmRecord);
+}
+
+/**
+ * @brief Assigns the receiver callbacks so that all decoded messages are
+ * published with a key of 0.  The receiver user context is set to the
+ * publisher.
+ * @param ngimuShmPublisher Address of publisher structure.
+ * @param ngimuReceiver Address of receiver structure.
+ */
+void NgimuShmPublisherSetReceiverCallbacks(NgimuShmPublisher * const ngimuShmPublisher, NgimuReceiver * const ngimuReceiver) {
+    NgimuReceiverSetUserContext(ngimuReceiver, ngimuShmPublisher);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuReceiverSetSensorsCallback(ngimuReceiver, NgimuShmPublisherSensorsCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuReceiverSetQuaternionCallback(ngimuReceiver, NgimuShmPublisherQuaternionCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuReceiverSetEulerCallback(ngimuReceiver, NgimuShmPublisherEulerCallback);
+#endif
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+/**
+ * @brief "/sensors" callback that publishes the message with a key of 0.  May
+ * be assigned to any pointer callback with the publisher as the user context.
+ * @param ngimuSensors Address of "/sensors" structure.
+ * @param userContext Address of publisher structure.
+ */
+void NgimuShmPublisherSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+    NgimuShmRecord ngimuShmRecord;
+    ngimuShmRecord.key = 0;
+    ngimuShmRecord.record.type = NgimuQueueRecordTypeSensors;
+    ngimuShmRecord.record.data.sensors = *ngimuSensors;
+    Publish((NgimuShmPublisher *) userContext, &ngimuShmRecord);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+/**
+ * @brief "/quaternion" callback that publishes the message with a key of 0.
+ * May be assigned to any pointer callback with the publisher as the user
+ * context.
+ * @param ngimuQuaternion Address of "/quaternion" structure.
+ * @param userContext Address of publisher structure.
+ */
+void NgimuShmPublisherQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+    NgimuShmRecord ngimuShmRecord;
+    ngimuShmRecord.key = 0;
+    ngimuShmRecord.record.type = NgimuQueueRecordTypeQuaternion;
+    ngimuShmRecord.record.data.quaternion = *ngimuQuaternion;
+    Publish((NgimuShmPublisher *) userContext, &ngimuShmRecord);
+}
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+/**
+ * @brief "/euler" callback that publishes the message with a key of 0.  May be
+ * assigned to any pointer callback with the publisher as the user context.
+ * @param ngimuEuler Address of "/euler" structure.
+ * @param userContext Address of publisher structure.
+ */
+void NgimuShmPublisherEulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+    NgimuShmRecord ngimuShmRecord;
+    ngimuShmRecord.key = 0;
+    ngimuShmRecord.record.type = NgimuQueueRecordTypeEuler;
+    ngimuShmRecord.record.data.euler = *ngimuEuler;
+    Publish((NgimuShmPublisher *) userContext, &ngimuShmRecord);
+}
+#endif
+
+/**
+ * @brief Maps the shared memory of a publisher read-only.  Only records
+ * published after the subscriber is opened are read.
+ * @param ngimuShmSubscriber Address of subscriber structure.
+ * @param name Shared memory name, e.g. "/ngimu".
+ * @return 0 if successful, otherwise -1 with errno set.  errno is EAGAIN if
+ * the ring has not been initialised by the publisher and EPROTO if the ring
+ * was created by an incompatible build.
+ */
+int NgimuShmSubscriberOpen(NgimuShmSubscriber * const ngimuShmSubscriber, const char * const name) {
+    memset(ngimuShmSubscriber, 0, sizeof (*ngimuShmSubscriber));
+
+    // Map shared memory
+    const int fileDescriptor = shm_open(name, O_RDONLY, 0);
+    if (fileDescriptor < 0) {
+        return -1;
+    }
+    struct stat status;
+    if (fstat(fileDescriptor, &status) != 0) {
+        const int error = errno;
+        close(fileDescriptor);
+        errno = error;
+        return -1;
+    }
+    const size_t size = (size_t) status.st_size;
+    if (size < sizeof (NgimuShmRing)) {
+        close(fileDescriptor);
+        errno = EAGAIN;
+        return -1;
+    }
+    void * const address = mmap(NULL, size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    const int error = errno;
+    close(fileDescriptor);
+    if (address == MAP_FAILED) {
+        errno = error;
+        return -1;
+    }
+
+    // Check ring
+    const NgimuShmRing * const ring = (const NgimuShmRing *) address;
+    if (LOAD_ACQUIRE(ring->magic) != MAGIC) {
+        munmap(address, size);
+        errno = EAGAIN;
+        return -1;
+    }
+    if ((ring->version != VERSION) || (ring->recordSize != sizeof (NgimuShmRecord)) || (ring->capacity == 0) || (size < RING_SIZE(ring->capacity))) {
+        munmap(address, size);
+        errno = EPROTO;
+        return -1;
+    }
+    ngimuShmSubscriber->ring = ring;
+    ngimuShmSubscriber->size = size;
+    ngimuShmSubscriber->capacity = ring->capacity;
+    ngimuShmSubscriber->readIndex = LOAD_ACQUIRE(ring->writeIndex);
+    return 0;
+}
+
+/**
+ * @brief Unmaps the shared memory.
+ * @param ngimuShmSubscriber Address of subscriber structure.
+ */
+void NgimuShmSubscriberClose(NgimuShmSubscriber * const ngimuShmSubscriber) {
+    if (ngimuShmSubscriber->ring != NULL) {
+        munmap((void *) ngimuShmSubscriber->ring, ngimuShmSubscriber->size);
+        ngimuShmSubscriber->ring = NULL;
+    }
+}
+
+/**
+ * @brief Reads the next record.  Records that were overwritten before they
+ * were read are skipped and counted as lost.  The ring is indexed with the
+ * capacity validated when the subscriber was opened so that a modified ring
+ * header cannot cause a read beyond the mapping.
+ * @param ngimuShmSubscriber Address of subscriber structure.
+ * @param ngimuShmRecord Address of record.
+ * @return 1 if a record was read, 0 if no new records are available,
+ * otherwise -1 with errno set.  errno is EAGAIN if the ring is being
+ * reinitialised by the publisher and ESTALE if the ring no longer matches the
+ * subscriber, in which case the subscriber must be closed and opened again.
+ */
+int NgimuShmSubscriberRead(NgimuShmSubscriber * const ngimuShmSubscriber, NgimuShmRecord * const ngimuShmRecord) {
+    const NgimuShmRing * const ring = ngimuShmSubscriber->ring;
+    const uint32_t capacity = ngimuShmSubscriber->capacity;
+    while (true) {
+
+        // Check ring
+        if (LOAD_ACQUIRE(ring->magic) != MAGIC) {
+            errno = EAGAIN;
+            return -1;
+        }
+        if (LOAD_RELAXED(ring->capacity) != capacity) {
+            errno = ESTALE;
+            return -1;
+        }
+
+        // Check for new records
+        const uint64_t writeIndex = LOAD_ACQUIRE(ring->writeIndex);
+        if (writeIndex < ngimuShmSubscriber->readIndex) {
+            ngimuShmSubscriber->readIndex = writeIndex; // publisher restarted
+        }
+        if (writeIndex == ngimuShmSubscriber->readIndex) {
+            return 0;
+        }
+
+        // Skip records already overwritten
+        if ((writeIndex - ngimuShmSubscriber->readIndex) > capacity) {
+            ngimuShmSubscriber->lostCount += (writeIndex - ngimuShmSubscriber->readIndex) - capacity;
+            ngimuShmSubscriber->readIndex = writeIndex - capacity;
+        }
+
+        // Copy record
+        const uint64_t readIndex = ngimuShmSubscriber->readIndex;
+        const NgimuShmSlot * const slot = &ring->slots[readIndex % capacity];
+        const uint64_t expectedSequence = (2 * readIndex) + 2;
+        const uint64_t sequence = LOAD_ACQUIRE(slot->sequence);
+        uint32_t words[NGIMU_SHM_RECORD_WORDS];
+        size_t index;
+        for (index = 0; index < NGIMU_SHM_RECORD_WORDS; index++) {
+            words[index] = LOAD_RELAXED(slot->words[index]);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        // Discard record if overwritten before or during copy
+        ngimuShmSubscriber->readIndex++;
+        if ((sequence != expectedSequence) || (LOAD_RELAXED(slot->sequence) != sequence)) {
+            ngimuShmSubscriber->lostCount++;
+            continue;
+        }
+        memcpy(ngimuShmRecord, words, sizeof (*ngimuShmRecord));
+        return 1;
+    }
+}
+
+/**
+ * @brief Returns the number of records that were overwritten before they were
+ * read.
+ * @param ngimuShmSubscriber Address of subscriber structure.
+ * @return Number of records lost.
+ */
+uint64_t NgimuShmSubscriberGetLostCount(const NgimuShmSubscriber * const ngimuShmSubscriber) {
+    return ngimuShmSubscriber->lostCount;
+}
+
+/**
+ * @brief Writes a record to the next slot.  The slot sequence is odd while the
+ * record is written and is then set to identify the record index so that a
+ * subscriber can detect that the slot holds a newer record.
+ * @param ngimuShmPublisher Address of publisher structure.
+ * @param ngimuShmRecord Address of record.
+ */
+static void Publish(NgimuShmPublisher * const ngimuShmPublisher, const NgimuShmRecord * const ngimuShmRecord) {
+    NgimuShmRing * const ring = ngimuShmPublisher->ring;
+    const uint64_t writeIndex = ngimuShmPublisher->writeIndex;
+    NgimuShmSlot * const slot = &ring->slots[writeIndex % ngimuShmPublisher->capacity];
+
+    // Copy record to words
+    uint32_t words[NGIMU_SHM_RECORD_WORDS];
+    words[NGIMU_SHM_RECORD_WORDS - 1] = 0;
+    memcpy(words, ngimuShmRecord, sizeof (*ngimuShmRecord));
+
+    // Write slot
+    STORE_RELAXED(slot->sequence, (2 * writeIndex) + 1);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    size_t index;
+    for (index = 0; index < NGIMU_SHM_RECORD_WORDS; index++) {
+        STORE_RELAXED(slot->words[index], words[index]);
+    }
+    STORE_RELEASE(slot->sequence, (2 * writeIndex) + 2);
+
+    // Publish
+    ngimuShmPublisher->writeIndex = writeIndex + 1;
+    STORE_RELEASE(ring->writeIndex, writeIndex + 1);
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,124 @@
+/**
+ * @file NgimuShm.h
+ * @author Seb Madgwick
+ * @brief Publishing of decoded NGIMU messages to a POSIX shared memory ring so
+ * that any number of processes on the same host may consume the messages
+ * decoded by one receiving process.  The publisher writes each record to the
+ * next slot of the ring protected by a sequence lock.  Each subscriber maps
+ * the ring read-only, reads records at its own pace and detects records that
+ * were overwritten before they were read.  The publisher is never blocked by
+ * a subscriber.
+ */
+
+#ifndef NGIMU_SHM_H
+#define NGIMU_SHM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuQueue.h"
+#include "NgimuReceive.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Default number of records in the ring.
+ */
+#define NGIMU_SHM_DEFAULT_CAPACITY (4096)
+
+/**
+ * @brief Number of 32-bit words of a record slot.
+ */
+#define NGIMU_SHM_RECORD_WORDS ((sizeof (NgimuShmRecord) + sizeof (uint32_t) - 1) / sizeof (uint32_t))
+
+/**
+ * @brief Record and the key of the NGIMU that sent it, e.g. see
+ * NgimuUdpReceiverGetKey.
+ */
+typedef struct {
+    uint64_t key;
+    NgimuQueueRecord record;
+} NgimuShmRecord;
+
+/**
+ * @brief Ring slot.  The sequence is odd while the record is written.
+ */
+typedef struct {
+    uint64_t sequence;
+    uint32_t words[NGIMU_SHM_RECORD_WORDS];
+} NgimuShmSlot;
+
+/**
+ * @brief Ring header at the start of the shared memory.  The magic number is
+ * written last so that a partially initialised ring is not used.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t recordSize;
+    uint64_t writeIndex;
+    NgimuShmSlot slots[];
+} NgimuShmRing;
+
+/**
+ * @brief Publisher structure.  Structure members are used internally and
+ * should not be used by the user application.
+ */
+typedef struct {
+    char name[64];
+    NgimuShmRing* ring;
+    size_t size;
+    uint32_t capacity;
+    uint64_t writeIndex;
+} NgimuShmPublisher;
+
+/**
+ * @brief Subscriber structure.  Structure members are used internally and
+ * should not be used by the user application.
+ */
+typedef struct {
+    const NgimuShmRing* ring;
+    size_t size;
+    uint32_t capacity;
+    uint64_t readIndex;
+    uint64_t lostCount;
+} NgimuShmSubscriber;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+int NgimuShmPublisherOpen(NgimuShmPublisher * const ngimuShmPublisher, const char * const name, const uint32_t capacity);
+void NgimuShmPublisherClose(NgimuShmPublisher * const ngimuShmPublisher, const bool unlink);
+void NgimuShmPublisherPublish(NgimuShmPublisher * const ngimuShmPublisher, const uint64_t key, const NgimuQueueRecord * const ngimuQueueRecord);
+void NgimuShmPublisherSetReceiverCallbacks(NgimuShmPublisher * const ngimuShmPublisher, NgimuReceiver * const ngimuReceiver);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+void NgimuShmPublisherSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+void NgimuShmPublisherQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+void NgimuShmPublisherEulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext);
+#endif
+int NgimuShmSubscriberOpen(NgimuShmSubscriber * const ngimuShmSubscriber, const char * const name);
+void NgimuShmSubscriberClose(NgimuShmSubscriber * const ngimuShmSubscriber);
+int NgimuShmSubscriberRead(NgimuShmSubscriber * const ngimuShmSubscriber, NgimuShmRecord * const ngimuShmRecord);
+uint64_t NgimuShmSubscriberGetLostCount(const NgimuShmSubscriber * const ngimuShmSubscriber);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,462 @@
+/**
+ * @file NgimuUdpAsync.h
+ * @author Seb Madgwick
+ * @brief Header-only C++20 coroutine interface for receiving from any number
+ * of NGIMUs via one UDP socket on a single I/O thread, e.g.
+ *
+ * Ngimu::Task consume(Ngimu::AsyncUdpReceiver& receiver) {
+ *     while (true) {
+ *         const Ngimu::DeviceMessage<NgimuSensors> sensors = co_await receiver.nextSensors();
+ *         ...
+ *     }
+ * }
+ *
+ * The I/O thread calls AsyncUdpReceiver::poll, or calls
+ * AsyncUdpReceiver::processReadable when an event loop such as epoll or
+ * Asio (asio::posix::stream_descriptor::async_wait) reports that the file
+ * descriptor is readable.  Datagrams are received in batches by
+ * NgimuUdpReceiverReceive and decoded by a receiver for each NGIMU identified
+ * by source address.  Waiting coroutines are resumed on the I/O thread once
+ * each batch has been decoded.  Messages are buffered while no coroutine is
+ * waiting.  Each message type may be awaited by one coroutine at a time.
+ */
+
+#ifndef NGIMU_UDP_ASYNC_H
+#define NGIMU_UDP_ASYNC_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuUdpReceiver.h" // must be first, see _GNU_SOURCE
+#include "NgimuReceive.h"
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <poll.h>
+#include <unordered_map>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of messages of each message type that may be buffered while
+ * no coroutine is waiting.  The oldest message is discarded and counted if
+ * the buffer is full.
+ */
+#ifndef NGIMU_UDP_ASYNC_CAPACITY
+#define NGIMU_UDP_ASYNC_CAPACITY (256)
+#endif
+
+/**
+ * @brief Maximum number of batches of datagrams received by each call to
+ * AsyncUdpReceiver::processReadable so that the I/O thread returns to the
+ * event loop under sustained traffic.
+ */
+#ifndef NGIMU_UDP_ASYNC_MAX_BATCHES
+#define NGIMU_UDP_ASYNC_MAX_BATCHES (4)
+#endif
+
+namespace Ngimu {
+
+    /**
+     * @brief Coroutine return type for a consumer that is started immediately
+     * and destroys itself on completion.
+     */
+    struct Task {
+
+        struct promise_type {
+
+            Task get_return_object() {
+                return Task();
+            }
+
+            std::suspend_never initial_suspend() {
+                return std::suspend_never();
+            }
+
+            std::suspend_never final_suspend() noexcept {
+                return std::suspend_never();
+            }
+
+            void return_void() {
+            }
+
+            void unhandled_exception() {
+                std::terminate();
+            }
+        };
+    };
+
+    /**
+     * @brief Message and the key of the NGIMU that sent it, see
+     * NgimuUdpReceiverGetKey.
+     */
+    template<typename Message>
+    struct DeviceMessage {
+        uint64_t key;
+        Message message;
+    };
+
+    /**
+     * @brief Buffer of messages of one message type and the coroutine waiting
+     * for the next message.
+     */
+    template<typename Message>
+    class Channel {
+    public:
+
+        /**
+         * @brief Awaitable returned by AsyncUdpReceiver::next... functions.
+         */
+        class Awaiter {
+        public:
+
+            explicit Awaiter(Channel& channel) : channel(channel) {
+            }
+
+            bool await_ready() {
+                return channel.pop(result);
+            }
+
+            void await_suspend(const std::coroutine_handle<> handle) {
+                assert(channel.waiter == nullptr); // one waiting coroutine per message type
+                channel.waiter = handle;
+                channel.waiterResult = &result;
+            }
+
+            DeviceMessage<Message> await_resume() {
+                return result;
+            }
+
+        private:
+            Channel& channel;
+            DeviceMessage<Message> result;
+        };
+
+        /**
+         * @brief Adds message to buffer.  The oldest message is discarded if
+         * the buffer is full.
+         * @param deviceMessage Message.
+         */
+        void push(const DeviceMessage<Message>& deviceMessage) {
+            if (numberOfMessages == buffer.size()) {
+                readIndex = (readIndex + 1) % buffer.size();
+                numberOfMessages--;
+                overflowCount++;
+            }
+            buffer[(readIndex + numberOfMessages) % buffer.size()] = deviceMessage;
+            numberOfMessages++;
+        }
+
+        /**
+         * @brief Removes the oldest message from the buffer.
+         * @param deviceMessage Message.
+         * @return True if a message was available.
+         */
+        bool pop(DeviceMessage<Message>& deviceMessage) {
+            if (numberOfMessages == 0) {
+                return false;
+            }
+            deviceMessage = buffer[readIndex];
+            readIndex = (readIndex + 1) % buffer.size();
+            numberOfMessages--;
+            return true;
+        }
+
+        /**
+         * @brief Resumes the waiting coroutine while messages are available.
+         * The coroutine may await the next message before returning.
+         */
+        void resume() {
+            while ((waiter != nullptr) && pop(*waiterResult)) {
+                const std::coroutine_handle<> handle = waiter;
+                waiter = nullptr;
+                handle.resume();
+            }
+        }
+
+        /**
+         * @brief Returns the number of messages discarded because the buffer
+         * was full.
+         * @return Number of messages discarded.
+         */
+        uint32_t getOverflowCount() const {
+            return overflowCount;
+        }
+
+    private:
+        std::array<DeviceMessage<Message>, NGIMU_UDP_ASYNC_CAPACITY> buffer;
+        size_t readIndex = 0;
+        size_t numberOfMessages = 0;
+        uint32_t overflowCount = 0;
+        std::coroutine_handle<> waiter;
+        DeviceMessage<Message>* waiterResult = nullptr;
+    };
+
+    /**
+     * @brief Coroutine UDP receiver.  The receiver cannot be copied because
+     * its address is the user context of the underlying receivers.
+     */
+    class AsyncUdpReceiver {
+    public:
+
+        AsyncUdpReceiver() {
+            ngimuUdpReceiver = std::make_unique<NgimuUdpReceiver>();
+            ngimuUdpReceiver->socket = -1;
+        }
+
+        AsyncUdpReceiver(const AsyncUdpReceiver&) = delete;
+
+        AsyncUdpReceiver& operator=(const AsyncUdpReceiver&) = delete;
+
+        ~AsyncUdpReceiver() {
+            close();
+        }
+
+        /**
+         * @brief Binds a non-blocking UDP socket to the port.
+         * @param port Local UDP port (the NGIMU send port).
+         * @return 0 if successful, otherwise -1 with errno set.
+         */
+        int open(const uint16_t port) {
+            if (NgimuUdpReceiverInitialise(ngimuUdpReceiver.get(), port) != 0) {
+                return -1;
+            }
+            if (NgimuUdpReceiverSetNonBlocking(ngimuUdpReceiver.get()) != 0) {
+                close();
+                return -1;
+            }
+            NgimuUdpReceiverSetPacketsCallback(ngimuUdpReceiver.get(), packetsCallback, this);
+            return 0;
+        }
+
+        /**
+         * @brief Closes the socket.  Buffered messages remain available.
+         */
+        void close() {
+            NgimuUdpReceiverClose(ngimuUdpReceiver.get());
+        }
+
+        /**
+         * @brief Returns the file descriptor of the socket to be monitored for
+         * readability by an event loop.
+         * @return File descriptor.
+         */
+        int getFileDescriptor() const {
+            return ngimuUdpReceiver->socket;
+        }
+
+        /**
+         * @brief Receives and decodes available datagrams without blocking and
+         * resumes the waiting coroutines after each batch so that the channels
+         * are drained before they are full.  At most
+         * NGIMU_UDP_ASYNC_MAX_BATCHES batches are received so that sustained
+         * traffic does not hold the I/O thread.  Datagrams may remain after
+         * the function returns; a level-triggered event loop reports the file
+         * descriptor as readable again, an edge-triggered event loop must call
+         * the function again while it returns
+         * NGIMU_UDP_ASYNC_MAX_BATCHES * NGIMU_UDP_RECEIVER_BATCH_SIZE.
+         * @return Number of datagrams processed, otherwise -1 with errno set.
+         */
+        int processReadable() {
+            int numberOfDatagrams = 0;
+            int batch;
+            for (batch = 0; batch < NGIMU_UDP_ASYNC_MAX_BATCHES; batch++) {
+                const int result = NgimuUdpReceiverReceive(ngimuUdpReceiver.get());
+                if (result > 0) {
+                    numberOfDatagrams += result;
+                    resume();
+                    if (result < NGIMU_UDP_RECEIVER_BATCH_SIZE) {
+                        break; // no more datagrams available
+                    }
+                    continue;
+                }
+                if ((result < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                    return -1;
+                }
+                break;
+            }
+            return numberOfDatagrams;
+        }
+
+        /**
+         * @brief Waits for the socket to be readable and then calls
+         * processReadable.
+         * @param timeout Timeout in milliseconds, or -1 to block indefinitely.
+         * @return Number of datagrams processed, otherwise -1 with errno set.
+         */
+        int poll(const int timeout) {
+            struct pollfd pollFd;
+            pollFd.fd = ngimuUdpReceiver->socket;
+            pollFd.events = POLLIN;
+            pollFd.revents = 0;
+            const int result = ::poll(&pollFd, 1, timeout);
+            if (result <= 0) {
+                return ((result < 0) && (errno != EINTR)) ? -1 : 0;
+            }
+            return processReadable();
+        }
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+        /**
+         * @brief Returns an awaitable for the next "/sensors" message of any
+         * NGIMU.
+         * @return Awaitable.
+         */
+        Channel<NgimuSensors>::Awaiter nextSensors() {
+            return Channel<NgimuSensors>::Awaiter(sensors);
+        }
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+        /**
+         * @brief Returns an awaitable for the next "/quaternion" message of any
+         * NGIMU.
+         * @return Awaitable.
+         */
+        Channel<NgimuQuaternion>::Awaiter nextQuaternion() {
+            return Channel<NgimuQuaternion>::Awaiter(quaternion);
+        }
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+        /**
+         * @brief Returns an awaitable for the next "/euler" message of any
+         * NGIMU.
+         * @return Awaitable.
+         */
+        Channel<NgimuEuler>::Awaiter nextEuler() {
+            return Channel<NgimuEuler>::Awaiter(euler);
+        }
+#endif
+
+        /**
+         * @brief Returns the number of messages discarded because no coroutine
+         * awaited them before the buffer was full.
+         * @return Number of messages discarded.
+         */
+        uint32_t getOverflowCount() const {
+            uint32_t overflowCount = 0;
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+            overflowCount += sensors.getOverflowCount();
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+            overflowCount += quaternion.getOverflowCount();
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+            overflowCount += euler.getOverflowCount();
+#endif
+            return overflowCount;
+        }
+
+        /**
+         * @brief Returns the number of NGIMUs received from.
+         * @return Number of NGIMUs.
+         */
+        size_t getNumberOfDevices() const {
+            return devices.size();
+        }
+
+    private:
+
+        struct Device {
+            AsyncUdpReceiver* owner;
+            uint64_t key;
+            NgimuReceiver ngimuReceiver;
+        };
+
+        std::unique_ptr<NgimuUdpReceiver> ngimuUdpReceiver;
+        std::unordered_map<uint64_t, std::unique_ptr<Device>> devices;
+        Device* lastDevice = nullptr;
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+        Channel<NgimuSensors> sensors;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+        Channel<NgimuQuaternion> quaternion;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+        Channel<NgimuEuler> euler;
+#endif
+
+        void resume() {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+            sensors.resume();
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+            quaternion.resume();
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+            euler.resume();
+#endif
+        }
+
+        Device& getDevice(const uint64_t key) {
+
+            // Datagrams of the same NGIMU are often consecutive
+            if ((lastDevice != nullptr) && (lastDevice->key == key)) {
+                return *lastDevice;
+            }
+
+            // Find or add device
+            std::unique_ptr<Device>& device = devices[key];
+            if (device == nullptr) {
+                device = std::make_unique<Device>();
+                device->owner = this;
+                device->key = key;
+                NgimuReceiverInitialise(&device->ngimuReceiver);
+                NgimuReceiverSetUserContext(&device->ngimuReceiver, device.get());
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+                NgimuReceiverSetSensorsCallback(&device->ngimuReceiver, sensorsCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+                NgimuReceiverSetQuaternionCallback(&device->ngimuReceiver, quaternionCallback);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+                NgimuReceiverSetEulerCallback(&device->ngimuReceiver, eulerCallback);
+#endif
+            }
+            lastDevice = device.get();
+            return *device;
+        }
+
+        static void packetsCallback(const NgimuUdpPacket * const packets, const size_t numberOfPackets, void * const userContext) {
+            AsyncUdpReceiver * const receiver = static_cast<AsyncUdpReceiver *> (userContext);
+            for (size_t index = 0; index < numberOfPackets; index++) {
+                const uint64_t key = NgimuUdpReceiverGetKey((const struct sockaddr_in *) packets[index].sourceAddress);
+                NgimuReceiverProcessUdpPacket(&receiver->getDevice(key).ngimuReceiver, packets[index].buffer, packets[index].size);
+            }
+        }
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+        static void sensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+            Device * const device = static_cast<Device *> (userContext);
+            device->owner->sensors.push({device->key, *ngimuSensors});
+        }
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+        static void quaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+            Device * const device = static_cast<Device *> (userContext);
+            device->owner->quaternion.push({device->key, *ngimuQuaternion});
+        }
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+        static void eulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+            Device * const device = static_cast<Device *> (userContext);
+            device->owner->euler.push({device->key, *ngimuEuler});
+        }
+#endif
+    };
+
+} // namespace Ngimu
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
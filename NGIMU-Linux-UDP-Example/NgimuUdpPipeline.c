@@ -0,0 +1,263 @@
+/**
+ * @file NgimuUdpPipeline.c
+ * @author Seb Madgwick
+ * @brief Multithreaded UDP receive pipeline for large numbers of NGIMUs.
+ * Worker threads each receive from their own socket bound to the same port
+ * with SO_REUSEPORT so that the kernel shards NGIMUs between workers by source
+ * address.  Each worker decodes the datagrams of its NGIMUs with a receiver per
+ * NGIMU and publishes the decoded messages to a lock-free queue per NGIMU.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuUdpPipeline.h"
+#include <errno.h>
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static void* WorkerThread(void* arg);
+static void PacketsCallback(const NgimuUdpPacket * const packets, const size_t numberOfPackets, void * const userContext);
+static NgimuUdpPipelineDevice* GetDevice(NgimuUdpPipelineWorker * const worker, const uint64_t key);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the pipeline and starts the worker threads.  The number
+ * of workers would typically be the number of cores available for receiving.
+ * @param ngimuUdpPipeline Address of pipeline structure.
+ * @param port Local UDP port (the NGIMU send port).
+ * @param numberOfWorkers Number of worker threads, from 1 to
+ * NGIMU_UDP_PIPELINE_MAX_WORKERS.
+ * @return 0 if successful, otherwise -1 with errno set.
+ */
+int NgimuUdpPipelineStart(NgimuUdpPipeline * const ngimuUdpPipeline, const uint16_t port, const unsigned int numberOfWorkers) {
+    memset(ngimuUdpPipeline, 0, sizeof (*ngimuUdpPipeline));
+    if ((numberOfWorkers == 0) || (numberOfWorkers > NGIMU_UDP_PIPELINE_MAX_WORKERS)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Bind all sockets before any thread receives so that the kernel
+    // distributes datagrams between all workers from the first datagram
+    unsigned int index;
+    for (index = 0; index < numberOfWorkers; index++) {
+        NgimuUdpPipelineWorker * const worker = &ngimuUdpPipeline->workers[index];
+        worker->stop = &ngimuUdpPipeline->stop;
+        if (NgimuUdpReceiverInitialiseShared(&worker->ngimuUdpReceiver, port) != 0) {
+            NgimuUdpPipelineStop(ngimuUdpPipeline);
+            return -1;
+        }
+        ngimuUdpPipeline->numberOfWorkers++;
+        if (NgimuUdpReceiverSetTimeout(&worker->ngimuUdpReceiver, NGIMU_UDP_PIPELINE_STOP_POLL_PERIOD) != 0) {
+            NgimuUdpPipelineStop(ngimuUdpPipeline);
+            return -1;
+        }
+        NgimuUdpReceiverSetPacketsCallback(&worker->ngimuUdpReceiver, PacketsCallback, worker);
+    }
+
+    // Start threads
+    for (index = 0; index < numberOfWorkers; index++) {
+        NgimuUdpPipelineWorker * const worker = &ngimuUdpPipeline->workers[index];
+        const int error = pthread_create(&worker->thread, NULL, WorkerThread, worker);
+        if (error != 0) {
+            NgimuUdpPipelineStop(ngimuUdpPipeline);
+            errno = error;
+            return -1;
+        }
+        worker->running = true;
+    }
+    return 0;
+}
+
+/**
+ * @brief Stops the worker threads and closes the sockets.  Records that have
+ * not been processed remain available to NgimuUdpPipelineProcess.
+ * @param ngimuUdpPipeline Address of pipeline structure.
+ */
+void NgimuUdpPipelineStop(NgimuUdpPipeline * const ngimuUdpPipeline) {
+    __atomic_store_n(&ngimuUdpPipeline->stop, true, __ATOMIC_RELEASE);
+    unsigned int index;
+    for (index = 0; index < ngimuUdpPipeline->numberOfWorkers; index++) {
+        NgimuUdpPipelineWorker * const worker = &ngimuUdpPipeline->workers[index];
+        if (worker->running) {
+            pthread_join(worker->thread, NULL);
+            worker->running = false;
+        }
+        NgimuUdpReceiverClose(&worker->ngimuUdpReceiver);
+    }
+}
+
+/**
+ * @brief Returns the number of worker threads.
+ * @param ngimuUdpPipeline Address of pipeline structure.
+ * @return Number of worker threads.
+ */
+unsigned int NgimuUdpPipelineGetNumberOfWorkers(const NgimuUdpPipeline * const ngimuUdpPipeline) {
+    return ngimuUdpPipeline->numberOfWorkers;
+}
+
+/**
+ * @brief Pops all records published by a worker and passes each to the record
+ * callback with the key of the NGIMU, see NgimuUdpReceiverGetKey.  The records
+ * of each worker must be processed by only one thread at a time, e.g. one
+ * consumer thread per worker.  Records of the same NGIMU are provided in the
+ * order received.
+ * @param ngimuUdpPipeline Address of pipeline structure.
+ * @param workerIndex Worker index.
+ * @param recordCallback Record callback function.
+ * @param userContext User context passed to the callback function.
+ * @return Number of records processed.
+ */
+size_t NgimuUdpPipelineProcessWorker(NgimuUdpPipeline * const ngimuUdpPipeline, const unsigned int workerIndex, void (*recordCallback)(const uint64_t key, const NgimuQueueRecord * const ngimuQueueRecord, void * const userContext), void * const userContext) {
+    NgimuUdpPipelineWorker * const worker = &ngimuUdpPipeline->workers[workerIndex];
+    const uint32_t numberOfDevices = __atomic_load_n(&worker->numberOfDevices, __ATOMIC_ACQUIRE);
+    size_t numberOfRecords = 0;
+    uint32_t index;
+    for (index = 0; index < numberOfDevices; index++) {
+        NgimuUdpPipelineDevice * const device = &worker->devices[index];
+        NgimuQueueRecord ngimuQueueRecord;
+        while (NgimuQueuePop(&device->ngimuQueue, &ngimuQueueRecord)) {
+            recordCallback(device->key, &ngimuQueueRecord, userContext);
+            numberOfRecords++;
+        }
+    }
+    return numberOfRecords;
+}
+
+/**
+ * @brief Pops all records published by all workers.  This function must only
+ * be called from a single consumer thread.  See NgimuUdpPipelineProcessWorker.
+ * @param ngimuUdpPipeline Address of pipeline structure.
+ * @param recordCallback Record callback function.
+ * @param userContext User context passed to the callback function.
+ * @return Number of records processed.
+ */
+size_t NgimuUdpPipelineProcess(NgimuUdpPipeline * const ngimuUdpPipeline, void (*recordCallback)(const uint64_t key, const NgimuQueueRecord * const ngimuQueueRecord, void * const userContext), void * const userContext) {
+    size_t numberOfRecords = 0;
+    unsigned int index;
+    for (index = 0; index < ngimuUdpPipeline->numberOfWorkers; index++) {
+        numberOfRecords += NgimuUdpPipelineProcessWorker(ngimuUdpPipeline, index, recordCallback, userContext);
+    }
+    return numberOfRecords;
+}
+
+/**
+ * @brief Returns the number of datagrams discarded because a worker already
+ * had NGIMU_UDP_PIPELINE_MAX_DEVICES NGIMUs.
+ * @param ngimuUdpPipeline Address of pipeline structure.
+ * @return Number of datagrams discarded.
+ */
+uint32_t NgimuUdpPipelineGetDiscardedCount(NgimuUdpPipeline * const ngimuUdpPipeline) {
+    uint32_t discardedCount = 0;
+    unsigned int index;
+    for (index = 0; index < ngimuUdpPipeline->numberOfWorkers; index++) {
+        discardedCount += __atomic_load_n(&ngimuUdpPipeline->workers[index].discardedCount, __ATOMIC_RELAXED);
+    }
+    return discardedCount;
+}
+
+/**
+ * @brief Returns the number of records discarded because the queue of an
+ * NGIMU was full.  NGIMU_QUEUE_CAPACITY should be increased if records are
+ * discarded.
+ * @param ngimuUdpPipeline Address of pipeline structure.
+ * @return Number of records discarded.
+ */
+uint32_t NgimuUdpPipelineGetOverflowCount(NgimuUdpPipeline * const ngimuUdpPipeline) {
+    uint32_t overflowCount = 0;
+    unsigned int workerIndex;
+    for (workerIndex = 0; workerIndex < ngimuUdpPipeline->numberOfWorkers; workerIndex++) {
+        NgimuUdpPipelineWorker * const worker = &ngimuUdpPipeline->workers[workerIndex];
+        const uint32_t numberOfDevices = __atomic_load_n(&worker->numberOfDevices, __ATOMIC_ACQUIRE);
+        uint32_t index;
+        for (index = 0; index < numberOfDevices; index++) {
+            overflowCount += NgimuQueueGetOverflowCount(&worker->devices[index].ngimuQueue);
+        }
+    }
+    return overflowCount;
+}
+
+/**
+ * @brief Worker thread.  Receives and decodes datagrams until the pipeline is
+ * stopped or the socket fails.
+ * @param arg Address of worker structure.
+ * @return NULL.
+ */
+static void* WorkerThread(void* arg) {
+    NgimuUdpPipelineWorker * const worker = (NgimuUdpPipelineWorker *) arg;
+    while (__atomic_load_n(worker->stop, __ATOMIC_ACQUIRE) == false) {
+        if (NgimuUdpReceiverReceive(&worker->ngimuUdpReceiver) >= 0) {
+            continue;
+        }
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Packets callback of the worker UDP receiver.  Passes each datagram to
+ * the receiver of its NGIMU.
+ * @param packets Received datagrams.
+ * @param numberOfPackets Number of datagrams.
+ * @param userContext Address of worker structure.
+ */
+static void PacketsCallback(const NgimuUdpPacket * const packets, const size_t numberOfPackets, void * const userContext) {
+    NgimuUdpPipelineWorker * const worker = (NgimuUdpPipelineWorker *) userContext;
+    size_t index;
+    for (index = 0; index < numberOfPackets; index++) {
+        const uint64_t key = NgimuUdpReceiverGetKey((const struct sockaddr_in *) packets[index].sourceAddress);
+        NgimuUdpPipelineDevice * const device = GetDevice(worker, key);
+        if (device == NULL) {
+            __atomic_store_n(&worker->discardedCount, worker->discardedCount + 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        NgimuReceiverProcessUdpPacket(&device->ngimuReceiver, packets[index].buffer, packets[index].size);
+    }
+}
+
+/**
+ * @brief Returns the device of a key, adding a device if the key is new.  A
+ * new device is only visible to the consumer once initialised.
+ * @param worker Address of worker structure.
+ * @param key Device key.
+ * @return Address of device structure, or NULL if the maximum number of
+ * devices has been reached.
+ */
+static NgimuUdpPipelineDevice* GetDevice(NgimuUdpPipelineWorker * const worker, const uint64_t key) {
+
+    // Datagrams of the same NGIMU are often consecutive
+    if ((worker->lastDevice != NULL) && (worker->lastDevice->key == key)) {
+        return worker->lastDevice;
+    }
+
+    // Find existing device
+    uint32_t index;
+    for (index = 0; index < worker->numberOfDevices; index++) {
+        if (worker->devices[index].key == key) {
+            worker->lastDevice = &worker->devices[index];
+            return worker->lastDevice;
+        }
+    }
+
+    // Add device
+    if (worker->numberOfDevices >= NGIMU_UDP_PIPELINE_MAX_DEVICES) {
+        return NULL;
+    }
+    NgimuUdpPipelineDevice * const device = &worker->devices[worker->numberOfDevices];
+    device->key = key;
+    NgimuReceiverInitialise(&device->ngimuReceiver);
+    NgimuQueueInitialise(&device->ngimuQueue);
+    NgimuQueueSetReceiverCallbacks(&device->ngimuQueue, &device->ngimuReceiver);
+    __atomic_store_n(&worker->numberOfDevices, worker->numberOfDevices + 1, __ATOMIC_RELEASE);
+    worker->lastDevice = device;
+    return device;
+}
+
+//------------------------------------------------------------------------------
+// End of file
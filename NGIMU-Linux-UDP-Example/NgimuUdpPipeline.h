@@ -0,0 +1,106 @@
+/**
+ * @file NgimuUdpPipeline.h
+ * @author Seb Madgwick
+ * @brief Multithreaded UDP receive pipeline for large numbers of NGIMUs.
+ * Worker threads each receive from their own socket bound to the same port
+ * with SO_REUSEPORT so that the kernel shards NGIMUs between workers by source
+ * address.  Each worker decodes the datagrams of its NGIMUs with a receiver per
+ * NGIMU and publishes the decoded messages to a lock-free queue per NGIMU.
+ */
+
+#ifndef NGIMU_UDP_PIPELINE_H
+#define NGIMU_UDP_PIPELINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuUdpReceiver.h" // must be first, see _GNU_SOURCE
+#include "NgimuQueue.h"
+#include "NgimuReceive.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of worker threads.
+ */
+#ifndef NGIMU_UDP_PIPELINE_MAX_WORKERS
+#define NGIMU_UDP_PIPELINE_MAX_WORKERS (8)
+#endif
+
+/**
+ * @brief Maximum number of NGIMUs per worker.  Datagrams from further NGIMUs
+ * are discarded and counted.
+ */
+#ifndef NGIMU_UDP_PIPELINE_MAX_DEVICES
+#define NGIMU_UDP_PIPELINE_MAX_DEVICES (32)
+#endif
+
+/**
+ * @brief Time in milliseconds that a worker blocks for before checking if the
+ * pipeline has been stopped.
+ */
+#define NGIMU_UDP_PIPELINE_STOP_POLL_PERIOD (100)
+
+/**
+ * @brief Device structure.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    uint64_t key;
+    NgimuReceiver ngimuReceiver;
+    NgimuQueue ngimuQueue;
+} NgimuUdpPipelineDevice;
+
+/**
+ * @brief Worker structure.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    NgimuUdpReceiver ngimuUdpReceiver;
+    pthread_t thread;
+    bool running;
+    const bool* stop;
+    NgimuUdpPipelineDevice devices[NGIMU_UDP_PIPELINE_MAX_DEVICES];
+    uint32_t numberOfDevices;
+    NgimuUdpPipelineDevice* lastDevice;
+    uint32_t discardedCount;
+} NgimuUdpPipelineWorker;
+
+/**
+ * @brief Pipeline structure.  Structure members are used internally and should
+ * not be used by the user application.
+ */
+typedef struct {
+    NgimuUdpPipelineWorker workers[NGIMU_UDP_PIPELINE_MAX_WORKERS];
+    unsigned int numberOfWorkers;
+    bool stop;
+} NgimuUdpPipeline;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+int NgimuUdpPipelineStart(NgimuUdpPipeline * const ngimuUdpPipeline, const uint16_t port, const unsigned int numberOfWorkers);
+void NgimuUdpPipelineStop(NgimuUdpPipeline * const ngimuUdpPipeline);
+unsigned int NgimuUdpPipelineGetNumberOfWorkers(const NgimuUdpPipeline * const ngimuUdpPipeline);
+size_t NgimuUdpPipelineProcessWorker(NgimuUdpPipeline * const ngimuUdpPipeline, const unsigned int workerIndex, void (*recordCallback)(const uint64_t key, const NgimuQueueRecord * const ngimuQueueRecord, void * const userContext), void * const userContext);
+size_t NgimuUdpPipelineProcess(NgimuUdpPipeline * const ngimuUdpPipeline, void (*recordCallback)(const uint64_t key, const NgimuQueueRecord * const ngimuQueueRecord, void * const userContext), void * const userContext);
+uint32_t NgimuUdpPipelineGetDiscardedCount(NgimuUdpPipeline * const ngimuUdpPipeline);
+uint32_t NgimuUdpPipelineGetOverflowCount(NgimuUdpPipeline * const ngimuUdpPipeline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,237 @@
+/**
+ * @file NgimuUdpReceiver.c
+ * @author Seb Madgwick
+ * @brief Linux UDP receiver that uses recvmmsg to receive a batch of datagrams
+ * per system call and passes them to NgimuReceiveProcessUdpPackets, to a
+ * merge of multiple NGIMUs identified by source address, or to a packets
+ * callback.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuUdpReceiver.h"
+#include <arpa/inet.h> // ntohl, ntohs
+#include <fcntl.h> // fcntl, O_NONBLOCK
+#include <string.h> // memset
+#include <sys/time.h> // timeval
+#include <time.h>
+#include <unistd.h> // close
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static int Initialise(NgimuUdpReceiver * const ngimuUdpReceiver, const uint16_t port, const bool reusePort);
+static void GetReceiveTime(OscTimeTag * const receiveTime);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises receiver and binds a UDP socket to the port.
+ * @param ngimuUdpReceiver Address of receiver structure.
+ * @param port Local UDP port (the NGIMU send port).
+ * @return 0 if successful, otherwise -1 with errno set.
+ */
+int NgimuUdpReceiverInitialise(NgimuUdpReceiver * const ngimuUdpReceiver, const uint16_t port) {
+    return Initialise(ngimuUdpReceiver, port, false);
+}
+
+/**
+ * @brief Initialises receiver and binds a UDP socket to the port with
+ * SO_REUSEPORT so that several receivers may share the port.  The kernel
+ * distributes datagrams between the sockets by a hash of the source address
+ * and port, so all datagrams of an NGIMU are received by the same receiver.
+ * All receivers should be initialised before datagrams arrive.
+ * @param ngimuUdpReceiver Address of receiver structure.
+ * @param port Local UDP port (the NGIMU send port).
+ * @return 0 if successful, otherwise -1 with errno set.
+ */
+int NgimuUdpReceiverInitialiseShared(NgimuUdpReceiver * const ngimuUdpReceiver, const uint16_t port) {
+    return Initialise(ngimuUdpReceiver, port, true);
+}
+
+/**
+ * @brief Sets the maximum time that NgimuUdpReceiverReceive blocks for, after
+ * which it fails with errno set to EAGAIN.
+ * @param ngimuUdpReceiver Address of receiver structure.
+ * @param timeout Timeout in milliseconds, or 0 to block indefinitely.
+ * @return 0 if successful, otherwise -1 with errno set.
+ */
+int NgimuUdpReceiverSetTimeout(NgimuUdpReceiver * const ngimuUdpReceiver, const unsigned int timeout) {
+    struct timeval timeval;
+    timeval.tv_sec = timeout / 1000;
+    timeval.tv_usec = (timeout % 1000) * 1000;
+    return setsockopt(ngimuUdpReceiver->socket, SOL_SOCKET, SO_RCVTIMEO, &timeval, sizeof (timeval));
+}
+
+/**
+ * @brief Sets the socket to non-blocking so that NgimuUdpReceiverReceive fails
+ * with errno set to EAGAIN if no datagrams are available, e.g. when the socket
+ * is monitored by an event loop.
+ * @param ngimuUdpReceiver Address of receiver structure.
+ * @return 0 if successful, otherwise -1 with errno set.
+ */
+int NgimuUdpReceiverSetNonBlocking(NgimuUdpReceiver * const ngimuUdpReceiver) {
+    const int flags = fcntl(ngimuUdpReceiver->socket, F_GETFL);
+    if (flags < 0) {
+        return -1;
+    }
+    return fcntl(ngimuUdpReceiver->socket, F_SETFL, flags | O_NONBLOCK);
+}
+
+/**
+ * @brief Sets the merge that received datagrams are passed to instead of the
+ * NgimuReceive module.  Each source address and port is a separate device.
+ * @param ngimuUdpReceiver Address of receiver structure.
+ * @param ngimuMerge Address of merge structure, or NULL to use the NgimuReceive
+ * module.
+ */
+void NgimuUdpReceiverSetMerge(NgimuUdpReceiver * const ngimuUdpReceiver, NgimuMerge * const ngimuMerge) {
+    ngimuUdpReceiver->ngimuMerge = ngimuMerge;
+}
+
+/**
+ * @brief Sets the packets callback that received datagrams are passed to
+ * instead of the merge or NgimuReceive module.  The packets are only valid for
+ * the duration of the callback.
+ * @param ngimuUdpReceiver Address of receiver structure.
+ * @param newPacketsCallback Packets callback function, or NULL.
+ * @param userContext User context passed to the callback function.
+ */
+void NgimuUdpReceiverSetPacketsCallback(NgimuUdpReceiver * const ngimuUdpReceiver, void (*newPacketsCallback)(const NgimuUdpPacket * const packets, const size_t numberOfPackets, void * const userContext), void * const userContext) {
+    ngimuUdpReceiver->packetsCallback = newPacketsCallback;
+    ngimuUdpReceiver->userContext = userContext;
+}
+
+/**
+ * @brief Returns the merge device key of a source address, e.g. to add devices
+ * in a fixed order with NgimuMergeAddDevice.
+ * @param sourceAddress Source address.
+ * @return Device key.
+ */
+uint64_t NgimuUdpReceiverGetKey(const struct sockaddr_in * const sourceAddress) {
+    return ((uint64_t) ntohl(sourceAddress->sin_addr.s_addr) << 16) | ntohs(sourceAddress->sin_port);
+}
+
+/**
+ * @brief Closes the receiver socket.
+ * @param ngimuUdpReceiver Address of receiver structure.
+ */
+void NgimuUdpReceiverClose(NgimuUdpReceiver * const ngimuUdpReceiver) {
+    if (ngimuUdpReceiver->socket >= 0) {
+        close(ngimuUdpReceiver->socket);
+        ngimuUdpReceiver->socket = -1;
+    }
+}
+
+/**
+ * @brief Blocks until at least one datagram is available, then receives all
+ * available datagrams (up to NGIMU_UDP_RECEIVER_BATCH_SIZE) with a single
+ * system call and processes them as a batch.
+ * @param ngimuUdpReceiver Address of receiver structure.
+ * @return Number of datagrams processed, otherwise -1 with errno set.
+ */
+int NgimuUdpReceiverReceive(NgimuUdpReceiver * const ngimuUdpReceiver) {
+
+    // Reset source address lengths overwritten by previous call
+    unsigned int index;
+    for (index = 0; index < NGIMU_UDP_RECEIVER_BATCH_SIZE; index++) {
+        ngimuUdpReceiver->messages[index].msg_hdr.msg_namelen = sizeof (ngimuUdpReceiver->sourceAddresses[index]);
+    }
+
+    // Receive batch
+    const int numberOfMessages = recvmmsg(ngimuUdpReceiver->socket, ngimuUdpReceiver->messages, NGIMU_UDP_RECEIVER_BATCH_SIZE, MSG_WAITFORONE, NULL);
+    if (numberOfMessages < 0) {
+        return -1;
+    }
+
+    // Process batch
+    for (index = 0; index < (unsigned int) numberOfMessages; index++) {
+        ngimuUdpReceiver->packets[index].size = ngimuUdpReceiver->messages[index].msg_len;
+    }
+    if (ngimuUdpReceiver->packetsCallback != NULL) {
+        ngimuUdpReceiver->packetsCallback(ngimuUdpReceiver->packets, (size_t) numberOfMessages, ngimuUdpReceiver->userContext);
+        return numberOfMessages;
+    }
+    if (ngimuUdpReceiver->ngimuMerge == NULL) {
+        NgimuReceiveProcessUdpPackets(ngimuUdpReceiver->packets, (size_t) numberOfMessages);
+        return numberOfMessages;
+    }
+
+    // Process batch by merge.  All datagrams of the batch are given the same
+    // receive time; the clock offset estimate uses the minimum delay so is
+    // not biased by datagrams that waited in the socket buffer.
+    OscTimeTag receiveTime;
+    GetReceiveTime(&receiveTime);
+    for (index = 0; index < (unsigned int) numberOfMessages; index++) {
+        const uint64_t key = NgimuUdpReceiverGetKey((const struct sockaddr_in *) &ngimuUdpReceiver->sourceAddresses[index]);
+        NgimuMergeProcessUdpPacket(ngimuUdpReceiver->ngimuMerge, key, &receiveTime, ngimuUdpReceiver->packets[index].buffer, ngimuUdpReceiver->packets[index].size);
+    }
+    return numberOfMessages;
+}
+
+/**
+ * @brief Initialises receiver and binds a UDP socket to the port.
+ * @param ngimuUdpReceiver Address of receiver structure.
+ * @param port Local UDP port.
+ * @param reusePort True to allow other sockets to bind to the same port.
+ * @return 0 if successful, otherwise -1 with errno set.
+ */
+static int Initialise(NgimuUdpReceiver * const ngimuUdpReceiver, const uint16_t port, const bool reusePort) {
+
+    // Create socket
+    ngimuUdpReceiver->socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (ngimuUdpReceiver->socket < 0) {
+        return -1;
+    }
+
+    // Allow port to be shared
+    const int enable = 1;
+    if (reusePort && (setsockopt(ngimuUdpReceiver->socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof (enable)) != 0)) {
+        close(ngimuUdpReceiver->socket);
+        ngimuUdpReceiver->socket = -1;
+        return -1;
+    }
+
+    // Bind to port
+    struct sockaddr_in localAddress;
+    memset(&localAddress, 0, sizeof (localAddress));
+    localAddress.sin_family = AF_INET;
+    localAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+    localAddress.sin_port = htons(port);
+    if (bind(ngimuUdpReceiver->socket, (const struct sockaddr *) &localAddress, sizeof (localAddress)) != 0) {
+        close(ngimuUdpReceiver->socket);
+        ngimuUdpReceiver->socket = -1;
+        return -1;
+    }
+
+    // Point each message header at its buffer and source address
+    ngimuUdpReceiver->ngimuMerge = NULL;
+    ngimuUdpReceiver->packetsCallback = NULL;
+    memset(ngimuUdpReceiver->messages, 0, sizeof (ngimuUdpReceiver->messages));
+    unsigned int index;
+    for (index = 0; index < NGIMU_UDP_RECEIVER_BATCH_SIZE; index++) {
+        ngimuUdpReceiver->iovecs[index].iov_base = ngimuUdpReceiver->buffers[index];
+        ngimuUdpReceiver->iovecs[index].iov_len = sizeof (ngimuUdpReceiver->buffers[index]);
+        ngimuUdpReceiver->messages[index].msg_hdr.msg_iov = &ngimuUdpReceiver->iovecs[index];
+        ngimuUdpReceiver->messages[index].msg_hdr.msg_iovlen = 1;
+        ngimuUdpReceiver->messages[index].msg_hdr.msg_name = &ngimuUdpReceiver->sourceAddresses[index];
+        ngimuUdpReceiver->packets[index].buffer = ngimuUdpReceiver->buffers[index];
+        ngimuUdpReceiver->packets[index].sourceAddress = &ngimuUdpReceiver->sourceAddresses[index];
+    }
+    return 0;
+}
+
+/**
+ * @brief Gets the monotonic time in OSC time tag units.
+ * @param receiveTime Address of time tag to be written.
+ */
+static void GetReceiveTime(OscTimeTag * const receiveTime) {
+    struct timespec timespec;
+    clock_gettime(CLOCK_MONOTONIC, &timespec);
+    receiveTime->value = ((uint64_t) timespec.tv_sec << 32) | (((uint64_t) timespec.tv_nsec << 32) / 1000000000);
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,74 @@
+/**
+ * @file NgimuUdpReceiver.h
+ * @author Seb Madgwick
+ * @brief Linux UDP receiver that uses recvmmsg to receive a batch of datagrams
+ * per system call and passes them to NgimuReceiveProcessUdpPackets, to a
+ * merge of multiple NGIMUs identified by source address, or to a packets
+ * callback.
+ */
+
+#ifndef NGIMU_UDP_RECEIVER_H
+#define NGIMU_UDP_RECEIVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//------------------------------------------------------------------------------
+// Includes
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // recvmmsg, must be defined before any system header
+#endif
+
+#include "NgimuMerge.h"
+#include "NgimuReceive.h"
+#include <netinet/in.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of datagrams received per system call.
+ */
+#define NGIMU_UDP_RECEIVER_BATCH_SIZE (64)
+
+/**
+ * @brief UDP receiver structure.  Structure members are used internally and
+ * should not be used by the user application.
+ */
+typedef struct {
+    int socket;
+    struct mmsghdr messages[NGIMU_UDP_RECEIVER_BATCH_SIZE];
+    struct iovec iovecs[NGIMU_UDP_RECEIVER_BATCH_SIZE];
+    struct sockaddr_storage sourceAddresses[NGIMU_UDP_RECEIVER_BATCH_SIZE];
+    char buffers[NGIMU_UDP_RECEIVER_BATCH_SIZE][MAX_TRANSPORT_SIZE];
+    NgimuUdpPacket packets[NGIMU_UDP_RECEIVER_BATCH_SIZE];
+    NgimuMerge* ngimuMerge;
+    void (*packetsCallback)(const NgimuUdpPacket * const packets, const size_t numberOfPackets, void * const userContext);
+    void* userContext;
+} NgimuUdpReceiver;
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+int NgimuUdpReceiverInitialise(NgimuUdpReceiver * const ngimuUdpReceiver, const uint16_t port);
+int NgimuUdpReceiverInitialiseShared(NgimuUdpReceiver * const ngimuUdpReceiver, const uint16_t port);
+int NgimuUdpReceiverSetTimeout(NgimuUdpReceiver * const ngimuUdpReceiver, const unsigned int timeout);
+int NgimuUdpReceiverSetNonBlocking(NgimuUdpReceiver * const ngimuUdpReceiver);
+void NgimuUdpReceiverSetMerge(NgimuUdpReceiver * const ngimuUdpReceiver, NgimuMerge * const ngimuMerge);
+void NgimuUdpReceiverSetPacketsCallback(NgimuUdpReceiver * const ngimuUdpReceiver, void (*newPacketsCallback)(const NgimuUdpPacket * const packets, const size_t numberOfPackets, void * const userContext), void * const userContext);
+uint64_t NgimuUdpReceiverGetKey(const struct sockaddr_in * const sourceAddress);
+void NgimuUdpReceiverClose(NgimuUdpReceiver * const ngimuUdpReceiver);
+int NgimuUdpReceiverReceive(NgimuUdpReceiver * const ngimuUdpReceiver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,331 @@
+/**
+ * @file main.c
+ * @author Seb Madgwick
+ * @brief Example for receiving data from one or more NGIMUs on Linux via UDP.
+ *
+ * Build:
+ * Compile main.c, NgimuUdpReceiver.c, NgimuUdpPipeline.c, NgimuShm.c,
+ * ../NGIMU-C-Cpp-Example/NgimuReceive.c, ../NGIMU-C-Cpp-Example/NgimuAlign.c,
+ * ../NGIMU-C-Cpp-Example/NgimuMerge.c, ../NGIMU-C-Cpp-Example/NgimuQueue.c and
+ * the OSC99 source files, with ../NGIMU-C-Cpp-Example and the "Osc99"
+ * directory on the include path, and link with -pthread (and -lrt for glibc
+ * versions before 2.17).
+ *
+ * Usage:
+ * ngimu-udp [port] [merge | capture file | threads number | publish name |
+ * subscribe name]
+ *
+ * If "merge" is specified then the messages of all NGIMUs are merged into
+ * time-aligned frames, each NGIMU being identified by its IP address and port.
+ * If "capture" is specified then all received datagrams are recorded to the
+ * file for replay by NGIMU-Capture-Replay.  Capture requires
+ * NGIMU_RECEIVE_ENABLE_CAPTURE to be defined as 1 and NgimuCapture.c.  If
+ * "threads" is specified then the NGIMUs are shared between the number of
+ * receive threads and the messages of each NGIMU are printed with its key.
+ * If "publish" is specified then all messages are written to the shared
+ * memory of the name, e.g. "/ngimu", instead of being printed.  If
+ * "subscribe" is specified then the port is not opened and the messages
+ * written to the shared memory by another ngimu-udp process are printed.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "NgimuUdpReceiver.h" // must be first, see _GNU_SOURCE
+#include "NgimuUdpPipeline.h"
+#include <errno.h>
+#include "NgimuReceive.h"
+#include "NgimuShm.h"
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+#include "NgimuCapture.h"
+#endif
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h> // atoi
+#include <string.h> // strcmp
+#include <time.h>
+
+//------------------------------------------------------------------------------
+// Variable declarations
+
+static NgimuUdpReceiver ngimuUdpReceiver;
+static NgimuMerge ngimuMerge;
+static NgimuUdpPipeline ngimuUdpPipeline;
+static NgimuShmPublisher ngimuShmPublisher;
+static volatile sig_atomic_t stopRequested;
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+static NgimuCaptureWriter ngimuCaptureWriter;
+#endif
+
+//------------------------------------------------------------------------------
+// Function prototypes
+
+static void SignalHandler(int signal);
+static void NgimuReceiveErrorCallback(const char* const errorMessage);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+static void NgimuSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+static void NgimuQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+static void NgimuEulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext);
+#endif
+static void NgimuMergeFrameCallback(const NgimuMergeFrame * const ngimuMergeFrame, void * const userContext);
+static int RunPipeline(const uint16_t port, const unsigned int numberOfWorkers);
+static void NgimuUdpPipelineRecordCallback(const uint64_t key, const NgimuQueueRecord * const ngimuQueueRecord, void * const userContext);
+static int RunSubscriber(const char * const name);
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+static void CaptureWrite(const char * const data, const size_t size, void * const userContext);
+static uint64_t CaptureGetTimestamp(void * const userContext);
+#endif
+
+//------------------------------------------------------------------------------
+// Functions
+
+int main(int argc, char* argv[]) {
+
+    // Stop receiving on Ctrl+C so that the capture file is closed
+    struct sigaction action;
+    memset(&action, 0, sizeof (action));
+    action.sa_handler = SignalHandler;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    // Receive with multiple threads
+    const uint16_t port = (argc > 1) ? (uint16_t) atoi(argv[1]) : 8001;
+    if ((argc > 3) && (strcmp(argv[2], "threads") == 0)) {
+        return RunPipeline(port, (unsigned int) atoi(argv[3]));
+    }
+
+    // Print messages published by another process
+    if ((argc > 3) && (strcmp(argv[2], "subscribe") == 0)) {
+        return RunSubscriber(argv[3]);
+    }
+
+    // Initialise UDP receiver
+    if (NgimuUdpReceiverInitialise(&ngimuUdpReceiver, port) != 0) {
+        perror("Unable to open UDP port");
+        return EXIT_FAILURE;
+    }
+
+    // Initialise NGIMU receive module
+    NgimuReceiveInitialise();
+
+    // Assign NGIMU receive callback functions
+    NgimuReceiveSetReceiveErrorCallback(NgimuReceiveErrorCallback);
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+    NgimuReceiveSetSensorsPointerCallback(NgimuSensorsCallback, NULL);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+    NgimuReceiveSetQuaternionPointerCallback(NgimuQuaternionCallback, NULL);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+    NgimuReceiveSetEulerPointerCallback(NgimuEulerCallback, NULL);
+#endif
+
+    // Initialise merge
+    if ((argc > 2) && (strcmp(argv[2], "merge") == 0)) {
+        NgimuMergeInitialise(&ngimuMerge);
+        NgimuMergeSetFrameCallback(&ngimuMerge, NgimuMergeFrameCallback, NULL);
+        NgimuUdpReceiverSetMerge(&ngimuUdpReceiver, &ngimuMerge);
+    }
+
+    // Initialise shared memory publisher
+    const bool publish = (argc > 3) && (strcmp(argv[2], "publish") == 0);
+    if (publish) {
+        if (NgimuShmPublisherOpen(&ngimuShmPublisher, argv[3], NGIMU_SHM_DEFAULT_CAPACITY) != 0) {
+            perror("Unable to open shared memory");
+            NgimuUdpReceiverClose(&ngimuUdpReceiver);
+            return EXIT_FAILURE;
+        }
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+        NgimuReceiveSetSensorsPointerCallback(NgimuShmPublisherSensorsCallback, &ngimuShmPublisher);
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+        NgimuReceiveSetQuaternionPointerCallback(NgimuShmPublisherQuaternionCallback, &ngimuShmPublisher);
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+        NgimuReceiveSetEulerPointerCallback(NgimuShmPublisherEulerCallback, &ngimuShmPublisher);
+#endif
+    }
+
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+    // Initialise capture
+    FILE* captureFile = NULL;
+    if ((argc > 3) && (strcmp(argv[2], "capture") == 0)) {
+        captureFile = fopen(argv[3], "wb");
+        if (captureFile == NULL) {
+            perror("Unable to open capture file");
+            NgimuUdpReceiverClose(&ngimuUdpReceiver);
+            return EXIT_FAILURE;
+        }
+        NgimuCaptureWriterInitialise(&ngimuCaptureWriter, CaptureWrite, CaptureGetTimestamp, captureFile);
+        NgimuReceiveSetCaptureCallback(NgimuCaptureWriterCaptureCallback, &ngimuCaptureWriter);
+    }
+#endif
+
+    // Receive and process datagrams
+    while (NgimuUdpReceiverReceive(&ngimuUdpReceiver) >= 0) {
+    }
+    const bool interrupted = errno == EINTR;
+    if (interrupted == false) {
+        perror("Receive failed");
+    }
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+    if (captureFile != NULL) {
+        fclose(captureFile);
+    }
+#endif
+    if (publish) {
+        NgimuShmPublisherClose(&ngimuShmPublisher, true);
+    }
+    NgimuUdpReceiverClose(&ngimuUdpReceiver);
+    return interrupted ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// This function is called on SIGINT and SIGTERM to interrupt recvmmsg
+static void SignalHandler(int signal) {
+    stopRequested = 1;
+}
+
+// This function is called each time there is a receive error
+static void NgimuReceiveErrorCallback(const char* const errorMessage) {
+    printf("%s\n", errorMessage);
+}
+
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+
+// This function is called each time a "/sensors" message is received
+static void NgimuSensorsCallback(const NgimuSensors * const ngimuSensors, void * const userContext) {
+    printf("/sensors, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f\n",
+            ngimuSensors->gyroscopeX, ngimuSensors->gyroscopeY, ngimuSensors->gyroscopeZ,
+            ngimuSensors->accelerometerX, ngimuSensors->accelerometerY, ngimuSensors->accelerometerZ,
+            ngimuSensors->magnetometerX, ngimuSensors->magnetometerY, ngimuSensors->magnetometerZ,
+            ngimuSensors->barometer);
+}
+
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+
+// This function is called each time a "/quaternion" message is received
+static void NgimuQuaternionCallback(const NgimuQuaternion * const ngimuQuaternion, void * const userContext) {
+    printf("/quaternion, %f, %f, %f, %f\n", ngimuQuaternion->w, ngimuQuaternion->x, ngimuQuaternion->y, ngimuQuaternion->z);
+}
+
+#endif
+
+#if NGIMU_RECEIVE_ENABLE_EULER
+
+// This function is called each time a "/euler" message is received
+static void NgimuEulerCallback(const NgimuEuler * const ngimuEuler, void * const userContext) {
+    printf("/euler, %f, %f, %f\n", ngimuEuler->roll, ngimuEuler->pitch, ngimuEuler->yaw);
+}
+
+#endif
+
+// This function is called each time a merged frame is available
+static void NgimuMergeFrameCallback(const NgimuMergeFrame * const ngimuMergeFrame, void * const userContext) {
+    printf("frame, %f", (double) ngimuMergeFrame->timestamp.value / 4294967296.0);
+    int device;
+    for (device = 0; device < NGIMU_MERGE_MAX_DEVICES; device++) {
+        if ((ngimuMergeFrame->devices & (1u << device)) == 0) {
+            continue;
+        }
+        printf(", %d", device);
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+        const NgimuQuaternion * const ngimuQuaternion = &ngimuMergeFrame->samples[device].quaternion;
+        printf(", %f, %f, %f, %f", ngimuQuaternion->w, ngimuQuaternion->x, ngimuQuaternion->y, ngimuQuaternion->z);
+#endif
+    }
+    printf("\n");
+}
+
+// Receives with multiple threads and prints all messages until interrupted
+static int RunPipeline(const uint16_t port, const unsigned int numberOfWorkers) {
+    if (NgimuUdpPipelineStart(&ngimuUdpPipeline, port, numberOfWorkers) != 0) {
+        perror("Unable to start receive threads");
+        return EXIT_FAILURE;
+    }
+    const struct timespec period = {.tv_sec = 0, .tv_nsec = 1000000};
+    while (stopRequested == 0) {
+        if (NgimuUdpPipelineProcess(&ngimuUdpPipeline, NgimuUdpPipelineRecordCallback, NULL) == 0) {
+            nanosleep(&period, NULL);
+        }
+    }
+    NgimuUdpPipelineStop(&ngimuUdpPipeline);
+    printf("discarded, %u, overflow, %u\n", NgimuUdpPipelineGetDiscardedCount(&ngimuUdpPipeline), NgimuUdpPipelineGetOverflowCount(&ngimuUdpPipeline));
+    return EXIT_SUCCESS;
+}
+
+// This function is called for each message received by the receive threads
+static void NgimuUdpPipelineRecordCallback(const uint64_t key, const NgimuQueueRecord * const ngimuQueueRecord, void * const userContext) {
+    printf("%012llx, ", (unsigned long long) key);
+    switch (ngimuQueueRecord->type) {
+#if NGIMU_RECEIVE_ENABLE_SENSORS
+        case NgimuQueueRecordTypeSensors:
+            NgimuSensorsCallback(&ngimuQueueRecord->data.sensors, NULL);
+            break;
+#endif
+#if NGIMU_RECEIVE_ENABLE_QUATERNION
+        case NgimuQueueRecordTypeQuaternion:
+            NgimuQuaternionCallback(&ngimuQueueRecord->data.quaternion, NULL);
+            break;
+#endif
+#if NGIMU_RECEIVE_ENABLE_EULER
+        case NgimuQueueRecordTypeEuler:
+            NgimuEulerCallback(&ngimuQueueRecord->data.euler, NULL);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+// Prints all messages written to the shared memory until interrupted
+static int RunSubscriber(const char * const name) {
+    NgimuShmSubscriber ngimuShmSubscriber;
+    if (NgimuShmSubscriberOpen(&ngimuShmSubscriber, name) != 0) {
+        perror("Unable to open shared memory");
+        return EXIT_FAILURE;
+    }
+    const struct timespec period = {.tv_sec = 0, .tv_nsec = 1000000};
+    bool failed = false;
+    while (stopRequested == 0) {
+        NgimuShmRecord ngimuShmRecord;
+        const int result = NgimuShmSubscriberRead(&ngimuShmSubscriber, &ngimuShmRecord);
+        if (result > 0) {
+            NgimuUdpPipelineRecordCallback(ngimuShmRecord.key, &ngimuShmRecord.record, NULL);
+            continue;
+        }
+        if ((result < 0) && (errno != EAGAIN)) {
+            perror("Unable to read shared memory");
+            failed = true;
+            break;
+        }
+        nanosleep(&period, NULL);
+    }
+    printf("lost, %llu\n", (unsigned long long) NgimuShmSubscriberGetLostCount(&ngimuShmSubscriber));
+    NgimuShmSubscriberClose(&ngimuShmSubscriber);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#if NGIMU_RECEIVE_ENABLE_CAPTURE
+
+// This function is called to append data to the capture
+static void CaptureWrite(const char * const data, const size_t size, void * const userContext) {
+    fwrite(data, 1, size, (FILE *) userContext);
+}
+
+// This function is called to get the receive timestamp of captured data
+static uint64_t CaptureGetTimestamp(void * const userContext) {
+    struct timespec timespec;
+    clock_gettime(CLOCK_REALTIME, &timespec);
+    return ((uint64_t) timespec.tv_sec * 1000000000) + (uint64_t) timespec.tv_nsec;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file